@@ -12,6 +12,9 @@
 #include <cstdint>
 
 #include <map>
+#include <optional>
+
+#include "UuidSet.h"
 
 // BlueZ Device1 interface property names
 #define DEVICE_PROPERTY_Address "Address"                   ///< MAC address of the device
@@ -30,6 +33,35 @@
 #define DEVICE_PROPERTY_Icon "Icon"                         ///< Device icon name
 #define DEVICE_PROPERTY_Class "Class"                       ///< Device class
 #define DEVICE_PROPERTY_ManufacturerData "ManufacturerData" ///< Manufacturer-specific data
+#define DEVICE_PROPERTY_RSSI "RSSI"                         ///< Received signal strength (dBm)
+#define DEVICE_PROPERTY_TxPower "TxPower"                   ///< Advertised transmit power (dBm)
+
+#define DEVICE_RSSI_UNKNOWN INT16_MIN    ///< RSSI/TxPower value when BlueZ has no reading
+
+// Bits naming DeviceProperties fields in change masks
+#define DEVICE_FIELD_Address (1u << 0)           ///< Address
+#define DEVICE_FIELD_AddressType (1u << 1)       ///< AddressType
+#define DEVICE_FIELD_Name (1u << 2)              ///< Name
+#define DEVICE_FIELD_Class (1u << 3)             ///< Class
+#define DEVICE_FIELD_UUIDs (1u << 4)             ///< UUIDs
+#define DEVICE_FIELD_Paired (1u << 5)            ///< Paired
+#define DEVICE_FIELD_Connected (1u << 6)         ///< Connected
+#define DEVICE_FIELD_Trusted (1u << 7)           ///< Trusted
+#define DEVICE_FIELD_Blocked (1u << 8)           ///< Blocked
+#define DEVICE_FIELD_Alias (1u << 9)             ///< Alias
+#define DEVICE_FIELD_Adapter (1u << 10)          ///< AdapterPath
+#define DEVICE_FIELD_LegacyPairing (1u << 11)    ///< LegacyPairing
+#define DEVICE_FIELD_ServiceData (1u << 12)      ///< ServiceData
+#define DEVICE_FIELD_ServicesResolved (1u << 13) ///< ServicesResolved
+#define DEVICE_FIELD_Icon (1u << 14)             ///< Icon
+#define DEVICE_FIELD_ManufacturerData (1u << 15) ///< ManufacturerData
+#define DEVICE_FIELD_RSSI (1u << 16)             ///< RSSI
+#define DEVICE_FIELD_TxPower (1u << 17)          ///< TxPower
+#define DEVICE_FIELD_ALL ((1u << 18) - 1)        ///< Every property field
+
+// Registry-internal change bits outside DEVICE_FIELD_ALL, never delivered to subscribers
+#define DEVICE_FIELD_State (1u << 18)            ///< Lifecycle state
+#define DEVICE_FIELD_LastSeen (1u << 19)         ///< Last BlueZ activity
 
 /**
  * @struct DeviceProperties
@@ -40,7 +72,7 @@ typedef struct {
   std::string AddressType;                                          ///< Address type
   std::string Name;                                                 ///< Device name
   uint32_t Class;                                                   ///< Device class
-  std::vector<std::string> UUIDs;                                   ///< Supported service UUIDs
+  UuidSet UUIDs;                                                    ///< Supported service UUIDs, sorted
   bool Paired;                                                      ///< Pairing status
   bool Connected;                                                   ///< Connection status
   bool Trusted;                                                     ///< Trusted status
@@ -52,8 +84,86 @@ typedef struct {
   bool ServicesResolved;                                            ///< Service discovery complete
   std::string Icon;                                                 ///< Device icon
   std::map<uint16_t, std::map<int, std::string>> ManufacturerData; ///< Manufacturer data
+  int16_t RSSI = DEVICE_RSSI_UNKNOWN;                               ///< Last RSSI, only present while discovering
+  int16_t TxPower = DEVICE_RSSI_UNKNOWN;                            ///< Advertised transmit power
 } DeviceProperties;
 
+/**
+ * @struct DeviceChangeSet
+ * @brief Properties carried by one PropertiesChanged signal
+ */
+typedef struct
+{
+  uint32_t fields;         ///< DEVICE_FIELD_* bits of the properties present
+  DeviceProperties values; ///< New values; fields without a bit are unset
+} DeviceChangeSet;
+
+/**
+ * @struct DeviceProximity
+ * @brief Smoothed signal strength and estimated distance of a device
+ */
+typedef struct
+{
+  int16_t rssi;        ///< Last raw RSSI in dBm, DEVICE_RSSI_UNKNOWN if none
+  double smoothedRssi; ///< Filtered RSSI in dBm
+  double distanceM;    ///< Estimated distance in metres, negative if unknown
+  uint32_t samples;    ///< RSSI readings since the filter was last reset
+} DeviceProximity;
+
+#define SIGHTING_RSSI_UNKNOWN DEVICE_RSSI_UNKNOWN ///< RSSI value of a sighting without a reading
+
+/**
+ * @struct DeviceSighting
+ * @brief One nearby device, 32 bytes
+ */
+typedef struct
+{
+  uint64_t mac;          ///< 48-bit address, first octet in the most significant byte
+  uint64_t lastSeenMs;   ///< Last report from BlueZ on the steady clock
+  uint32_t deviceClass;  ///< Class of Device
+  uint32_t nameHash;     ///< FNV-1a hash of the name, 0 if unnamed
+  int16_t rssi;          ///< Last RSSI in dBm, SIGHTING_RSSI_UNKNOWN if none
+  uint8_t adapter;       ///< Adapter index (N in hciN)
+} DeviceSighting;
+
+/**
+ * @struct SightingFilter
+ * @brief Criteria for SightingTable::Query(); unset fields match everything
+ */
+typedef struct
+{
+  std::optional<uint8_t> majorClass; ///< Major device class (BluetoothMajorDeviceClass)
+  std::optional<int16_t> minRssi;    ///< Weakest RSSI to include
+  std::optional<uint64_t> maxAgeMs;  ///< Oldest sighting to include
+  std::optional<uint32_t> nameHash;  ///< Name hash, see SightingTable::NameHash()
+} SightingFilter;
+
+/**
+ * @struct DeviceIndexKey
+ * @brief Properties of an admitted device the registry indexes
+ */
+typedef struct
+{
+  bool paired;         ///< Pairing status
+  bool connected;      ///< Connection status
+  uint8_t majorClass;  ///< Major device class (BluetoothMajorDeviceClass)
+  uint8_t adapter;     ///< Adapter index (N in hciN)
+  UuidSet uuids;       ///< Supported service UUIDs
+} DeviceIndexKey;
+
+/**
+ * @struct DeviceQuery
+ * @brief Criteria for IDeviceManager::QueryDevices(); unset fields match everything
+ */
+typedef struct
+{
+  std::optional<bool> paired;        ///< Pairing status
+  std::optional<bool> connected;     ///< Connection status
+  UuidSet anyUuid;                   ///< Devices offering at least one of these; empty matches all
+  std::optional<uint8_t> majorClass; ///< Major device class (BluetoothMajorDeviceClass)
+  std::optional<uint8_t> adapter;    ///< Adapter index (N in hciN)
+} DeviceQuery;
+
 /**
  * @enum BluetoothMajorDeviceClass
  * @brief Major device class values from Bluetooth specification
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 /**
@@ -16,6 +17,11 @@
  * This interface defines the contract for handling Bluetooth authentication
  * requests during pairing operations. Implementations should provide
  * user interaction for confirmation requests and other authentication events.
+ *
+ * The request methods run on agent worker threads, never on the D-Bus
+ * thread, so they may block on a prompt, a policy check or a lookup. They
+ * reject a request by throwing sdbus::Error; a request still undecided at
+ * its deadline is rejected for them and its late answer is discarded.
  */
 class IAgent
 {
@@ -25,13 +31,35 @@ public:
    */
   virtual ~IAgent() = default;
   
+  /**
+   * @brief Provide the PIN code for legacy pairing
+   * @param path D-Bus object path of the device requesting the PIN
+   * @return PIN code, 1 to 16 characters
+   */
+  virtual std::string RequestPinCode(std::string path) = 0;
+
+  /**
+   * @brief Provide the passkey for pairing
+   * @param path D-Bus object path of the device requesting the passkey
+   * @return Passkey, 0 to 999999
+   */
+  virtual uint32_t RequestPasskey(std::string path) = 0;
+
   /**
    * @brief Handle pairing confirmation request
    * @param path D-Bus object path of the device requesting confirmation
+   * @param passkey Passkey shown on the device
    * 
    * Called when a device requires user confirmation for pairing.
    * The implementation should prompt the user or automatically
    * confirm based on application policy.
    */
-  virtual void RequestConfirmation(std::string path) = 0;
+  virtual void RequestConfirmation(std::string path, uint32_t passkey) = 0;
+
+  /**
+   * @brief Authorize a device to use a service
+   * @param path D-Bus object path of the device
+   * @param uuid UUID of the service
+   */
+  virtual void AuthorizeService(std::string path, std::string uuid) = 0;
 };
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <vector>
 #include <map>
 #include <cstdint>
+#include <memory>
 
 
 #include "DeviceHelper.h"
@@ -83,100 +84,43 @@ public:
   virtual DeviceProperties GetProperties() = 0;
 
   /**
-   * @brief Callback for device MAC address changes
-   * @param value New MAC address of the device
+   * @brief Get the cached properties without copying them
+   *
+   * Never waits for a property update; the snapshot stays consistent
+   * while held, whatever updates follow.
+   *
+   * @return Immutable snapshot
    */
-  virtual void AddressChanged(std::string value) = 0;
-  
-  /**
-   * @brief Callback for device address type changes
-   * @param value New address type (e.g., "public", "random")
-   */
-  virtual void AddressTypeChanged(std::string value) = 0;
-  
-  /**
-   * @brief Callback for device name changes
-   * @param value New device name
-   */
-  virtual void NameChanged(std::string value) = 0;
-  
-  /**
-   * @brief Callback for device icon changes
-   * @param value New device icon identifier
-   */
-  virtual void IconChanged(std::string value) = 0;
-  
-  /**
-   * @brief Callback for device class changes
-   * @param value New device class value (24-bit integer)
-   */
-  virtual void ClassChanged(uint32_t value) = 0;
-  
-  /**
-   * @brief Callback for supported UUIDs changes
-   * @param value List of supported service UUIDs
-   */
-  virtual void UUIDsChanged(std::vector<std::string> value) = 0;
-  
-  /**
-   * @brief Callback for paired state changes
-   * @param value True if device is paired, false otherwise
-   */
-  virtual void PairedChanged(bool value) = 0;
-  
-  /**
-   * @brief Callback for connection state changes
-   * @param value True if device is connected, false otherwise
-   */
-  virtual void ConnectedChanged(bool value) = 0;
-  
-  /**
-   * @brief Callback for trusted state changes
-   * @param value True if device is trusted, false otherwise
-   */
-  virtual void TrustedChanged(bool value) = 0;
-  
-  /**
-   * @brief Callback for blocked state changes
-   * @param value True if device is blocked, false otherwise
-   */
-  virtual void BlockedChanged(bool value) = 0;
-  
-  /**
-   * @brief Callback for device alias changes
-   * @param value New device alias (friendly name)
-   */
-  virtual void AliasChanged(std::string value) = 0;
-  
+  virtual std::shared_ptr<const DeviceProperties> GetPropertiesSnapshot() = 0;
+
   /**
-   * @brief Callback for adapter path changes
-   * @param value D-Bus path of the associated adapter
+   * @brief Get a counter that moves whenever a cached property changes
+   * @return Monotonic version; equal versions mean equal properties
    */
-  virtual void AdapterChanged(std::string value) = 0;
-  
+  virtual uint64_t GetPropertiesVersion() = 0;
+
   /**
-   * @brief Callback for legacy pairing state changes
-   * @param value True if legacy pairing is required, false otherwise
+   * @brief Get the lifecycle state and transition timings of this device
+   * @return Multi-line report
    */
-  virtual void LegacyPairingChanged(bool value) = 0;
-  
+  virtual std::string GetLifecycleReport() = 0;
+
   /**
-   * @brief Callback for manufacturer data changes
-   * @param value Map of manufacturer ID to data
+   * @brief Get the smoothed signal strength and estimated distance
+   * @return Proximity estimate; samples is 0 if no RSSI was reported
    */
-  virtual void ManufacturerDataChanged(std::map<uint16_t, std::map<int, std::string>> value) = 0;
-  
+  virtual DeviceProximity GetProximity() = 0;
+
   /**
-   * @brief Callback for service data changes
-   * @param value Map of service UUID to data
+   * @brief Apply the properties carried by one PropertiesChanged signal
+   * @param changes Fields present in the signal and their new values
    */
-  virtual void ServiceDataChanged(std::map<std::string, std::map<int, std::string>> value) = 0;
-  
+  virtual void ApplyChanges(const DeviceChangeSet &changes) = 0;
+
   /**
-   * @brief Callback for services resolved state changes
-   * @param value True if services are resolved, false otherwise
+   * @brief Record that BlueZ reported activity for this device
    */
-  virtual void ServicesResolvedChanged(bool value) = 0;
+  virtual void Seen() = 0;
 
   /**
    * @brief Virtual destructor for proper inheritance cleanup
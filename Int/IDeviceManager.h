@@ -11,9 +11,74 @@
 
 #include <memory>
 #include <vector>
+#include <optional>
+#include <functional>
+#include <cstdint>
 
 #include "IDevice.h"
 
+/**
+ * @struct DeviceMatch
+ * @brief One device returned by IDeviceManager::QueryDevices()
+ */
+typedef struct
+{
+  std::string mac;                 ///< MAC address
+  std::shared_ptr<IDevice> device; ///< Device; stays valid after it leaves the registry
+} DeviceMatch;
+
+/**
+ * @class DeviceQueryResult
+ * @brief Devices matching a DeviceQuery, taken at one point in time
+ *
+ * Holds only the matches, so iterating it neither locks the registry nor
+ * sees later changes.
+ */
+class DeviceQueryResult
+{
+public:
+  DeviceQueryResult() = default;
+
+  /**
+   * @brief Wrap the matches of a query
+   * @param matches Matching devices
+   */
+  explicit DeviceQueryResult(std::vector<DeviceMatch> matches) : m_matches(std::move(matches)) {}
+
+  std::vector<DeviceMatch>::const_iterator begin() const { return m_matches.begin(); }
+  std::vector<DeviceMatch>::const_iterator end() const { return m_matches.end(); }
+  size_t size() const { return m_matches.size(); }
+  bool empty() const { return m_matches.empty(); }
+
+private:
+  std::vector<DeviceMatch> m_matches; ///< Matching devices
+};
+
+/**
+ * @enum DeviceNotificationType
+ * @brief What happened to a device in a DeviceNotification
+ */
+enum class DeviceNotificationType
+{
+  Added,   ///< Admitted to the registry
+  Removed, ///< Dropped from the registry, by BlueZ or by eviction
+  Changed  ///< Cached properties changed
+};
+
+/**
+ * @struct DeviceNotification
+ * @brief One registry event delivered to subscribers
+ */
+typedef struct
+{
+  DeviceNotificationType type; ///< Event
+  std::string mac;             ///< MAC address of the device
+  uint32_t fields;             ///< DEVICE_FIELD_* bits that changed, 0 for Added and Removed
+} DeviceNotification;
+
+/// Receives the events of one delivery batch, in order, on the notifier thread
+typedef std::function<void(const std::vector<DeviceNotification> &batch)> DeviceNotificationCallback;
+
 /**
  * @class IDeviceManager
  * @brief Abstract interface for managing Bluetooth device lifecycle
@@ -34,9 +99,18 @@ public:
    * @brief Handle device addition event
    * @param devicePath D-Bus object path of the added device
    * @param enableLoop Whether to start event loop for this device
+   * @param properties Properties announced with the device, if any
    */
-  virtual void DeviceAdded(std::string devicePath, bool enableLoop) = 0;
+  virtual void DeviceAdded(std::string devicePath, bool enableLoop, std::optional<DeviceProperties> properties) = 0;
   
+  /**
+   * @brief Record a device seen during discovery without admitting it
+   * @param devicePath D-Bus object path of the device
+   * @param properties Properties announced with the device
+   * @param rssi RSSI in dBm, SIGHTING_RSSI_UNKNOWN if none
+   */
+  virtual void DeviceSighted(std::string devicePath, DeviceProperties properties, int16_t rssi) = 0;
+
   /**
    * @brief Handle device removal event
    * @param devicePath D-Bus object path of the removed device
@@ -44,7 +118,7 @@ public:
   virtual void DeviceRemoved(std::string devicePath) = 0;
 
   /**
-   * @brief Get device instance by MAC address
+   * @brief Get device instance by MAC address, admitting it if it was only sighted
    * @param mac MAC address of the device to retrieve
    * @return Shared pointer to IDevice instance, or nullptr if not found
    */
@@ -55,4 +129,59 @@ public:
    * @return Vector containing MAC addresses of all managed devices
    */
   virtual std::vector<std::string> GetDevicesMAC() = 0;
+
+  /**
+   * @brief Get the admitted devices matching a query, from the registry indexes
+   *
+   * Makes no D-Bus calls and does not read every device: the cost follows
+   * the smallest index the query names, e.g. the paired devices or those
+   * offering a UUID.
+   *
+   * @param query Criteria; a default query matches every admitted device
+   * @return Matching devices
+   */
+  virtual DeviceQueryResult QueryDevices(const DeviceQuery &query) = 0;
+
+  /**
+   * @brief Receive registry events instead of polling
+   *
+   * Added and Removed events are always delivered; Changed events only
+   * when a field in the mask changed, with the other bits cleared. Events
+   * queued while a batch is delivered arrive together in the next batch,
+   * and changes of one device within a batch are merged.
+   *
+   * @param fields DEVICE_FIELD_* bits of interest
+   * @param callback Called on the notifier thread; must not block for long
+   * @return Subscription id for Unsubscribe()
+   */
+  virtual uint64_t Subscribe(uint32_t fields, DeviceNotificationCallback callback) = 0;
+
+  /**
+   * @brief Stop a subscription
+   *
+   * Once this returns the callback is not running and will not be called
+   * again, unless this is called from the callback itself.
+   *
+   * @param id Id returned by Subscribe()
+   */
+  virtual void Unsubscribe(uint64_t id) = 0;
+
+  /**
+   * @brief Get the MAC addresses of all managed devices, closest first
+   * @return MAC addresses ordered by smoothed RSSI; devices without a reading come last
+   */
+  virtual std::vector<std::string> GetDevicesByProximity() = 0;
+
+  /**
+   * @brief Get the sightings of devices that are not admitted
+   * @param filter Criteria; a default filter matches every sighting
+   * @return Matching sightings
+   */
+  virtual std::vector<DeviceSighting> GetSightings(const SightingFilter &filter) = 0;
+
+  /**
+   * @brief Get the lifecycle transition timings aggregated over all devices
+   * @return Multi-line report
+   */
+  virtual std::string GetLifecycleReport() = 0;
 };
@@ -2,6 +2,7 @@
 #include "Adapter.h"
 
 #include "Logger.h"
+#include "Trace.h"
 
 #define TAG "Adapter::"
 
@@ -87,6 +88,7 @@ void Adapter::UUIDsChanged(std::vector<std::string> value)
 void Adapter::StartScan()
 {
   Log("%s%s", TAG,__func__);
+  TRACE_SCOPE("discovery", __func__);
   m_adapterProxy.SetPowered(true);
   m_adapterProxy.ResetStatus();
   m_adapterProxy.SetAlias(m_deviceName);
@@ -106,6 +108,7 @@ void Adapter::StopScan()
 void Adapter::StartDiscovery()
 {
   Log("%s%s", TAG,__func__);
+  TRACE_SCOPE("discovery", __func__);
   m_adapterProxy.SetPowered(true);
   m_adapterProxy.ResetStatus();
   m_adapterProxy.SetAlias(m_deviceName);
@@ -118,6 +121,7 @@ void Adapter::StartDiscovery()
 
 void Adapter::StopDiscovery()
 {
+  TRACE_SCOPE("discovery", __func__);
   if(m_adapterProxy.GetDiscovering()) {
     m_adapterProxy.StopDiscovery();
   }
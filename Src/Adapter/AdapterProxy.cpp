@@ -11,11 +11,14 @@
 #include <sstream>
 
 #include "AdapterProxy.h"
+#include "DBusCallMetrics.h"
 
 #include "Logger.h"
+#include "DispatchWatchdog.h"
 #include "Utilities.h"
 
 #define TAG "AdapterProxy::" ///< Tag for logging messages
+#define ADAPTER_INTERFACE_NAME "org.bluez.Adapter1" ///< Interface label of the call metrics
 
 const std::string ADAPTER_WELLKNOWN_NAME = "org.bluez";                ///< BlueZ D-Bus service name
 const std::string ADAPTER_INTERFACE_OBJECT_PATH = "/org/bluez/";       ///< Base path for BlueZ objects
@@ -60,8 +63,8 @@ AdapterProxy::~AdapterProxy()
 void AdapterProxy::SetPowered(const bool& value)
 {
   Log("%s%s Value - %d", TAG, __func__, value);
-  if(Powered() != value) {
-    Powered(value);
+  if(GetPowered() != value) {
+    DBUS_CALL(ADAPTER_INTERFACE_NAME, "Set:Powered", Powered(value));
   } else {
     Log("%s%s Already same Value - %d", TAG, __func__, value);
   }  
@@ -69,15 +72,15 @@ void AdapterProxy::SetPowered(const bool& value)
 
 bool AdapterProxy::GetPowered()
 {
-  return Powered();
+  return DBUS_CALL(ADAPTER_INTERFACE_NAME, "Get:Powered", Powered());
 }
 
 
 void AdapterProxy::SetDiscoverable(const bool& value)
 {
   Log("%s%s Value - %d", TAG, __func__, value);
-  if(Discoverable() != value) {
-    Discoverable(value);
+  if(GetDiscoverable() != value) {
+    DBUS_CALL(ADAPTER_INTERFACE_NAME, "Set:Discoverable", Discoverable(value));
   } else {
     Log("%s%s Already same Value - %d", TAG, __func__, value);
   }
@@ -85,32 +88,32 @@ void AdapterProxy::SetDiscoverable(const bool& value)
 
 bool AdapterProxy::GetDiscoverable()
 {
-  return Discoverable();
+  return DBUS_CALL(ADAPTER_INTERFACE_NAME, "Get:Discoverable", Discoverable());
 }
 
 bool AdapterProxy::GetDiscovering()
 {
-  return Discovering();
+  return DBUS_CALL(ADAPTER_INTERFACE_NAME, "Get:Discovering", Discovering());
 }
 
 
 void AdapterProxy::SetDiscoverableTimeout(const uint32_t& value)
 {
   Log("%s%s Value - %d", TAG, __func__, value);
-  DiscoverableTimeout(value);
+  DBUS_CALL(ADAPTER_INTERFACE_NAME, "Set:DiscoverableTimeout", DiscoverableTimeout(value));
 }
 
 uint32_t AdapterProxy::GetDiscoverableTimeout()
 {
-  return DiscoverableTimeout();
+  return DBUS_CALL(ADAPTER_INTERFACE_NAME, "Get:DiscoverableTimeout", DiscoverableTimeout());
 }
 
 
 void AdapterProxy::SetPairable(const bool& value)
 {
   Log("%s%s Value - %d", TAG, __func__, value);
-  if(Pairable() != value) {
-    Pairable(value);
+  if(GetPairable() != value) {
+    DBUS_CALL(ADAPTER_INTERFACE_NAME, "Set:Pairable", Pairable(value));
   } else {
     Log("%s%s Already same Value - %d", TAG, __func__, value);
   }
@@ -118,25 +121,25 @@ void AdapterProxy::SetPairable(const bool& value)
 
 bool AdapterProxy::GetPairable()
 {
-  return Pairable();
+  return DBUS_CALL(ADAPTER_INTERFACE_NAME, "Get:Pairable", Pairable());
 }
 
 void AdapterProxy::SetPairableTimeout(const uint32_t& value)
 {
   Log("%s%s Value - %d", TAG, __func__, value);
-  PairableTimeout(value);
+  DBUS_CALL(ADAPTER_INTERFACE_NAME, "Set:PairableTimeout", PairableTimeout(value));
 }
 
 uint32_t AdapterProxy::GetPairableTimeout()
 {
-  return PairableTimeout();
+  return DBUS_CALL(ADAPTER_INTERFACE_NAME, "Get:PairableTimeout", PairableTimeout());
 }
 
 void AdapterProxy::SetAlias(const std::string &value)
 {
   Log("%s%s Value - %s", TAG,__func__, LOG_STRING(value));
-  if(Alias() != value) {
-    Alias(value);
+  if(GetAlias() != value) {
+    DBUS_CALL(ADAPTER_INTERFACE_NAME, "Set:Alias", Alias(value));
   } else {
     Log("%s%s Already same Value - %s", TAG,__func__, LOG_STRING(value));
   }
@@ -144,13 +147,13 @@ void AdapterProxy::SetAlias(const std::string &value)
 
 std::string AdapterProxy::GetAlias()
 {
-  return Alias();
+  return DBUS_CALL(ADAPTER_INTERFACE_NAME, "Get:Alias", Alias());
 }
 
 void AdapterProxy::SetClass(const uint32_t &value)
 {
   Log("%s%s Value - %.6x", TAG,__func__, value);
-  if(Class() == value) {
+  if(GetClass() == value) {
     Log("%s%s Already same Value - %.6x", TAG,__func__, value);
     return;
   }
@@ -160,7 +163,7 @@ void AdapterProxy::SetClass(const uint32_t &value)
     ss << "class 0x" << std::hex << value;
     std::string command = ConstructHCICommand(ss.str());
     ExecuteBashCommand(command);
-    Log("%s%s Changed Class %.6x", TAG,__func__, Class());
+    Log("%s%s Changed Class %.6x", TAG,__func__, GetClass());
   }
   catch(const std::exception& e)
   {
@@ -170,32 +173,32 @@ void AdapterProxy::SetClass(const uint32_t &value)
 
 uint32_t AdapterProxy::GetClass()
 {
-  return Class();
+  return DBUS_CALL(ADAPTER_INTERFACE_NAME, "Get:Class", Class());
 }
 
 void AdapterProxy::StartDiscovery()
 {
-  org::bluez::Adapter1_proxy::StartDiscovery();
+  DBUS_CALL(ADAPTER_INTERFACE_NAME, "StartDiscovery", org::bluez::Adapter1_proxy::StartDiscovery());
 }
 
 void AdapterProxy::SetDiscoveryFilter(const std::map<std::string, sdbus::Variant>& filters)
 {
-  org::bluez::Adapter1_proxy::SetDiscoveryFilter(filters);
+  DBUS_CALL(ADAPTER_INTERFACE_NAME, "SetDiscoveryFilter", org::bluez::Adapter1_proxy::SetDiscoveryFilter(filters));
 }
 
 void AdapterProxy::StopDiscovery()
 {
-  org::bluez::Adapter1_proxy::StopDiscovery();
+  DBUS_CALL(ADAPTER_INTERFACE_NAME, "StopDiscovery", org::bluez::Adapter1_proxy::StopDiscovery());
 }
 
 void AdapterProxy::RemoveDevice(const std::string& device_path)
 {
-    org::bluez::Adapter1_proxy::RemoveDevice(sdbus::ObjectPath(device_path));
+    DBUS_CALL(ADAPTER_INTERFACE_NAME, "RemoveDevice", org::bluez::Adapter1_proxy::RemoveDevice(sdbus::ObjectPath(device_path)));
 }
 
 std::vector<std::string> AdapterProxy::GetDiscoveryFilters()
 {
-  return org::bluez::Adapter1_proxy::GetDiscoveryFilters();
+  return DBUS_CALL(ADAPTER_INTERFACE_NAME, "GetDiscoveryFilters", org::bluez::Adapter1_proxy::GetDiscoveryFilters());
 }
 
 void AdapterProxy::ResetStatus()
@@ -205,7 +208,7 @@ void AdapterProxy::ResetStatus()
   {
     std::string command = ConstructHCICommand("rstat");
     ExecuteBashCommand(command);
-    Log("%s%s Changed Class %.6x", TAG,__func__, Class());
+    Log("%s%s Changed Class %.6x", TAG,__func__, GetClass());
   }
   catch(const std::exception& e)
   {
@@ -217,6 +220,7 @@ void AdapterProxy::onPropertiesChanged( const sdbus::InterfaceName& interface_na
                                         const  std::map<sdbus::PropertyName, sdbus::Variant>& changed_properties,
                                         const std::vector<sdbus::PropertyName>& invalidated_properties )
 {
+  WATCHDOG_HANDLER("AdapterProxy::onPropertiesChanged");
   Log("%s%s Interface Name %s", TAG,LOG_STRING(interface_name));
   for (const auto &prop : changed_properties) {
     Log("%s%s Name - %s", TAG, __func__, LOG_STRING(prop.first));
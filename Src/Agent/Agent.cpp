@@ -1,5 +1,6 @@
 #include "Agent.h"
 #include "Logger.h"
+#include "Trace.h"
 
 #define TAG "Agent::"
 
@@ -16,7 +17,25 @@ Agent::~Agent()
   Log("%s%s", TAG,__func__);
 }
 
-void Agent::RequestConfirmation(std::string path)
+std::string Agent::RequestPinCode(std::string)
 {
-  m_deviceManager.DeviceAdded(path, true);
+  TRACE_SCOPE("pairing", __func__);
+  return "1";
+}
+
+uint32_t Agent::RequestPasskey(std::string)
+{
+  TRACE_SCOPE("pairing", __func__);
+  return 1;
+}
+
+void Agent::RequestConfirmation(std::string path, uint32_t)
+{
+  TRACE_SCOPE("pairing", __func__);
+  m_deviceManager.DeviceAdded(path, true, std::nullopt);
+}
+
+void Agent::AuthorizeService(std::string, std::string)
+{
+  TRACE_SCOPE("pairing", __func__);
 }
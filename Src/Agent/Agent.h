@@ -35,15 +35,37 @@ public:
    */
   ~Agent();
 
+  /**
+   * @brief Provide the PIN code for legacy pairing
+   * @param path D-Bus object path of the device requesting the PIN
+   * @return PIN code
+   */
+  std::string RequestPinCode(std::string path) override;
+
+  /**
+   * @brief Provide the passkey for pairing
+   * @param path D-Bus object path of the device requesting the passkey
+   * @return Passkey
+   */
+  uint32_t RequestPasskey(std::string path) override;
+
   /**
    * @brief Handle pairing confirmation request
    * @param path D-Bus object path of the device requesting confirmation
+   * @param passkey Passkey shown on the device
    * 
    * Called by BlueZ when a device requires confirmation for pairing.
    * This method should prompt the user or automatically confirm based
    * on application policy.
    */
-  void RequestConfirmation(std::string path) override;
+  void RequestConfirmation(std::string path, uint32_t passkey) override;
+
+  /**
+   * @brief Authorize a device to use a service
+   * @param path D-Bus object path of the device
+   * @param uuid UUID of the service
+   */
+  void AuthorizeService(std::string path, std::string uuid) override;
   
 private:
   sdbus::IConnection &m_connection;  ///< Reference to D-Bus connection
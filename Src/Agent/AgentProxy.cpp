@@ -1,13 +1,28 @@
+#include <chrono>
+
 #include "AgentProxy.h"
 
 #include "Logger.h"
+#include "DispatchWatchdog.h"
+#include "Trace.h"
 
 #define TAG "AgentProxy::"
+#define AGENT_WORKER_THREADS 2          ///< Workers deciding agent requests
+#define AGENT_REQUEST_TIMEOUT_MS 30000  ///< Deadline of a request; BlueZ itself gives up after 60 s
+#define AGENT_WHEEL_TICK_MS 100         ///< Deadline wheel resolution
+#define AGENT_WHEEL_SLOTS 512           ///< Deadline wheel slots (about 51 s per revolution)
+#define AGENT_ERROR_REJECTED "org.bluez.Error.Rejected" ///< Reply to refused or timed-out requests
+#define AGENT_ERROR_CANCELED "org.bluez.Error.Canceled" ///< Reply to requests BlueZ cancelled
 
 AgentProxy::AgentProxy(sdbus::IConnection &connection, std::string path, IAgent &agent):
 m_connection(connection),
 m_agent(agent),
-AdaptorInterfaces(connection, sdbus::ObjectPath(path))
+AdaptorInterfaces(connection, sdbus::ObjectPath(path)),
+m_deadlines(AGENT_WHEEL_TICK_MS, AGENT_WHEEL_SLOTS, NowMs()),
+m_nextId(1),
+m_running(true),
+m_timedOut(MetricsRegistry::Instance().GetCounter("bluezeg_agent_requests_timed_out_total", "Agent requests rejected at their deadline")),
+m_workers(AGENT_WORKER_THREADS)
 {
   Log("%s%s", TAG,__func__);
   try
@@ -19,57 +34,211 @@ AdaptorInterfaces(connection, sdbus::ObjectPath(path))
     Log("%s%s Error - %s ", TAG,__func__, e.what());
     throw;
   }
+  // Started only once nothing can throw, so a failed constructor never leaves it joinable
+  m_deadlineThread = std::thread(&AgentProxy::RunDeadlines, this);
 }
 AgentProxy::~AgentProxy()
 {
   Log("%s%s", TAG,__func__);
   unregisterAdaptor();
+  {
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    m_running = false;
+  }
+  m_pendingCV.notify_all();
+  if (m_deadlineThread.joinable()) {
+    m_deadlineThread.join();
+  }
+  // Queued decisions are dropped with the workers; answer their requests now
+  RejectAll(sdbus::Error(sdbus::Error::Name{AGENT_ERROR_CANCELED}, "Agent is shutting down"));
+}
+
+uint64_t AgentProxy::NowMs()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename... Results, typename Decide>
+void AgentProxy::Dispatch(const char *method, sdbus::Result<Results...> &&result, Decide decide)
+{
+  // Shared by the worker and the deadline, whichever replies first
+  auto reply = std::make_shared<sdbus::Result<Results...>>(std::move(result));
+  uint32_t id = Track(method, [reply](const sdbus::Error &error) { reply->returnError(error); });
+  uint64_t flowId = Trace::NewFlowId();
+  Trace::FlowStart("pairing", method, flowId);
+  m_workers.Post([this, id, method, flowId, reply, decide = std::move(decide)]() {
+    TRACE_SCOPE_FLOW("pairing", method, flowId);
+    // Behind a backlog the deadline may pass before a worker is free; skip the decision then
+    if (!Pending(id)) {
+      return;
+    }
+    try
+    {
+      if constexpr (sizeof...(Results) == 0) {
+        decide();
+        if (Complete(id)) {
+          reply->returnResults();
+        }
+      }
+      else {
+        auto value = decide();
+        if (Complete(id)) {
+          reply->returnResults(value);
+        }
+      }
+    }
+    catch(const sdbus::Error& e)
+    {
+      Log("%s%s Rejected - %s %s", TAG, method, e.getName().c_str(), e.what());
+      if (Complete(id)) {
+        reply->returnError(e);
+      }
+    }
+  });
+}
+
+uint32_t AgentProxy::Track(const char *method, Rejecter reject)
+{
+  std::lock_guard<std::mutex> lock(m_pendingMutex);
+  uint32_t id = m_nextId++;
+  bool earliest = m_deadlines.Empty();
+  m_pending.emplace(id, PendingRequest{method, std::move(reject)});
+  m_deadlines.Schedule(id, NowMs() + AGENT_REQUEST_TIMEOUT_MS);
+  // Every request has the same timeout, so a later one never expires before those already
+  // waiting; only the first one moves the deadline thread's wakeup
+  if (earliest) {
+    m_pendingCV.notify_one();
+  }
+  return id;
+}
+
+bool AgentProxy::Pending(uint32_t id)
+{
+  std::lock_guard<std::mutex> lock(m_pendingMutex);
+  return m_pending.count(id) != 0;
+}
+
+bool AgentProxy::Complete(uint32_t id)
+{
+  std::lock_guard<std::mutex> lock(m_pendingMutex);
+  m_deadlines.Cancel(id);
+  return m_pending.erase(id) != 0;
+}
+
+void AgentProxy::RejectAll(const sdbus::Error &error)
+{
+  std::unordered_map<uint32_t, PendingRequest> pending;
+  {
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    pending.swap(m_pending);
+    for (const auto &request : pending) {
+      m_deadlines.Cancel(request.first);
+    }
+  }
+  for (const auto &request : pending) {
+    Log("%s%s %s - %s", TAG, __func__, request.second.method, error.getName().c_str());
+    request.second.reject(error);
+  }
+}
+
+void AgentProxy::RunDeadlines()
+{
+  Trace::SetThreadName("AgentDeadlines");
+  std::unique_lock<std::mutex> lock(m_pendingMutex);
+  while (m_running) {
+    int waitMs = m_deadlines.NextTimeoutMs(NowMs());
+    if (waitMs < 0) {
+      m_pendingCV.wait(lock);
+    }
+    else {
+      m_pendingCV.wait_for(lock, std::chrono::milliseconds(waitMs));
+    }
+    std::vector<PendingRequest> expired;
+    m_deadlines.Advance(NowMs(), [this, &expired](uint32_t id) {
+      auto it = m_pending.find(id);
+      if (it != m_pending.end()) {
+        expired.push_back(std::move(it->second));
+        m_pending.erase(it);
+      }
+    });
+    if (expired.empty()) {
+      continue;
+    }
+    // Reply without the lock; workers finishing meanwhile find their request gone
+    lock.unlock();
+    m_timedOut.Add(expired.size());
+    sdbus::Error error(sdbus::Error::Name{AGENT_ERROR_REJECTED}, "Agent request timed out");
+    for (const auto &request : expired) {
+      Log("%s%s %s timed out after %d ms", TAG, __func__, request.method, AGENT_REQUEST_TIMEOUT_MS);
+      request.reject(error);
+    }
+    lock.lock();
+  }
 }
 
 void AgentProxy::Release()
 {
+  WATCHDOG_HANDLER("AgentProxy::Release");
   Log("%s%s", TAG,__func__);
 }
 
-std::string AgentProxy::RequestPinCode(const sdbus::ObjectPath& arg0)
+void AgentProxy::RequestPinCode(sdbus::Result<std::string>&& result, sdbus::ObjectPath arg0)
 {
+  WATCHDOG_HANDLER("AgentProxy::RequestPinCode");
   Log("%s%s Path - %s", TAG,__func__, LOG_STRING(std::string(arg0)));
-  return "1";
+  Dispatch("RequestPinCode", std::move(result), [this, path = std::string(arg0)]() {
+    return m_agent.RequestPinCode(path);
+  });
 }
 
 void AgentProxy::DisplayPinCode(const sdbus::ObjectPath& arg0, const std::string& arg1)
 {
+  WATCHDOG_HANDLER("AgentProxy::DisplayPinCode");
   Log("%s%s Path - %s, PIN - %d", TAG,__func__, LOG_STRING(std::string(arg0)), arg1);
 }
 
-uint32_t AgentProxy::RequestPasskey(const sdbus::ObjectPath& arg0)
+void AgentProxy::RequestPasskey(sdbus::Result<uint32_t>&& result, sdbus::ObjectPath arg0)
 {
+  WATCHDOG_HANDLER("AgentProxy::RequestPasskey");
   Log("%s%s Path - %s", TAG,__func__, LOG_STRING(std::string(arg0)));
-  return 1;
+  Dispatch("RequestPasskey", std::move(result), [this, path = std::string(arg0)]() {
+    return m_agent.RequestPasskey(path);
+  });
 }
 
 void AgentProxy::DisplayPasskey(const sdbus::ObjectPath& arg0, const uint32_t& arg1, const uint16_t& arg2)
 {
-  Log("%s%s Path - %s, Pass - %d", TAG,__func__, LOG_STRING(std::string(arg0)), arg1);
+  WATCHDOG_HANDLER("AgentProxy::DisplayPasskey");
+  Log("%s%s Path - %s, Pass - %d, Entered - %d", TAG,__func__, LOG_STRING(std::string(arg0)), arg1, arg2);
 }
 
-void AgentProxy::RequestConfirmation(const sdbus::ObjectPath& arg0, const uint32_t& arg1)
+void AgentProxy::RequestConfirmation(sdbus::Result<>&& result, sdbus::ObjectPath arg0, uint32_t arg1)
 {
+  WATCHDOG_HANDLER("AgentProxy::RequestConfirmation");
   Log("%s%s Path - %s, Confirm - %d", TAG,__func__, LOG_STRING(std::string(arg0)), arg1);
-  m_agent.RequestConfirmation(std::string(arg0));
+  Dispatch("RequestConfirmation", std::move(result), [this, path = std::string(arg0), arg1]() {
+    m_agent.RequestConfirmation(path, arg1);
+  });
 }
 
 void AgentProxy::RequestAuthorization(const sdbus::ObjectPath& arg0)
 {
+  WATCHDOG_HANDLER("AgentProxy::RequestAuthorization");
   Log("%s%s Path - %s", TAG,__func__, LOG_STRING(std::string(arg0)));
 }
 
-void AgentProxy::AuthorizeService(const sdbus::ObjectPath& arg0, const std::string& arg1)
+void AgentProxy::AuthorizeService(sdbus::Result<>&& result, sdbus::ObjectPath arg0, std::string arg1)
 {
+  WATCHDOG_HANDLER("AgentProxy::AuthorizeService");
   Log("%s%s Path - %s, Service - %s", TAG,__func__, LOG_STRING(std::string(arg0)), LOG_STRING(arg1));
+  Dispatch("AuthorizeService", std::move(result), [this, path = std::string(arg0), uuid = std::move(arg1)]() {
+    m_agent.AuthorizeService(path, uuid);
+  });
 }
 
 void AgentProxy::Cancel()
 {
+  WATCHDOG_HANDLER("AgentProxy::Cancel");
   Log("%s%s", TAG,__func__);
+  RejectAll(sdbus::Error(sdbus::Error::Name{AGENT_ERROR_CANCELED}, "Request cancelled by BlueZ"));
 }
@@ -7,9 +7,21 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 #include "Agent1-adapter-generated.hpp"
 
 #include "IAgent.h"
+#include "CommandExecutor.h"
+#include "Metrics.h"
+#include "TimerWheel.h"
 
 /**
  * @class AgentProxy
@@ -19,6 +31,15 @@
  * authentication requests. It acts as a D-Bus service that BlueZ calls
  * during pairing operations, including PIN code requests, passkey display,
  * confirmation requests, and authorization operations.
+ *
+ * RequestPinCode, RequestPasskey, RequestConfirmation and AuthorizeService
+ * are asynchronous on the server side: the D-Bus thread only queues the
+ * request and returns, and IAgent decides it on a worker thread, which
+ * sends the reply. Every request has a deadline; a request still
+ * undecided when it passes is rejected with org.bluez.Error.Rejected and
+ * the late decision is dropped, so a slow decision never holds up other
+ * bus traffic or leaves BlueZ waiting. Cancel() rejects every request in
+ * flight.
  */
 class AgentProxy : public sdbus::AdaptorInterfaces<org::bluez::Agent1_adaptor>
 {
@@ -47,12 +68,12 @@ protected:
   
   /**
    * @brief Request PIN code from user (BlueZ Agent1 interface method)
+   * @param result Reply, sent from a worker thread with the PIN code entered by user
    * @param arg0 D-Bus object path of the device requesting PIN
-   * @return PIN code string entered by user
    * 
    * Called during legacy pairing when a PIN code is required.
    */
-  std::string RequestPinCode(const sdbus::ObjectPath& arg0) override;
+  void RequestPinCode(sdbus::Result<std::string>&& result, sdbus::ObjectPath arg0) override;
   
   /**
    * @brief Display PIN code to user (BlueZ Agent1 interface method)
@@ -65,12 +86,12 @@ protected:
   
   /**
    * @brief Request passkey from user (BlueZ Agent1 interface method)
+   * @param result Reply, sent from a worker thread with the numeric passkey entered by user
    * @param arg0 D-Bus object path of the device requesting passkey
-   * @return Numeric passkey entered by user
    * 
    * Called during pairing when a numeric passkey is required.
    */
-  uint32_t RequestPasskey(const sdbus::ObjectPath& arg0) override;
+  void RequestPasskey(sdbus::Result<uint32_t>&& result, sdbus::ObjectPath arg0) override;
   
   /**
    * @brief Display passkey to user (BlueZ Agent1 interface method)
@@ -84,13 +105,14 @@ protected:
   
   /**
    * @brief Request confirmation of passkey (BlueZ Agent1 interface method)
+   * @param result Reply, sent from a worker thread
    * @param arg0 D-Bus object path of the device
    * @param arg1 Passkey to confirm
    * 
    * Called when the user needs to confirm that the displayed passkey
    * matches the one shown on the device.
    */
-  void RequestConfirmation(const sdbus::ObjectPath& arg0, const uint32_t& arg1) override;
+  void RequestConfirmation(sdbus::Result<>&& result, sdbus::ObjectPath arg0, uint32_t arg1) override;
   
   /**
    * @brief Request authorization for connection (BlueZ Agent1 interface method)
@@ -102,12 +124,13 @@ protected:
   
   /**
    * @brief Authorize specific service access (BlueZ Agent1 interface method)
+   * @param result Reply, sent from a worker thread
    * @param arg0 D-Bus object path of the device
    * @param arg1 UUID of the service requesting authorization
    * 
    * Called when a device requests access to a specific service.
    */
-  void AuthorizeService(const sdbus::ObjectPath& arg0, const std::string& arg1) override;
+  void AuthorizeService(sdbus::Result<>&& result, sdbus::ObjectPath arg0, std::string arg1) override;
   
   /**
    * @brief Cancel ongoing authentication operation (BlueZ Agent1 interface method)
@@ -116,7 +139,78 @@ protected:
    */
   void Cancel() override;
   
+private:
+  /// Sends an error reply to a request
+  typedef std::function<void(const sdbus::Error &)> Rejecter;
+
+  /**
+   * @brief Have a worker decide a request and reply, unless its deadline passes first
+   * @param method Agent1 method, for logging
+   * @param result Reply of the request
+   * @param decide Calls IAgent and returns the reply values; throws sdbus::Error to reject
+   */
+  template <typename... Results, typename Decide>
+  void Dispatch(const char *method, sdbus::Result<Results...> &&result, Decide decide);
+
+  /**
+   * @brief Record a request in flight and start its deadline
+   * @param method Agent1 method, for logging
+   * @param reject Sends the error reply if the deadline passes
+   * @return Request id
+   */
+  uint32_t Track(const char *method, Rejecter reject);
+
+  /**
+   * @brief Check whether a request still awaits its decision
+   * @param id Request id
+   * @return False if the request was already rejected or cancelled
+   */
+  bool Pending(uint32_t id);
+
+  /**
+   * @brief Claim the right to reply to a request
+   * @param id Request id
+   * @return False if the request was already rejected or cancelled
+   */
+  bool Complete(uint32_t id);
+
+  /**
+   * @brief Reject every request in flight
+   * @param error Error to reply with
+   */
+  void RejectAll(const sdbus::Error &error);
+
+  /**
+   * @brief Reject requests as their deadlines pass, until destruction
+   */
+  void RunDeadlines();
+
+  /**
+   * @brief Get the current time for deadlines
+   * @return Milliseconds on the steady clock
+   */
+  static uint64_t NowMs();
+
+  /**
+   * @struct PendingRequest
+   * @brief Request waiting for its decision
+   */
+  typedef struct
+  {
+    const char *method; ///< Agent1 method
+    Rejecter reject;    ///< Sends the error reply
+  } PendingRequest;
+
 private:
   sdbus::IConnection &m_connection; ///< Reference to D-Bus connection
   IAgent &m_agent;                  ///< Reference to callback interface
+  std::mutex m_pendingMutex;        ///< Protects the members below up to m_running
+  std::condition_variable m_pendingCV; ///< Wakes the deadline thread for an earlier deadline or shutdown
+  std::unordered_map<uint32_t, PendingRequest> m_pending; ///< Requests in flight by id
+  TimerWheel m_deadlines;           ///< Deadline of each request in flight
+  uint32_t m_nextId;                ///< Next request id
+  bool m_running;                   ///< Deadline thread keeps running while set
+  Counter &m_timedOut;              ///< Requests rejected at their deadline
+  std::thread m_deadlineThread;     ///< Rejects requests past their deadline
+  CommandExecutor m_workers;        ///< Decide requests; declared last so it stops first
 };
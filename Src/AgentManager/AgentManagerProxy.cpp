@@ -1,8 +1,10 @@
 #include "AgentManagerProxy.h"
+#include "DBusCallMetrics.h"
 #include "Logger.h"
 #include <sdbus-c++/Error.h>
 
 #define TAG "AgentManagerProxy::"
+#define AGENT_MANAGER_INTERFACE_NAME "org.bluez.AgentManager1" ///< Interface label of the call metrics
 
 std::string AGENT_MANAGER_WELLKNOWN_NAME = "org.bluez";
 std::string AGENT_MANAGER_INTERFACE_OBJECT_PATH = "/org/bluez";
@@ -25,7 +27,7 @@ void AgentManagerProxy::RegisterAgent(const sdbus::ObjectPath& agent, const std:
 {
   Log("%s%s", TAG,__func__);
   try {
-    org::bluez::AgentManager1_proxy::RegisterAgent(agent, capability);
+    DBUS_CALL(AGENT_MANAGER_INTERFACE_NAME, "RegisterAgent", org::bluez::AgentManager1_proxy::RegisterAgent(agent, capability));
   } catch (const sdbus::Error& e) {
     Log("%s%s: D-Bus error: %s", TAG, __func__, e.what());
     return;
@@ -36,7 +38,7 @@ void AgentManagerProxy::UnregisterAgent(const sdbus::ObjectPath& agent)
 {
   Log("%s%s", TAG,__func__);
   try {
-    org::bluez::AgentManager1_proxy::UnregisterAgent(agent);
+    DBUS_CALL(AGENT_MANAGER_INTERFACE_NAME, "UnregisterAgent", org::bluez::AgentManager1_proxy::UnregisterAgent(agent));
   } catch (const sdbus::Error& e) {
     Log("%s%s: D-Bus error: %s", TAG, __func__, e.what());
     return;
@@ -47,7 +49,7 @@ void AgentManagerProxy::RequestDefaultAgent(const sdbus::ObjectPath& agent)
 {
   Log("%s%s", TAG,__func__);
   try {
-    org::bluez::AgentManager1_proxy::RequestDefaultAgent(agent);
+    DBUS_CALL(AGENT_MANAGER_INTERFACE_NAME, "RequestDefaultAgent", org::bluez::AgentManager1_proxy::RequestDefaultAgent(agent));
   } catch (const sdbus::Error& e) {
     Log("%s%s: D-Bus error: %s", TAG, __func__, e.what());
     return;
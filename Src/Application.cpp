@@ -2,12 +2,16 @@
 
 #define TAG "Application::"
 
-Application::Application(sdbus::IConnection &connection, std::string hcidevice, std::string deviceName, std::string deviceClass):
+Application::Application(sdbus::IConnection &connection, std::string hcidevice, std::string deviceName, std::string deviceClass, const SPPConfig &sppConfig, const DeviceManagerConfig &deviceConfig, std::string metricsPath, uint32_t stallThresholdMs):
 m_running(true),
 m_connection(connection),
 m_hcidevice(hcidevice),
 m_deviceName(deviceName),
-m_deviceClassStr(deviceClass)
+m_deviceClassStr(deviceClass),
+m_sppConfig(sppConfig),
+m_deviceConfig(deviceConfig),
+m_metricsPath(metricsPath),
+m_stallThresholdMs(stallThresholdMs)
 {
   Log("%s%s", TAG, __func__);
   if(m_deviceClassStr == "SMARTPHONE") {
@@ -15,11 +19,11 @@ m_deviceClassStr(deviceClass)
   } else {
     m_deviceClass = 0x240408;
   }
-  m_deviceManager = std::make_unique<DeviceManager>(m_connection);
+  m_deviceManager = std::make_unique<DeviceManager>(m_connection, m_deviceConfig);
   m_agent = std::make_unique<Agent>(m_connection, AGENT_MANAGER_PATH, *m_deviceManager);
   m_agentManager = std::make_unique<AgentManager>(m_connection, AGENT_MANAGER_PATH);
   m_adapter = std::make_unique<Adapter>(m_connection, m_hcidevice, m_deviceName, m_deviceClass);
-  m_profileManager = std::make_unique<ProfileManager>(m_connection);
+  m_profileManager = std::make_unique<ProfileManager>(m_connection, m_sppConfig);
   m_objProxy = std::make_unique<ObjectManagerProxy>(m_connection, *m_deviceManager);
 }
 
@@ -56,6 +60,23 @@ void Application::StartApplication()
 
   m_profileManager->RegisterProfile(sdbus::ObjectPath(SPP_PATH), SPP_UUID, options);
 
+  if(!m_metricsPath.empty()) {
+    m_metricsServer = std::make_unique<MetricsServer>(m_metricsPath);
+    if(!m_metricsServer->Start()) {
+      m_metricsServer.reset();
+    } else {
+      // Timing every proxy call is only worth it when someone can scrape it
+      DBusCallSite::Enable(true);
+    }
+  }
+
+  if(m_stallThresholdMs > 0) {
+    m_watchdog = std::make_unique<DispatchWatchdog>(m_stallThresholdMs);
+    if(!m_watchdog->Start()) {
+      m_watchdog.reset();
+    }
+  }
+
   // Start the event loop asynchronously in a separate thread
   m_eventLoopThread = std::thread(&Application::runEventLoopAsync, this, std::ref(m_connection));
     
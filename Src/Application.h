@@ -18,8 +18,13 @@
 #include "AgentManager.h"
 #include "Agent.h"
 #include "DeviceManager.h"
+#include "DeviceManagerConfig.h"
+#include "DBusCallMetrics.h"
+#include "DispatchWatchdog.h"
+#include "MetricsServer.h"
 #include "ObjectManagerProxy.h"
 #include "ProfileManager.h"
+#include "SPPConfig.h"
 
 #include "Logger.h"
 
@@ -45,8 +50,12 @@ public:
    * @param hcidevice HCI device identifier (e.g., "hci0")
    * @param deviceName Human-readable name for this device
    * @param deviceClass Device class string ("SMARTPHONE" or "HELMET")
+   * @param sppConfig Options applied to SPP connections
+   * @param deviceConfig Device registry caps
+   * @param metricsPath Unix socket path for the metrics endpoint, empty to disable it
+   * @param stallThresholdMs Bus handler time reported as a stall, 0 to disable the watchdog
    */
-  Application(sdbus::IConnection &connection, std::string hcidevice, std::string deviceName, std::string deviceClass);
+  Application(sdbus::IConnection &connection, std::string hcidevice, std::string deviceName, std::string deviceClass, const SPPConfig &sppConfig, const DeviceManagerConfig &deviceConfig, std::string metricsPath, uint32_t stallThresholdMs);
   
   /**
    * @brief Destroy the Application object and cleanup all resources
@@ -99,6 +108,8 @@ private:
   std::string m_deviceName;                    ///< Human-readable device name
   std::string m_deviceClassStr;                ///< Device class string ("SMARTPHONE"/"HELMET")
   uint32_t m_deviceClass;                      ///< Numeric device class value
+  SPPConfig m_sppConfig;                       ///< Options applied to SPP connections
+  DeviceManagerConfig m_deviceConfig;          ///< Device registry caps
   std::unique_ptr<AgentManager> m_agentManager;///< Manages pairing agent registration
   std::unique_ptr<Agent> m_agent;              ///< Handles pairing requests and authentication
   std::unique_ptr<Adapter> m_adapter;          ///< Bluetooth adapter management
@@ -107,4 +118,8 @@ private:
   std::unique_ptr<ProfileManager> m_profileManager; ///< Bluetooth profile management
   std::atomic<bool> m_running;                 ///< Application running state flag
   std::thread m_eventLoopThread;               ///< Thread for D-Bus event processing
+  std::string m_metricsPath;                   ///< Metrics socket path, empty when disabled
+  std::unique_ptr<MetricsServer> m_metricsServer; ///< Metrics endpoint, stopped before the subsystems it reports on
+  uint32_t m_stallThresholdMs;                 ///< Bus handler time reported as a stall, 0 when disabled
+  std::unique_ptr<DispatchWatchdog> m_watchdog; ///< Stall detector for the D-Bus dispatch thread
 };
@@ -0,0 +1,179 @@
+/**
+ * @file BufferPool.cpp
+ * @brief Implementation of the fixed-size chunk pool used for SPP data
+ * @author Gokul
+ * @date 2025
+ */
+
+#include "BufferPool.h"
+
+#include "Logger.h"
+
+#define TAG "BufferPool::" ///< Tag for logging messages
+
+BufferHandle::BufferHandle(BufferPool *pool, uint32_t index, uint32_t offset, uint32_t size) : m_pool(pool),
+                                                                                              m_index(index),
+                                                                                              m_offset(offset),
+                                                                                              m_size(size)
+{
+}
+
+BufferHandle::BufferHandle(const BufferHandle &other) : m_pool(other.m_pool),
+                                                        m_index(other.m_index),
+                                                        m_offset(other.m_offset),
+                                                        m_size(other.m_size)
+{
+  if (m_pool)
+  {
+    m_pool->AddRef(m_index);
+  }
+}
+
+BufferHandle::BufferHandle(BufferHandle &&other) noexcept : m_pool(other.m_pool),
+                                                            m_index(other.m_index),
+                                                            m_offset(other.m_offset),
+                                                            m_size(other.m_size)
+{
+  other.m_pool = nullptr;
+}
+
+BufferHandle &BufferHandle::operator=(const BufferHandle &other)
+{
+  if (this != &other)
+  {
+    BufferHandle copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+BufferHandle &BufferHandle::operator=(BufferHandle &&other) noexcept
+{
+  if (this != &other)
+  {
+    Reset();
+    m_pool = other.m_pool;
+    m_index = other.m_index;
+    m_offset = other.m_offset;
+    m_size = other.m_size;
+    other.m_pool = nullptr;
+  }
+  return *this;
+}
+
+BufferHandle::~BufferHandle()
+{
+  Reset();
+}
+
+char *BufferHandle::Data() const
+{
+  return m_pool ? m_pool->ChunkData(m_index) + m_offset : nullptr;
+}
+
+size_t BufferHandle::Capacity() const
+{
+  return m_pool ? m_pool->ChunkSize() - m_offset : 0;
+}
+
+void BufferHandle::SetSize(size_t size)
+{
+  m_size = static_cast<uint32_t>(size < Capacity() ? size : Capacity());
+}
+
+BufferHandle BufferHandle::Slice(size_t offset, size_t size) const
+{
+  if (!m_pool || offset + size > Capacity())
+  {
+    return BufferHandle();
+  }
+  m_pool->AddRef(m_index);
+  return BufferHandle(m_pool, m_index, m_offset + static_cast<uint32_t>(offset), static_cast<uint32_t>(size));
+}
+
+void BufferHandle::Reset()
+{
+  if (m_pool)
+  {
+    m_pool->Release(m_index);
+    m_pool = nullptr;
+  }
+  m_offset = 0;
+  m_size = 0;
+}
+
+/**
+ * @brief Construct a new Buffer Pool object
+ *
+ * Allocates all chunk storage up front and pushes every chunk on the free
+ * stack, so no allocation happens on the data path afterwards.
+ *
+ * @param chunkSize Size of each chunk in bytes
+ * @param chunkCount Number of chunks in the pool
+ */
+BufferPool::BufferPool(size_t chunkSize, size_t chunkCount) : m_chunkSize(chunkSize),
+                                                              m_chunkCount(chunkCount),
+                                                              m_storage(new char[chunkSize * chunkCount]),
+                                                              m_refs(new std::atomic<uint32_t>[chunkCount]),
+                                                              m_next(new std::atomic<uint32_t>[chunkCount]),
+                                                              m_freeHead(chunkCount ? 1 : 0),
+                                                              m_available(chunkCount)
+{
+  Log("%s%s Chunk Size - %zu, Chunk Count - %zu", TAG, __func__, chunkSize, chunkCount);
+  for (size_t i = 0; i < chunkCount; ++i)
+  {
+    m_refs[i].store(0, std::memory_order_relaxed);
+    m_next[i].store(i + 1 < chunkCount ? static_cast<uint32_t>(i + 2) : 0, std::memory_order_relaxed);
+  }
+}
+
+BufferPool::~BufferPool()
+{
+  Log("%s%s", TAG, __func__);
+  if (Available() != m_chunkCount)
+  {
+    Log("%s%s Error: %zu chunks still referenced", TAG, __func__, m_chunkCount - Available());
+  }
+}
+
+BufferHandle BufferPool::Acquire()
+{
+  uint64_t head = m_freeHead.load(std::memory_order_acquire);
+  while (true)
+  {
+    uint32_t top = static_cast<uint32_t>(head);
+    if (top == 0)
+    {
+      return BufferHandle();
+    }
+    uint32_t next = m_next[top - 1].load(std::memory_order_relaxed);
+    uint64_t newHead = ((head >> 32) + 1) << 32 | next;
+    if (m_freeHead.compare_exchange_weak(head, newHead, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+      m_available.fetch_sub(1, std::memory_order_relaxed);
+      m_refs[top - 1].store(1, std::memory_order_relaxed);
+      return BufferHandle(this, top - 1, 0, 0);
+    }
+  }
+}
+
+void BufferPool::AddRef(uint32_t index)
+{
+  m_refs[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+void BufferPool::Release(uint32_t index)
+{
+  if (m_refs[index].fetch_sub(1, std::memory_order_acq_rel) != 1)
+  {
+    return;
+  }
+  uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+  uint64_t newHead = 0;
+  do
+  {
+    m_next[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+    newHead = ((head >> 32) + 1) << 32 | (index + 1);
+  } while (!m_freeHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+  m_available.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,187 @@
+/**
+ * @file BufferPool.h
+ * @brief Fixed-size chunk pool with reference-counted handles for SPP data
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class BufferPool;
+
+/**
+ * @class BufferHandle
+ * @brief Reference-counted view onto a chunk owned by a BufferPool
+ *
+ * Copying a handle only bumps the chunk reference count, so received data,
+ * frames and send queues can share one chunk without copying bytes. The
+ * chunk returns to the pool when the last handle is destroyed. A handle
+ * covers a byte range [offset, offset + size) of its chunk; Slice() makes
+ * a narrower view of the same chunk.
+ */
+class BufferHandle
+{
+public:
+  /**
+   * @brief Construct an empty handle
+   */
+  BufferHandle() = default;
+
+  BufferHandle(const BufferHandle &other);
+  BufferHandle(BufferHandle &&other) noexcept;
+  BufferHandle &operator=(const BufferHandle &other);
+  BufferHandle &operator=(BufferHandle &&other) noexcept;
+
+  /**
+   * @brief Release the reference held on the chunk
+   */
+  ~BufferHandle();
+
+  /**
+   * @brief Check whether the handle refers to a chunk
+   * @return True if a chunk is attached
+   */
+  explicit operator bool() const { return m_pool != nullptr; }
+
+  /**
+   * @brief Get a pointer to the start of the viewed range
+   * @return Writable pointer into the chunk
+   */
+  char *Data() const;
+
+  /**
+   * @brief Get the number of valid bytes in the view
+   * @return Size in bytes
+   */
+  size_t Size() const { return m_size; }
+
+  /**
+   * @brief Get the number of bytes available from the view start to the chunk end
+   * @return Capacity in bytes
+   */
+  size_t Capacity() const;
+
+  /**
+   * @brief Set the number of valid bytes in the view
+   * @param size New size, clamped to Capacity()
+   */
+  void SetSize(size_t size);
+
+  /**
+   * @brief Create a handle viewing part of this one, sharing the chunk
+   * @param offset Offset relative to this view
+   * @param size Number of bytes in the new view
+   * @return New handle, or an empty handle if the range is out of bounds
+   */
+  BufferHandle Slice(size_t offset, size_t size) const;
+
+  /**
+   * @brief Release the chunk reference and make the handle empty
+   */
+  void Reset();
+
+private:
+  friend class BufferPool;
+
+  /**
+   * @brief Attach to a chunk whose reference has already been taken
+   */
+  BufferHandle(BufferPool *pool, uint32_t index, uint32_t offset, uint32_t size);
+
+  BufferPool *m_pool = nullptr; ///< Owning pool, null for an empty handle
+  uint32_t m_index = 0;         ///< Chunk index within the pool
+  uint32_t m_offset = 0;        ///< Start of the view within the chunk
+  uint32_t m_size = 0;          ///< Valid bytes in the view
+};
+
+/**
+ * @class BufferPool
+ * @brief Bounded slab of fixed-size chunks shared across SPP connections
+ *
+ * All chunks are allocated up front, so memory use is fixed regardless of the
+ * number of links. Free chunks are kept on a lock-free stack (index plus ABA
+ * tag packed into one 64-bit word) so acquire/release never take a lock on
+ * the data path. When the pool is exhausted Acquire() returns an empty handle
+ * and the caller applies backpressure instead of allocating.
+ */
+class BufferPool
+{
+public:
+  /**
+   * @brief Construct a new Buffer Pool object
+   * @param chunkSize Size of each chunk in bytes
+   * @param chunkCount Number of chunks in the pool
+   */
+  BufferPool(size_t chunkSize, size_t chunkCount);
+
+  /**
+   * @brief Destroy the Buffer Pool object
+   *
+   * All handles must have been released before the pool is destroyed.
+   */
+  ~BufferPool();
+
+  BufferPool(const BufferPool &) = delete;
+  BufferPool &operator=(const BufferPool &) = delete;
+
+  /**
+   * @brief Take a free chunk from the pool
+   * @return Handle spanning the whole chunk with size 0, or empty if exhausted
+   */
+  BufferHandle Acquire();
+
+  /**
+   * @brief Get the size of each chunk
+   * @return Chunk size in bytes
+   */
+  size_t ChunkSize() const { return m_chunkSize; }
+
+  /**
+   * @brief Get the total number of chunks
+   * @return Chunk count
+   */
+  size_t ChunkCount() const { return m_chunkCount; }
+
+  /**
+   * @brief Get the number of chunks currently free
+   * @return Free chunk count
+   */
+  size_t Available() const { return m_available.load(std::memory_order_relaxed); }
+
+private:
+  friend class BufferHandle;
+
+  /**
+   * @brief Add a reference to a chunk
+   * @param index Chunk index
+   */
+  void AddRef(uint32_t index);
+
+  /**
+   * @brief Drop a reference to a chunk, returning it to the free stack at zero
+   * @param index Chunk index
+   */
+  void Release(uint32_t index);
+
+  /**
+   * @brief Get the start of a chunk
+   * @param index Chunk index
+   * @return Pointer to the chunk storage
+   */
+  char *ChunkData(uint32_t index) const { return m_storage.get() + static_cast<size_t>(index) * m_chunkSize; }
+
+private:
+  size_t m_chunkSize;                                 ///< Size of each chunk in bytes
+  size_t m_chunkCount;                                ///< Number of chunks
+  std::unique_ptr<char[]> m_storage;                  ///< Contiguous chunk storage
+  std::unique_ptr<std::atomic<uint32_t>[]> m_refs;    ///< Per-chunk reference counts
+  std::unique_ptr<std::atomic<uint32_t>[]> m_next;    ///< Free stack links (index + 1, 0 = end)
+  std::atomic<uint64_t> m_freeHead;                   ///< Free stack head: tag << 32 | (index + 1)
+  std::atomic<size_t> m_available;                    ///< Number of free chunks
+};
@@ -0,0 +1,190 @@
+/**
+ * @file Checksum.cpp
+ * @brief Implementation of CRC-32C and CRC-16 checksums
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <array>
+#include <cstring>
+
+#include "Checksum.h"
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#define CRC32C_POLY 0x82F63B78u ///< CRC-32C polynomial, reflected
+#define CRC16_POLY 0x1021u      ///< CRC-16/CCITT polynomial
+
+namespace
+{
+using Crc32cFunction = uint32_t (*)(const uint8_t *, size_t, uint32_t);
+
+/// Slicing-by-8 tables: table[k][b] is the CRC of byte b followed by k zero bytes
+constexpr std::array<std::array<uint32_t, 256>, 8> MakeCrc32cTables()
+{
+  std::array<std::array<uint32_t, 256>, 8> tables = {};
+  for (uint32_t b = 0; b < 256; ++b)
+  {
+    uint32_t crc = b;
+    for (int bit = 0; bit < 8; ++bit)
+    {
+      crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+    }
+    tables[0][b] = crc;
+  }
+  for (uint32_t b = 0; b < 256; ++b)
+  {
+    for (size_t k = 1; k < 8; ++k)
+    {
+      tables[k][b] = (tables[k - 1][b] >> 8) ^ tables[0][tables[k - 1][b] & 0xFF];
+    }
+  }
+  return tables;
+}
+
+constexpr std::array<uint16_t, 256> MakeCrc16Table()
+{
+  std::array<uint16_t, 256> table = {};
+  for (uint32_t b = 0; b < 256; ++b)
+  {
+    uint16_t crc = static_cast<uint16_t>(b << 8);
+    for (int bit = 0; bit < 8; ++bit)
+    {
+      crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ CRC16_POLY : crc << 1);
+    }
+    table[b] = crc;
+  }
+  return table;
+}
+
+constexpr auto CRC32C_TABLES = MakeCrc32cTables();
+constexpr auto CRC16_TABLE = MakeCrc16Table();
+
+uint32_t Crc32cSoftware(const uint8_t *p, size_t len, uint32_t crc)
+{
+  while (len && (reinterpret_cast<uintptr_t>(p) & 7))
+  {
+    crc = (crc >> 8) ^ CRC32C_TABLES[0][(crc ^ *p++) & 0xFF];
+    --len;
+  }
+  while (len >= 8)
+  {
+    // Little-endian: the first four bytes fold into the running CRC
+    uint32_t low;
+    uint32_t high;
+    memcpy(&low, p, 4);
+    memcpy(&high, p + 4, 4);
+    low ^= crc;
+    crc = CRC32C_TABLES[7][low & 0xFF] ^ CRC32C_TABLES[6][(low >> 8) & 0xFF] ^
+          CRC32C_TABLES[5][(low >> 16) & 0xFF] ^ CRC32C_TABLES[4][low >> 24] ^
+          CRC32C_TABLES[3][high & 0xFF] ^ CRC32C_TABLES[2][(high >> 8) & 0xFF] ^
+          CRC32C_TABLES[1][(high >> 16) & 0xFF] ^ CRC32C_TABLES[0][high >> 24];
+    p += 8;
+    len -= 8;
+  }
+  while (len--)
+  {
+    crc = (crc >> 8) ^ CRC32C_TABLES[0][(crc ^ *p++) & 0xFF];
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t Crc32cHardware(const uint8_t *p, size_t len, uint32_t crc)
+{
+  uint64_t crc64 = crc;
+  while (len >= 8)
+  {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+    p += 8;
+    len -= 8;
+  }
+  crc = static_cast<uint32_t>(crc64);
+  while (len--)
+  {
+    crc = _mm_crc32_u8(crc, *p++);
+  }
+  return crc;
+}
+
+bool HardwareSupported()
+{
+  return __builtin_cpu_supports("sse4.2");
+}
+#define CRC32C_HARDWARE_NAME "sse4.2"
+#elif defined(__aarch64__)
+__attribute__((target("+crc"))) uint32_t Crc32cHardware(const uint8_t *p, size_t len, uint32_t crc)
+{
+  while (len >= 8)
+  {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    crc = __crc32cd(crc, word);
+    p += 8;
+    len -= 8;
+  }
+  while (len--)
+  {
+    crc = __crc32cb(crc, *p++);
+  }
+  return crc;
+}
+
+bool HardwareSupported()
+{
+  return getauxval(AT_HWCAP) & HWCAP_CRC32;
+}
+#define CRC32C_HARDWARE_NAME "armv8-crc"
+#endif
+
+Crc32cFunction SelectCrc32c()
+{
+#ifdef CRC32C_HARDWARE_NAME
+  if (HardwareSupported())
+  {
+    return Crc32cHardware;
+  }
+#endif
+  return Crc32cSoftware;
+}
+
+Crc32cFunction Crc32cImpl()
+{
+  static const Crc32cFunction impl = SelectCrc32c();
+  return impl;
+}
+} // namespace
+
+uint32_t Crc32c(const void *data, size_t len, uint32_t crc)
+{
+  return ~Crc32cImpl()(static_cast<const uint8_t *>(data), len, ~crc);
+}
+
+uint16_t Crc16(const void *data, size_t len, uint16_t crc)
+{
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+  while (len--)
+  {
+    crc = static_cast<uint16_t>((crc << 8) ^ CRC16_TABLE[((crc >> 8) ^ *p++) & 0xFF]);
+  }
+  return crc;
+}
+
+const char *Crc32cImplementation()
+{
+#ifdef CRC32C_HARDWARE_NAME
+  if (Crc32cImpl() == Crc32cHardware)
+  {
+    return CRC32C_HARDWARE_NAME;
+  }
+#endif
+  return "slicing-by-8";
+}
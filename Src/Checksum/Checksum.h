@@ -0,0 +1,40 @@
+/**
+ * @file Checksum.h
+ * @brief CRC-32C and CRC-16 checksums for link integrity checks
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Compute a CRC-32C (Castagnoli) checksum
+ *
+ * Uses the SSE4.2 crc32 instruction on x86-64 or the ARMv8 CRC extension on
+ * AArch64 when the CPU supports it, and a slicing-by-8 table otherwise. The
+ * implementation is selected once at runtime.
+ *
+ * @param data Bytes to checksum
+ * @param len Number of bytes
+ * @param crc Result of a previous call to continue a running checksum, 0 to start
+ * @return CRC-32C of the bytes
+ */
+uint32_t Crc32c(const void *data, size_t len, uint32_t crc = 0);
+
+/**
+ * @brief Compute a CRC-16/CCITT-FALSE checksum (poly 0x1021, init 0xFFFF)
+ * @param data Bytes to checksum
+ * @param len Number of bytes
+ * @param crc Result of a previous call to continue a running checksum, 0xFFFF to start
+ * @return CRC-16 of the bytes
+ */
+uint16_t Crc16(const void *data, size_t len, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief Get the name of the CRC-32C implementation in use
+ * @return "sse4.2", "armv8-crc" or "slicing-by-8"
+ */
+const char *Crc32cImplementation();
@@ -0,0 +1,182 @@
+/**
+ * @file CommandExecutor.cpp
+ * @brief Implementation of the shared worker pool and command strands
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <exception>
+
+#include "CommandExecutor.h"
+
+#include "Logger.h"
+#include "Trace.h"
+
+#define TAG "CommandExecutor::" ///< Tag for logging messages
+
+CommandExecutor::CommandExecutor(size_t threadCount) : m_running(true)
+{
+  Log("%s%s Threads - %zu", TAG, __func__, threadCount);
+  for (size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i)
+  {
+    m_workers.emplace_back(&CommandExecutor::RunWorker, this);
+  }
+}
+
+CommandExecutor::~CommandExecutor()
+{
+  Log("%s%s", TAG, __func__);
+  std::deque<std::function<void()>> dropped;
+  {
+    std::lock_guard<std::mutex> lock(m_executorMutex);
+    m_running = false;
+    dropped.swap(m_tasks);
+  }
+  m_executorCV.notify_all();
+  // Outside the lock: destroying a strand's drain task releases the strand
+  dropped.clear();
+  for (auto &worker : m_workers)
+  {
+    if (worker.joinable())
+    {
+      worker.join();
+    }
+  }
+}
+
+void CommandExecutor::Post(std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_executorMutex);
+    if (!m_running)
+    {
+      return;
+    }
+    m_tasks.push_back(std::move(task));
+  }
+  m_executorCV.notify_one();
+}
+
+void CommandExecutor::RunWorker()
+{
+  Trace::SetThreadName("CommandExecutor");
+  while (true)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_executorMutex);
+      m_executorCV.wait(lock, [this] { return !m_running || !m_tasks.empty(); });
+      if (!m_running)
+      {
+        break;
+      }
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    task();
+  }
+}
+
+CommandStrand::CommandStrand(CommandExecutor &executor, std::string name) : m_executor(executor),
+                                                                            m_state(std::make_shared<State>())
+{
+  m_state->name = std::move(name);
+}
+
+CommandStrand::~CommandStrand()
+{
+  Close();
+}
+
+bool CommandStrand::Post(const std::string &key, std::function<void()> command)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    if (m_state->closed)
+    {
+      return false;
+    }
+    auto duplicate = std::find_if(m_state->pending.begin(), m_state->pending.end(),
+                                  [&key](const auto &pending) { return pending.first == key; });
+    if (duplicate != m_state->pending.end())
+    {
+      Log("%s%s %s - %s already pending", TAG, __func__, LOG_STRING(m_state->name), LOG_STRING(key));
+      return false;
+    }
+    m_state->pending.emplace_back(key, std::move(command));
+    if (m_state->scheduled)
+    {
+      return true;
+    }
+    m_state->scheduled = true;
+  }
+  auto ticket = std::make_shared<DrainTicket>();
+  ticket->state = m_state;
+  m_executor.Post([ticket]() {
+    ticket->drained = true;
+    Drain(ticket->state);
+  });
+  return true;
+}
+
+CommandStrand::DrainTicket::~DrainTicket()
+{
+  if (drained)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(state->mutex);
+  if (!state->pending.empty())
+  {
+    Log("%s%s %s - Dropped %zu commands, executor stopped", TAG, __func__, LOG_STRING(state->name), state->pending.size());
+  }
+  state->pending.clear();
+  state->scheduled = false;
+  state->idleCV.notify_all();
+}
+
+void CommandStrand::Drain(const std::shared_ptr<State> &state)
+{
+  std::unique_lock<std::mutex> lock(state->mutex);
+  while (!state->closed && !state->pending.empty())
+  {
+    auto command = std::move(state->pending.front());
+    state->pending.pop_front();
+    state->running = true;
+    lock.unlock();
+    try
+    {
+      command.second();
+    }
+    catch (const std::exception &e)
+    {
+      Log("%s%s %s - %s, Error - %s", TAG, __func__, LOG_STRING(state->name), LOG_STRING(command.first), e.what());
+    }
+    lock.lock();
+    state->running = false;
+    state->idleCV.notify_all();
+  }
+  state->scheduled = false;
+  state->idleCV.notify_all();
+}
+
+void CommandStrand::WaitIdle()
+{
+  std::unique_lock<std::mutex> lock(m_state->mutex);
+  m_state->idleCV.wait(lock, [this] { return !m_state->scheduled || m_state->closed; });
+}
+
+bool CommandStrand::Idle()
+{
+  std::lock_guard<std::mutex> lock(m_state->mutex);
+  return !m_state->scheduled;
+}
+
+void CommandStrand::Close()
+{
+  std::unique_lock<std::mutex> lock(m_state->mutex);
+  m_state->closed = true;
+  m_state->pending.clear();
+  m_state->idleCV.wait(lock, [this] { return !m_state->running; });
+}
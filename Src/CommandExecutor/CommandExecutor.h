@@ -0,0 +1,152 @@
+/**
+ * @file CommandExecutor.h
+ * @brief Shared worker pool and per-device ordered command strands
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @class CommandExecutor
+ * @brief Fixed-size pool of worker threads running posted tasks
+ */
+class CommandExecutor
+{
+public:
+  /**
+   * @brief Construct a new Command Executor object and start its workers
+   * @param threadCount Number of worker threads
+   */
+  explicit CommandExecutor(size_t threadCount);
+
+  /**
+   * @brief Stop the workers; tasks not yet started are dropped
+   *
+   * A strand whose drain task is dropped discards its pending commands and
+   * becomes idle, so CommandStrand::WaitIdle() still returns.
+   */
+  ~CommandExecutor();
+
+  /**
+   * @brief Queue a task to run on one of the workers
+   * @param task Task to run
+   */
+  void Post(std::function<void()> task);
+
+private:
+  /**
+   * @brief Worker thread body
+   */
+  void RunWorker();
+
+private:
+  std::vector<std::thread> m_workers;             ///< Worker threads
+  std::deque<std::function<void()>> m_tasks;      ///< Tasks waiting for a worker
+  std::mutex m_executorMutex;                     ///< Protects m_tasks and m_running
+  std::condition_variable m_executorCV;           ///< Signals new tasks and shutdown
+  bool m_running;                                 ///< Workers keep running while set
+};
+
+/**
+ * @class CommandStrand
+ * @brief Ordered command queue executed on a shared CommandExecutor
+ *
+ * Commands posted to one strand run one at a time in posting order, while
+ * different strands run in parallel on the executor's workers. Each command
+ * has a key describing the operation and its arguments; posting a command
+ * whose key is already waiting in the queue is a no-op, so repeated
+ * requests for the same operation collapse into one.
+ */
+class CommandStrand
+{
+public:
+  /**
+   * @brief Construct a new Command Strand object
+   * @param executor Executor that runs the commands
+   * @param name Name used in log messages
+   */
+  CommandStrand(CommandExecutor &executor, std::string name);
+
+  /**
+   * @brief Destroy the Command Strand object (see Close())
+   */
+  ~CommandStrand();
+
+  /**
+   * @brief Queue a command behind the commands already posted
+   * @param key Operation and arguments, used to drop duplicates
+   * @param command Command to run
+   * @return False if an identical command is already pending or the strand is closed
+   */
+  bool Post(const std::string &key, std::function<void()> command);
+
+  /**
+   * @brief Block until every posted command has run
+   */
+  void WaitIdle();
+
+  /**
+   * @brief Check whether no command is queued or running
+   * @return True if the strand is idle
+   */
+  bool Idle();
+
+  /**
+   * @brief Drop pending commands and wait for the running one to finish
+   *
+   * Must not be called from a command running on this strand.
+   */
+  void Close();
+
+private:
+  /**
+   * @struct State
+   * @brief Strand state shared with the executor tasks that drain it
+   */
+  struct State
+  {
+    std::string name;                                                   ///< Name used in log messages
+    std::mutex mutex;                                                   ///< Protects the members below
+    std::condition_variable idleCV;                                     ///< Signals end of a command or of a drain
+    std::deque<std::pair<std::string, std::function<void()>>> pending;  ///< Commands waiting to run, with their keys
+    bool scheduled = false;                                             ///< A drain task is queued or running
+    bool running = false;                                               ///< A command is running
+    bool closed = false;                                                ///< No more commands are accepted
+  };
+
+  /**
+   * @struct DrainTicket
+   * @brief Carried by a drain task; releases the strand if the executor drops the task unrun
+   */
+  struct DrainTicket
+  {
+    std::shared_ptr<State> state; ///< Strand to drain
+    bool drained = false;         ///< Set once the drain task has started
+
+    /**
+     * @brief Discard the pending commands and clear State::scheduled if the drain never started
+     */
+    ~DrainTicket();
+  };
+
+  /**
+   * @brief Run the pending commands of a strand in order
+   * @param state Strand state
+   */
+  static void Drain(const std::shared_ptr<State> &state);
+
+private:
+  CommandExecutor &m_executor;    ///< Executor that runs the commands
+  std::shared_ptr<State> m_state; ///< Shared strand state
+};
@@ -6,13 +6,57 @@
  */
 
 #include <atomic>
-#include <sstream>
+#include <chrono>
+#include <cstdlib>
 
 #include "Device.h"
 
 #include "Logger.h"
+#include "Metrics.h"
+#include "Trace.h"
 
 #define TAG "Device::" ///< Tag for logging messages
+#define LAST_SEEN_REPORT_MS 1000 ///< Last-seen updates closer together than this are not reported
+
+/// Every cached field with its change bit, for code that handles them all alike
+#define DEVICE_FIELDS(X)                                    \
+  X(DEVICE_FIELD_Address, Address)                          \
+  X(DEVICE_FIELD_AddressType, AddressType)                  \
+  X(DEVICE_FIELD_Name, Name)                                \
+  X(DEVICE_FIELD_Class, Class)                              \
+  X(DEVICE_FIELD_UUIDs, UUIDs)                              \
+  X(DEVICE_FIELD_Paired, Paired)                            \
+  X(DEVICE_FIELD_Connected, Connected)                      \
+  X(DEVICE_FIELD_Trusted, Trusted)                          \
+  X(DEVICE_FIELD_Blocked, Blocked)                          \
+  X(DEVICE_FIELD_Alias, Alias)                              \
+  X(DEVICE_FIELD_Adapter, AdapterPath)                      \
+  X(DEVICE_FIELD_LegacyPairing, LegacyPairing)              \
+  X(DEVICE_FIELD_ServiceData, ServiceData)                  \
+  X(DEVICE_FIELD_ServicesResolved, ServicesResolved)        \
+  X(DEVICE_FIELD_Icon, Icon)                                \
+  X(DEVICE_FIELD_ManufacturerData, ManufacturerData)        \
+  X(DEVICE_FIELD_RSSI, RSSI)                                \
+  X(DEVICE_FIELD_TxPower, TxPower)
+
+namespace
+{
+/**
+ * @brief Compare two property snapshots field by field
+ * @param a Old snapshot
+ * @param b New snapshot
+ * @param mask DEVICE_FIELD_* bits to compare
+ * @return DEVICE_FIELD_* bits of the compared fields that differ
+ */
+uint32_t DiffFields(const DeviceProperties &a, const DeviceProperties &b, uint32_t mask = DEVICE_FIELD_ALL)
+{
+  uint32_t fields = 0;
+#define DIFF_FIELD(bit, member) fields |= (mask & (bit)) && a.member != b.member ? (bit) : 0;
+  DEVICE_FIELDS(DIFF_FIELD)
+#undef DIFF_FIELD
+  return fields;
+}
+} // namespace
 
 /**
  * @brief Construct a new Device object
@@ -21,24 +65,46 @@
  * sets up the device proxy for D-Bus communication.
  * 
  * @param connection Reference to D-Bus system bus connection
- * @param devicePath D-Bus object path for the device
+ * @param devicePath Interned D-Bus object path for the device
+ * @param executor Shared executor that runs the device commands
+ * @param properties Properties from InterfacesAdded; fetched from BlueZ on the strand when absent
+ * @param onChanged Called, without locks held, with the DEVICE_FIELD_* bits of cached properties, lifecycle state or last-seen time that changed
  */
-Device::Device(sdbus::IConnection &connection, std::string devicePath):
+Device::Device(sdbus::IConnection &connection, const InternedString &devicePath, CommandExecutor &executor,
+               std::optional<DeviceProperties> properties, std::function<void(Device &, uint32_t)> onChanged):
+m_connection(connection),
 m_running(true),
-m_deviceProxy(connection, *this, devicePath),
 m_devicePath(devicePath),
-m_properties() // Initialize m_properties
+m_properties(DeviceProperties{}),
+m_lifecycle(devicePath.Str()),
+m_strand(executor, devicePath.Str()),
+m_lastSeenMs(0),
+m_lastSeenReportedMs(0),
+m_onChanged(std::move(onChanged))
 {
   Log("%s%s", TAG,__func__);
+  TRACE_SCOPE("device", "DeviceConstruct");
+  Seen();
+  if (properties) {
+    PropertiesChanged(*properties);
+    return;
+  }
+  // Not announced through InterfacesAdded (e.g. an agent request); ask BlueZ
+  PostCommand("GetProperties", [this]() {
+    PropertiesChanged(Proxy().GetProperties());
+  });
 }
 
 Device::~Device()
 {
   Log("%s%s", TAG,__func__);
+  // Commands use the proxy; stop them before any member goes away
+  m_strand.Close();
   m_running = false;
   if(m_eventLoopThread.joinable()){
     m_eventLoopThread.join();
   }
+  Log("%s%s Lifecycle\n%s", TAG,__func__, m_lifecycle.Report().c_str());
 }
 
 void Device::StartLooping()
@@ -56,231 +122,310 @@ void Device::StartLooping()
 
 std::string Device::GetPath()
 {
-  return m_devicePath;
+  return m_devicePath.Str();
 }
 
-void Device::Connect()
+DeviceProxy &Device::Proxy()
 {
-  Log("%s%s", TAG,__func__);
-  if(m_deviceProxy.GetConnected()) {
-    Log("%s%s Device is already connected", TAG,__func__);
-    return;
+  std::lock_guard<std::mutex> lock(m_proxyMutex);
+  if (!m_deviceProxy) {
+    m_deviceProxy = std::make_unique<DeviceProxy>(m_connection, *this, m_devicePath.Str());
   }
-  m_deviceProxy.Connect();
+  return *m_deviceProxy;
 }
 
-void Device::Disconnect()
+uint32_t Device::SeedLifecycle(const DeviceProperties &properties)
 {
-  Log("%s%s", TAG,__func__);
-  if(!m_deviceProxy.GetConnected()) {
-    Log("%s%s Device is not connected", TAG,__func__);
-    return;
+  uint32_t fields = 0;
+  if (properties.Paired) {
+    fields |= HandleEvent(DeviceEvent::Paired);
+  }
+  if (properties.Connected) {
+    fields |= HandleEvent(DeviceEvent::Connected);
   }
-  m_deviceProxy.Disconnect();
+  if (properties.ServicesResolved) {
+    fields |= HandleEvent(DeviceEvent::ServicesResolved);
+  }
+  return fields;
 }
 
-void Device::ConnectProfile(std::string uuid)
+uint32_t Device::HandleEvent(DeviceEvent event)
 {
-  Log("%s%s UUID - %s", TAG,__func__, LOG_STRING(uuid));
-  m_properties.UUIDs = m_deviceProxy.GetUUIDs();
-  if(m_properties.UUIDs.size() == 0) {
-    Log("%s%s Error: UUIDs is empty", TAG,__func__);
-  }
-  PrintUUID();
-  try
-  {
-    m_deviceProxy.ConnectProfile(uuid);
-  }
-  catch(const sdbus::Error& e)
-  {
-    Log("%s%s Error: Couldn't connect UUID - %s %s", TAG,__func__, LOG_STRING(uuid), e.what());
-  }
-  
-  
+  return m_lifecycle.Handle(event) ? DEVICE_FIELD_State : 0;
 }
 
-void Device::DisconnectProfile(std::string uuid)
+void Device::PostCommand(const std::string &key, std::function<void()> command)
 {
-  Log("%s%s UUID - %s", TAG,__func__, LOG_STRING(uuid));
-  m_deviceProxy.DisconnectProfile(uuid);
+  // Time the operation, not its arguments, so the series stay few
+  LatencyHistogram &latency = MetricsRegistry::Instance().GetHistogram(
+      "bluezeg_device_command_duration_seconds", "Time to run a device command, D-Bus round trips included",
+      MetricsRegistry::Label("command", key.substr(0, key.find(':'))));
+  // The flow links the caller's thread to the executor worker that runs the command
+  uint64_t flowId = Trace::NewFlowId();
+  Trace::FlowStart("device", key, flowId);
+  m_strand.Post(key, [this, key, flowId, &latency, command = std::move(command)]() {
+    TRACE_SCOPE_FLOW("device", key, flowId);
+    auto start = std::chrono::steady_clock::now();
+    try
+    {
+      command();
+    }
+    catch(const sdbus::Error& e)
+    {
+      Log("%sPostCommand %s Error - %s %s", TAG, LOG_STRING(key), e.getName().c_str(), e.what());
+    }
+    latency.Record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+  });
 }
 
-void Device::Pair()
+void Device::WaitIdle()
 {
-  Log("%s%s", TAG,__func__);
-  if (m_deviceProxy.GetPaired()) {
-    Log("%s%s Device is already paired", TAG,__func__);
-    return;
-  }
-  m_deviceProxy.Pair();
+  m_strand.WaitIdle();
 }
 
-void Device::CancelPairing()
+void Device::Connect()
 {
   Log("%s%s", TAG,__func__);
-  if(!m_deviceProxy.GetPaired()) {
-    Log("%s%s Device is not paired", TAG,__func__);
-    return;
-  }
-  m_deviceProxy.CancelPairing();
+  PostCommand(__func__, [this]() {
+    if(Proxy().GetConnected()) {
+      Log("%sConnect Device is already connected", TAG);
+      return;
+    }
+    Changed(HandleEvent(DeviceEvent::ConnectStarted));
+    try
+    {
+      Proxy().Connect();
+    }
+    catch(const sdbus::Error& e)
+    {
+      Changed(HandleEvent(DeviceEvent::ConnectFailed));
+      throw;
+    }
+  });
 }
 
-void Device::PropertiesChanged(DeviceProperties properties)
+void Device::Disconnect()
 {
-  m_properties = properties;
+  Log("%s%s", TAG,__func__);
+  PostCommand(__func__, [this]() {
+    if(!Proxy().GetConnected()) {
+      Log("%sDisconnect Device is not connected", TAG);
+      return;
+    }
+    Proxy().Disconnect();
+  });
 }
 
-DeviceProperties Device::GetProperties()
+void Device::ConnectProfile(std::string uuid)
 {
-  std::lock_guard<std::mutex> lock(m_deviceMutex);
-  DeviceProperties properties = m_deviceProxy.GetProperties();
-  return properties;
+  Log("%s%s UUID - %s", TAG,__func__, LOG_STRING(uuid));
+  PostCommand(std::string(__func__) + ":" + uuid, [this, uuid]() {
+    DeviceChangeSet changes{};
+    changes.fields = DEVICE_FIELD_UUIDs;
+    changes.values.UUIDs = UuidSet(Proxy().GetUUIDs());
+    ApplyChanges(changes);
+    if(changes.values.UUIDs.empty()) {
+      Log("%sConnectProfile Error: UUIDs is empty", TAG);
+    }
+    PrintUUID();
+    Changed(HandleEvent(DeviceEvent::ConnectStarted));
+    try
+    {
+      Proxy().ConnectProfile(uuid);
+      Changed(HandleEvent(DeviceEvent::ProfileConnected));
+    }
+    catch(const sdbus::Error& e)
+    {
+      Changed(HandleEvent(DeviceEvent::ConnectFailed));
+      Log("%sConnectProfile Error: Couldn't connect UUID - %s %s", TAG, LOG_STRING(uuid), e.what());
+    }
+  });
 }
 
-void Device::AddressChanged(std::string value)
+void Device::DisconnectProfile(std::string uuid)
 {
-  if (m_properties.Address != value) {
-    m_properties.Address = value;
-    Log("%s%s Address- %s ", TAG,__func__, LOG_STRING(value));
-  }
+  Log("%s%s UUID - %s", TAG,__func__, LOG_STRING(uuid));
+  PostCommand(std::string(__func__) + ":" + uuid, [this, uuid]() {
+    Proxy().DisconnectProfile(uuid);
+  });
 }
 
-void Device::AddressTypeChanged(std::string value)
+void Device::Pair()
 {
-  if (m_properties.AddressType != value) {
-    m_properties.AddressType = value;
-    Log("%s%s AddressType: %s", TAG,__func__, LOG_STRING(value));
-  }
+  Log("%s%s", TAG,__func__);
+  PostCommand(__func__, [this]() {
+    if (Proxy().GetPaired()) {
+      Log("%sPair Device is already paired", TAG);
+      return;
+    }
+    static Counter &paired = MetricsRegistry::Instance().GetCounter(
+        "bluezeg_pairing_total", "Pairing attempts by outcome", MetricsRegistry::Label("result", "success"));
+    static Counter &failed = MetricsRegistry::Instance().GetCounter(
+        "bluezeg_pairing_total", "Pairing attempts by outcome", MetricsRegistry::Label("result", "failed"));
+    Changed(HandleEvent(DeviceEvent::PairStarted));
+    try
+    {
+      Proxy().Pair();
+      paired.Add();
+    }
+    catch(const sdbus::Error& e)
+    {
+      failed.Add();
+      Changed(HandleEvent(DeviceEvent::PairFailed));
+      throw;
+    }
+  });
 }
 
-void Device::NameChanged(std::string value)
+void Device::CancelPairing()
 {
-  if (m_properties.Name != value) {
-    m_properties.Name = value;
-    Log("%s%s Name: %s", TAG,__func__, LOG_STRING(value));
-  }
+  Log("%s%s", TAG,__func__);
+  PostCommand(__func__, [this]() {
+    if(!Proxy().GetPaired()) {
+      Log("%sCancelPairing Device is not paired", TAG);
+      return;
+    }
+    Proxy().CancelPairing();
+  });
 }
 
-void Device::IconChanged(std::string value)
+void Device::PropertiesChanged(DeviceProperties properties)
 {
-  if (m_properties.Icon != value) {
-    m_properties.Icon = value;
-    Log("%s%s Icon: %s", TAG,__func__, LOG_STRING(value));
+  uint32_t fields;
+  {
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    fields = DiffFields(*m_properties.Load(), properties);
+    if (fields) {
+      m_properties.Publish(properties);
+    }
+    m_proximity.SetTxPower(properties.TxPower);
+    m_proximity.Update(properties.RSSI, m_lastSeenMs);
   }
+  fields |= SeedLifecycle(properties);
+  Changed(fields);
 }
 
-void Device::ClassChanged(uint32_t value)
+DeviceProperties Device::GetProperties()
 {
-  if (m_properties.Class != value) {
-    m_properties.Class = value;
-    Log("%s%s Class: %u", TAG,__func__, value);
-  }
+  return *m_properties.Load();
 }
 
-void Device::UUIDsChanged(std::vector<std::string> value)
+std::shared_ptr<const DeviceProperties> Device::GetPropertiesSnapshot()
 {
-  if (m_properties.UUIDs != value) {
-    m_properties.UUIDs = value;
-    std::stringstream ss;
-    for (const auto& uuid : value) {
-      ss << uuid << " ";
-    }
-    Log("%s%s UUIDs: %s", TAG, __func__, ss.str().c_str());
-  }
+  return m_properties.Load();
 }
 
-void Device::PairedChanged(bool value)
+uint64_t Device::GetPropertiesVersion()
 {
-  if (m_properties.Paired != value) {
-    m_properties.Paired = value;
-    Log("%s%s Paired - %d", TAG,__func__, value);
-  }
+  return m_properties.Version();
 }
 
-void Device::ConnectedChanged(bool value)
+std::string Device::GetLifecycleReport()
 {
-  if (m_properties.Connected != value) {
-    m_properties.Connected = value;
-    Log("%s%s Connected - %d", TAG,__func__, value);
-  }
+  return m_lifecycle.Report();
 }
 
-void Device::TrustedChanged(bool value)
+DeviceProximity Device::GetProximity()
 {
-  if (m_properties.Trusted != value) {
-    m_properties.Trusted = value;
-    Log("%s%s Trusted - %d", TAG,__func__, value);
-  }
+  std::lock_guard<std::mutex> lock(m_deviceMutex);
+  return m_proximity.Get();
 }
 
-void Device::BlockedChanged(bool value)
+DeviceIndexKey Device::IndexKey()
 {
-  if (m_properties.Blocked != value) {
-    m_properties.Blocked = value;
-    Log("%s%s Blocked - %d", TAG,__func__, value);
-  }
+  std::shared_ptr<const DeviceProperties> properties = m_properties.Load();
+  DeviceIndexKey key;
+  key.paired = properties->Paired;
+  key.connected = properties->Connected;
+  key.majorClass = (properties->Class >> 8) & 0x1F;
+  // Adapter is absent until the properties arrive; the device path names it too
+  const std::string &adapterPath = properties->AdapterPath.empty() ? m_devicePath.Str() : properties->AdapterPath;
+  size_t pos = adapterPath.find("/hci");
+  key.adapter = pos == std::string::npos ? 0 : static_cast<uint8_t>(strtoul(adapterPath.c_str() + pos + 4, nullptr, 10));
+  key.uuids = properties->UUIDs;
+  return key;
 }
 
-void Device::AliasChanged(std::string value)
+void Device::Changed(uint32_t fields)
 {
-  if (m_properties.Alias != value) {
-    m_properties.Alias = value;
-    Log("%s%s Alias %s", TAG,__func__, LOG_STRING(value));
+  if (fields && m_onChanged) {
+    m_onChanged(*this, fields);
   }
 }
 
-void Device::AdapterChanged(std::string value)
+void Device::ApplyChanges(const DeviceChangeSet &changes)
 {
-  if (m_properties.AdapterPath != value) {
-    m_properties.AdapterPath = value;
-    Log("%s%s Adapter %s", TAG,__func__, LOG_STRING(value));
+  uint32_t changed;
+  {
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    std::shared_ptr<const DeviceProperties> current = m_properties.Load();
+    changed = DiffFields(*current, changes.values, changes.fields);
+    // Copy and publish only when a value differs; repeated values leave the snapshot alone
+    if (changed) {
+      DeviceProperties next = *current;
+#define APPLY_FIELD(bit, member) if (changed & (bit)) { next.member = changes.values.member; }
+      DEVICE_FIELDS(APPLY_FIELD)
+#undef APPLY_FIELD
+      m_properties.Publish(std::move(next));
+    }
+    if (changed & DEVICE_FIELD_TxPower) {
+      m_proximity.SetTxPower(changes.values.TxPower);
+    }
+    // Every reading feeds the filter, repeated values included
+    if (changes.fields & DEVICE_FIELD_RSSI) {
+      // DispatchChanged() calls Seen() first, so m_lastSeenMs is the time of this reading
+      m_proximity.Update(changes.values.RSSI, m_lastSeenMs);
+    }
+  }
+  uint32_t state = 0;
+  if (changes.fields & DEVICE_FIELD_Paired) {
+    state |= HandleEvent(changes.values.Paired ? DeviceEvent::Paired : DeviceEvent::Unpaired);
+  }
+  if (changes.fields & DEVICE_FIELD_Connected) {
+    state |= HandleEvent(changes.values.Connected ? DeviceEvent::Connected : DeviceEvent::Disconnected);
+  }
+  if ((changes.fields & DEVICE_FIELD_ServicesResolved) && changes.values.ServicesResolved) {
+    state |= HandleEvent(DeviceEvent::ServicesResolved);
+  }
+  // RSSI alone changes with every advertisement; keep it out of the log
+  if (changed & ~DEVICE_FIELD_RSSI) {
+    Log("%s%s %s Fields - 0x%05x", TAG, __func__, m_devicePath.c_str(), changed);
   }
+  Changed(changed | state);
 }
 
-void Device::LegacyPairingChanged(bool value)
+void Device::Seen()
 {
-  if (m_properties.LegacyPairing != value) {
-    m_properties.LegacyPairing = value;
-    Log("%s%s Legacy Pairing - %d", TAG,__func__, value);
+  uint64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  m_lastSeenMs = nowMs;
+  // Eviction works in seconds; reporting every advertisement would only add registry traffic
+  if (nowMs - m_lastSeenReportedMs >= LAST_SEEN_REPORT_MS) {
+    m_lastSeenReportedMs = nowMs;
+    Changed(DEVICE_FIELD_LastSeen);
   }
 }
 
-void Device::ManufacturerDataChanged(std::map<uint16_t, std::map<int, std::string>> value)
+uint64_t Device::LastSeenMs() const
 {
-  if (m_properties.ManufacturerData != value) {
-    m_properties.ManufacturerData = value;
-    std::stringstream ss;
-    for (const auto& [key, val] : value) {
-      ss << key << ": ";
-      for (const auto& [subKey, subVal] : val) {
-        ss << subKey << "=" << subVal << " ";
-      }
-    }
-    Log("%s%s ManufacturerData: %s", TAG, __func__, ss.str().c_str());
-  }
+  return m_lastSeenMs;
 }
 
-void Device::ServiceDataChanged(std::map<std::string, std::map<int, std::string>> value)
+DeviceState Device::State()
 {
-  if (m_properties.ServiceData != value) {
-    m_properties.ServiceData = value;
-    std::stringstream ss;
-    for (const auto& [key, val] : value) {
-      ss << key << ": ";
-      for (const auto& [subKey, subVal] : val) {
-        ss << subKey << "=" << subVal << " ";
-      }
-    }
-    Log("%s%s ServiceData: %s", TAG, __func__, ss.str().c_str());
-  }
+  return m_lifecycle.State();
 }
 
-void Device::ServicesResolvedChanged(bool value)
+bool Device::IsEvictable()
 {
-  if (m_properties.ServicesResolved != value) {
-    m_properties.ServicesResolved = value;
-    Log("%s%s ServicesResolved - %d", TAG,__func__, value);
+  DeviceState state = m_lifecycle.State();
+  if (state != DeviceState::Discovered && state != DeviceState::Disconnected) {
+    return false;
+  }
+  std::shared_ptr<const DeviceProperties> properties = m_properties.Load();
+  if (properties->Paired || properties->Connected) {
+    return false;
   }
+  return m_strand.Idle();
 }
 
 void Device::RunEventLoop()
@@ -295,7 +440,7 @@ void Device::PrintUUID()
 {
   Log("%s%s", TAG,__func__);
   int i = 1;
-  for (auto uuid : m_properties.UUIDs) {
-    Log("%s%s %d UUID - %s", TAG,__func__, i++, LOG_STRING(uuid));
+  for (auto uuid : GetPropertiesSnapshot()->UUIDs) {
+    Log("%s%s %d UUID - %s", TAG,__func__, i++, uuid.ToString().c_str());
   }
 }
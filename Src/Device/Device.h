@@ -9,8 +9,16 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <functional>
+#include <memory>
+#include <optional>
 
 #include "IDevice.h"
+#include "CommandExecutor.h"
+#include "DeviceLifecycle.h"
+#include "ProximityFilter.h"
+#include "StringInterner.h"
+#include "VersionedSnapshot.h"
 
 #include "DeviceProxy.h"
 
@@ -22,6 +30,17 @@
  * including connection management, pairing, property monitoring, and profile
  * operations. It runs in its own event loop thread to handle asynchronous
  * D-Bus property change notifications from BlueZ.
+ *
+ * Device operations (connect, pair, profile connections) are queued on a
+ * per-device CommandStrand and return immediately. They run in order, one
+ * at a time, on the shared CommandExecutor, so callers on different threads
+ * can no longer overlap on the same device, while separate devices still
+ * proceed in parallel.
+ *
+ * Properties are cached: they start from the InterfacesAdded payload and
+ * are kept current by the PropertiesChanged signals DeviceManager routes
+ * here, so reading them makes no D-Bus calls. The DeviceProxy is created
+ * on the first operation that needs it.
  */
 class Device : public IDevice
 {
@@ -29,9 +48,13 @@ public:
   /**
    * @brief Construct a new Device object
    * @param connection Reference to D-Bus system bus connection
-   * @param devicePath D-Bus object path for the device
+   * @param devicePath Interned D-Bus object path for the device
+   * @param executor Shared executor that runs the device commands
+   * @param properties Properties from InterfacesAdded; fetched from BlueZ on the strand when absent
+   * @param onChanged Called, without locks held, with the DEVICE_FIELD_* bits of cached properties, lifecycle state or last-seen time that changed
    */
-  Device(sdbus::IConnection &connection, std::string devicePath);
+  Device(sdbus::IConnection &connection, const InternedString &devicePath, CommandExecutor &executor,
+         std::optional<DeviceProperties> properties, std::function<void(Device &, uint32_t)> onChanged);
   
   /**
    * @brief Destroy the Device object and cleanup resources
@@ -51,45 +74,50 @@ public:
    * @return String containing the device's D-Bus path
    */
   std::string GetPath() override;
+
+  /**
+   * @brief Get the interned D-Bus object path, without copying it
+   * @return Path handle
+   */
+  const InternedString &GetPathHandle() const { return m_devicePath; }
   
   /**
-   * @brief Initiate a connection to this device
-   * @throws sdbus::Error if connection fails
+   * @brief Initiate a connection to this device (queued on the device strand)
    */
   void Connect();
   
   /**
-   * @brief Disconnect from this device
-   * @throws sdbus::Error if disconnection fails
+   * @brief Disconnect from this device (queued on the device strand)
    */
   void Disconnect();
   
   /**
-   * @brief Connect to a specific profile on this device
+   * @brief Connect to a specific profile on this device (queued on the device strand)
    * @param uuid UUID of the profile to connect to (e.g., SPP UUID)
-   * @throws sdbus::Error if profile connection fails
    */
   void ConnectProfile(std::string uuid);
   
   /**
-   * @brief Disconnect from a specific profile on this device
+   * @brief Disconnect from a specific profile on this device (queued on the device strand)
    * @param uuid UUID of the profile to disconnect from
-   * @throws sdbus::Error if profile disconnection fails
    */
   void DisconnectProfile(std::string uuid);
   
   /**
-   * @brief Initiate pairing with this device
-   * @throws sdbus::Error if pairing fails
+   * @brief Initiate pairing with this device (queued on the device strand)
    */
   void Pair();
   
   /**
-   * @brief Cancel an ongoing pairing operation
-   * @throws sdbus::Error if cancellation fails
+   * @brief Cancel an ongoing pairing operation (queued on the device strand)
    */
   void CancelPairing();
 
+  /**
+   * @brief Block until every queued device command has run
+   */
+  void WaitIdle();
+
   /**
    * @brief Handle bulk property changes from D-Bus
    * @param properties DeviceProperties structure containing updated values
@@ -98,27 +126,68 @@ public:
   
   /**
    * @brief Get current device properties
-   * @return DeviceProperties structure containing all current property values
+   * @return Copy of the cached properties
    */
   DeviceProperties GetProperties() override ;
+
+  /**
+   * @brief Get the cached properties without copying or blocking
+   * @return Immutable snapshot; later updates publish a new one
+   */
+  std::shared_ptr<const DeviceProperties> GetPropertiesSnapshot() override;
+
+  /**
+   * @brief Get the version of the cached properties
+   * @return Count of updates that changed a property
+   */
+  uint64_t GetPropertiesVersion() override;
+
+  /**
+   * @brief Get the lifecycle state and transition timings of this device
+   * @return Multi-line report
+   */
+  std::string GetLifecycleReport() override;
+
+  /**
+   * @brief Get the smoothed signal strength and estimated distance
+   * @return Proximity estimate; samples is 0 if no RSSI was reported
+   */
+  DeviceProximity GetProximity() override;
+
+  /**
+   * @brief Get the properties the registry indexes the device by
+   * @return Current index key
+   */
+  DeviceIndexKey IndexKey();
   
-  // Property change callback methods
-  void AddressChanged(std::string value) override;         ///< Handle device address changes
-  void AddressTypeChanged(std::string value) override;     ///< Handle address type changes
-  void NameChanged(std::string value) override;            ///< Handle device name changes
-  void IconChanged(std::string value) override;            ///< Handle device icon changes
-  void ClassChanged(uint32_t value) override;              ///< Handle device class changes
-  void UUIDsChanged(std::vector<std::string> value) override; ///< Handle UUID list changes
-  void PairedChanged(bool value) override;                 ///< Handle pairing status changes
-  void ConnectedChanged(bool value) override;              ///< Handle connection status changes
-  void TrustedChanged(bool value) override;                ///< Handle trusted status changes
-  void BlockedChanged(bool value) override;                ///< Handle blocked status changes
-  void AliasChanged(std::string value) override;           ///< Handle device alias changes
-  void AdapterChanged(std::string value) override;         ///< Handle adapter changes
-  void LegacyPairingChanged(bool value) override;          ///< Handle legacy pairing changes
-  void ManufacturerDataChanged(std::map<uint16_t, std::map<int, std::string>> value) override; ///< Handle manufacturer data changes
-  void ServiceDataChanged(std::map<std::string, std::map<int, std::string>> value) override;   ///< Handle service data changes
-  void ServicesResolvedChanged(bool value) override;       ///< Handle services resolved status changes
+  /**
+   * @brief Apply one PropertiesChanged signal to the cache under a single lock
+   * @param changes Fields present in the signal and their new values
+   */
+  void ApplyChanges(const DeviceChangeSet &changes) override;
+
+  /**
+   * @brief Record that BlueZ reported activity for this device
+   */
+  void Seen() override;
+
+  /**
+   * @brief Get the time BlueZ last reported activity for this device
+   * @return Milliseconds on the steady clock
+   */
+  uint64_t LastSeenMs() const;
+
+  /**
+   * @brief Get the lifecycle state
+   * @return Current state
+   */
+  DeviceState State();
+
+  /**
+   * @brief Check whether the device may be dropped from the registry
+   * @return True if the device is neither paired, connected nor running a command
+   */
+  bool IsEvictable();
 
 private:
   /**
@@ -135,13 +204,54 @@ private:
    * Helper function to display device capabilities and supported services.
    */
   void PrintUUID();
+
+  /**
+   * @brief Queue a device command on the device strand
+   * @param key Operation and arguments; an identical pending command is not queued twice
+   * @param command Command to run; sdbus::Error thrown by it is logged
+   */
+  void PostCommand(const std::string &key, std::function<void()> command);
+
+  /**
+   * @brief Get the D-Bus proxy, creating it on first use
+   * @return Device proxy
+   */
+  DeviceProxy &Proxy();
+
+  /**
+   * @brief Move the lifecycle to the state described by a property snapshot
+   * @param properties Property snapshot
+   * @return DEVICE_FIELD_State if the state changed, 0 otherwise
+   */
+  uint32_t SeedLifecycle(const DeviceProperties &properties);
+
+  /**
+   * @brief Feed an event to the lifecycle
+   * @param event Event
+   * @return DEVICE_FIELD_State if the state changed, 0 otherwise
+   */
+  uint32_t HandleEvent(DeviceEvent event);
+
+  /**
+   * @brief Report changes to the registry; call without m_deviceMutex held
+   * @param fields DEVICE_FIELD_* bits, DEVICE_FIELD_State and DEVICE_FIELD_LastSeen included; nothing is reported for 0
+   */
+  void Changed(uint32_t fields);
   
 private:
-    DeviceProxy m_deviceProxy;         ///< Proxy for D-Bus communication
-    DeviceProperties m_properties;     ///< Current device properties
-    std::string m_devicePath;          ///< D-Bus object path
-    std::mutex m_deviceMutex;          ///< Mutex for thread-safe property access
+    sdbus::IConnection &m_connection;  ///< D-Bus connection used to create the proxy
+    std::unique_ptr<DeviceProxy> m_deviceProxy; ///< Proxy for D-Bus communication, created on first use
+    std::mutex m_proxyMutex;           ///< Protects creation of m_deviceProxy
+    VersionedSnapshot<DeviceProperties> m_properties; ///< Current device properties, read without locking
+    InternedString m_devicePath;       ///< D-Bus object path
+    std::mutex m_deviceMutex;          ///< Serialises writers of m_properties; protects m_proximity
+    ProximityFilter m_proximity;       ///< Smoothed RSSI and distance estimate
     std::atomic<bool> m_running;       ///< Flag to control event loop execution
     std::thread m_eventLoopThread;     ///< Thread for running the event loop
-};;
+    DeviceLifecycle m_lifecycle;       ///< Lifecycle state machine and timings
+    CommandStrand m_strand;            ///< Ordered queue of device commands
+    std::atomic<uint64_t> m_lastSeenMs; ///< Last BlueZ activity on the steady clock
+    std::atomic<uint64_t> m_lastSeenReportedMs; ///< m_lastSeenMs as last reported to the registry
+    std::function<void(Device &, uint32_t)> m_onChanged; ///< Registry hook for property changes
+};
 
@@ -0,0 +1,249 @@
+/**
+ * @file DeviceLifecycle.cpp
+ * @brief Implementation of the device lifecycle state machine
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+#include "DeviceLifecycle.h"
+
+#include "Logger.h"
+
+#define TAG "DeviceLifecycle::" ///< Tag for logging messages
+
+namespace
+{
+std::mutex g_aggregateMutex;           ///< Protects g_aggregateStats
+DeviceLifecycleStats g_aggregateStats; ///< Histograms of all devices
+
+void AppendLine(std::string &out, const char *label, const Histogram &histogram)
+{
+  char line[256];
+  snprintf(line, sizeof(line), "%-40s n=%-6" PRIu64 " mean=%" PRIu64 "ms p50=%" PRIu64 "ms p90=%" PRIu64 "ms p99=%" PRIu64 "ms max=%" PRIu64 "ms\n",
+           label, histogram.Count(), histogram.MeanUs() / 1000, histogram.PercentileUs(50) / 1000,
+           histogram.PercentileUs(90) / 1000, histogram.PercentileUs(99) / 1000, histogram.MaxUs() / 1000);
+  out += line;
+}
+} // namespace
+
+DeviceLifecycle::DeviceLifecycle(std::string name) : m_name(std::move(name)),
+                                                     m_state(DeviceState::Discovered),
+                                                     m_resumeState(DeviceState::Discovered),
+                                                     m_enteredUs(NowUs()),
+                                                     m_connectingUs(0)
+{
+}
+
+uint64_t DeviceLifecycle::NowUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char *DeviceLifecycle::StateName(DeviceState state)
+{
+  switch (state)
+  {
+  case DeviceState::Discovered:
+    return "Discovered";
+  case DeviceState::Pairing:
+    return "Pairing";
+  case DeviceState::Paired:
+    return "Paired";
+  case DeviceState::Connecting:
+    return "Connecting";
+  case DeviceState::Connected:
+    return "Connected";
+  case DeviceState::ServicesResolved:
+    return "ServicesResolved";
+  case DeviceState::ProfileConnected:
+    return "ProfileConnected";
+  case DeviceState::Disconnected:
+    return "Disconnected";
+  }
+  return "Unknown";
+}
+
+DeviceState DeviceLifecycle::Next(DeviceState state, DeviceEvent event, DeviceState resume)
+{
+  switch (event)
+  {
+  case DeviceEvent::PairStarted:
+    if (state == DeviceState::Discovered || state == DeviceState::Disconnected)
+    {
+      return DeviceState::Pairing;
+    }
+    break;
+  case DeviceEvent::PairFailed:
+    if (state == DeviceState::Pairing)
+    {
+      return resume;
+    }
+    break;
+  case DeviceEvent::Paired:
+    if (state == DeviceState::Discovered || state == DeviceState::Pairing || state == DeviceState::Disconnected)
+    {
+      return DeviceState::Paired;
+    }
+    break;
+  case DeviceEvent::Unpaired:
+    if (state == DeviceState::Paired)
+    {
+      return DeviceState::Discovered;
+    }
+    break;
+  case DeviceEvent::ConnectStarted:
+    if (state == DeviceState::Discovered || state == DeviceState::Paired || state == DeviceState::Disconnected)
+    {
+      return DeviceState::Connecting;
+    }
+    break;
+  case DeviceEvent::ConnectFailed:
+    if (state == DeviceState::Connecting)
+    {
+      return resume;
+    }
+    break;
+  case DeviceEvent::Connected:
+    if (state == DeviceState::Discovered || state == DeviceState::Pairing || state == DeviceState::Paired ||
+        state == DeviceState::Connecting || state == DeviceState::Disconnected)
+    {
+      return DeviceState::Connected;
+    }
+    break;
+  case DeviceEvent::ServicesResolved:
+    if (state == DeviceState::Connecting || state == DeviceState::Connected)
+    {
+      return DeviceState::ServicesResolved;
+    }
+    break;
+  case DeviceEvent::ProfileConnected:
+    if (state == DeviceState::Connecting || state == DeviceState::Connected || state == DeviceState::ServicesResolved)
+    {
+      return DeviceState::ProfileConnected;
+    }
+    break;
+  case DeviceEvent::Disconnected:
+    if (state == DeviceState::Pairing || state == DeviceState::Connecting || state == DeviceState::Connected ||
+        state == DeviceState::ServicesResolved || state == DeviceState::ProfileConnected)
+    {
+      return DeviceState::Disconnected;
+    }
+    break;
+  }
+  return state;
+}
+
+void DeviceLifecycle::Record(DeviceLifecycleStats &stats, DeviceState from, DeviceState to, uint64_t inStateUs, uint64_t setupUs)
+{
+  stats.timeInState[static_cast<int>(from)].Record(inStateUs);
+  stats.transitions[(static_cast<uint16_t>(from) << 8) | static_cast<uint16_t>(to)].Record(inStateUs);
+  if (setupUs)
+  {
+    stats.setup.Record(setupUs);
+  }
+  ++stats.transitionCount;
+}
+
+bool DeviceLifecycle::Handle(DeviceEvent event)
+{
+  DeviceState from;
+  DeviceState to;
+  uint64_t inStateUs = 0;
+  uint64_t setupUs = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_lifecycleMutex);
+    from = m_state;
+    to = Next(m_state, event, m_resumeState);
+    if (to == from)
+    {
+      return false;
+    }
+    uint64_t now = NowUs();
+    inStateUs = now - m_enteredUs;
+    if (to == DeviceState::Pairing || to == DeviceState::Connecting)
+    {
+      m_resumeState = from;
+    }
+    if (to == DeviceState::Connecting)
+    {
+      m_connectingUs = now;
+    }
+    else if (to == DeviceState::ProfileConnected && m_connectingUs)
+    {
+      setupUs = now - m_connectingUs;
+      m_connectingUs = 0;
+    }
+    m_state = to;
+    m_enteredUs = now;
+    Record(m_stats, from, to, inStateUs, setupUs);
+  }
+  {
+    std::lock_guard<std::mutex> lock(g_aggregateMutex);
+    Record(g_aggregateStats, from, to, inStateUs, setupUs);
+  }
+  Log("%s%s %s %s -> %s after %" PRIu64 " ms", TAG, __func__, LOG_STRING(m_name), StateName(from), StateName(to), inStateUs / 1000);
+  return true;
+}
+
+DeviceState DeviceLifecycle::State()
+{
+  std::lock_guard<std::mutex> lock(m_lifecycleMutex);
+  return m_state;
+}
+
+DeviceLifecycleStats DeviceLifecycle::Stats()
+{
+  std::lock_guard<std::mutex> lock(m_lifecycleMutex);
+  return m_stats;
+}
+
+std::string DeviceLifecycle::Report()
+{
+  DeviceState state;
+  DeviceLifecycleStats stats;
+  {
+    std::lock_guard<std::mutex> lock(m_lifecycleMutex);
+    state = m_state;
+    stats = m_stats;
+  }
+  return m_name + " state " + StateName(state) + "\n" + Format(stats);
+}
+
+std::string DeviceLifecycle::AggregateReport()
+{
+  DeviceLifecycleStats stats;
+  {
+    std::lock_guard<std::mutex> lock(g_aggregateMutex);
+    stats = g_aggregateStats;
+  }
+  return "All devices\n" + Format(stats);
+}
+
+std::string DeviceLifecycle::Format(const DeviceLifecycleStats &stats)
+{
+  std::string out;
+  char label[64];
+  for (int i = 0; i < DEVICE_STATE_COUNT; ++i)
+  {
+    if (stats.timeInState[i].Count())
+    {
+      snprintf(label, sizeof(label), "  in %s", StateName(static_cast<DeviceState>(i)));
+      AppendLine(out, label, stats.timeInState[i]);
+    }
+  }
+  for (const auto &transition : stats.transitions)
+  {
+    snprintf(label, sizeof(label), "  %s -> %s", StateName(static_cast<DeviceState>(transition.first >> 8)),
+             StateName(static_cast<DeviceState>(transition.first & 0xFF)));
+    AppendLine(out, label, transition.second);
+  }
+  if (stats.setup.Count())
+  {
+    AppendLine(out, "  setup Connecting -> ProfileConnected", stats.setup);
+  }
+  return out;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file DeviceLifecycle.h
+ * @brief Device lifecycle state machine with transition timing
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "Histogram.h"
+
+#define DEVICE_STATE_COUNT 8 ///< Number of DeviceState values
+
+/**
+ * @enum DeviceState
+ * @brief Lifecycle states of a device
+ */
+enum class DeviceState : uint8_t
+{
+  Discovered,       ///< Known to BlueZ, not paired or connected
+  Pairing,          ///< Pair() in progress
+  Paired,           ///< Bonded, not connected
+  Connecting,       ///< Connect() or ConnectProfile() in progress
+  Connected,        ///< ACL link up
+  ServicesResolved, ///< Service discovery finished
+  ProfileConnected, ///< A profile connection (e.g. SPP) succeeded
+  Disconnected      ///< Link dropped after having been connected
+};
+
+/**
+ * @enum DeviceEvent
+ * @brief Inputs that drive the lifecycle state machine
+ */
+enum class DeviceEvent : uint8_t
+{
+  PairStarted,      ///< Pair() issued
+  PairFailed,       ///< Pair() returned an error
+  Paired,           ///< Paired property became true
+  Unpaired,         ///< Paired property became false
+  ConnectStarted,   ///< Connect() or ConnectProfile() issued
+  ConnectFailed,    ///< Connect() or ConnectProfile() returned an error
+  Connected,        ///< Connected property became true
+  Disconnected,     ///< Connected property became false
+  ServicesResolved, ///< ServicesResolved property became true
+  ProfileConnected  ///< ConnectProfile() succeeded
+};
+
+/**
+ * @struct DeviceLifecycleStats
+ * @brief Timing histograms of one device or of all devices
+ */
+typedef struct
+{
+  Histogram timeInState[DEVICE_STATE_COUNT];  ///< Time spent in each state before leaving it
+  std::map<uint16_t, Histogram> transitions;  ///< Time in the source state, keyed by (from << 8) | to
+  Histogram setup;                            ///< Connecting to ProfileConnected
+  uint64_t transitionCount = 0;               ///< Number of state changes
+} DeviceLifecycleStats;
+
+/**
+ * @class DeviceLifecycle
+ * @brief Explicit lifecycle state machine of one device
+ *
+ * Replaces reasoning over the separate Paired, Connected and
+ * ServicesResolved properties with a single state. Every transition is
+ * timestamped on the steady clock; the time spent in the state being left
+ * is recorded per state and per (from, to) edge, and the time from
+ * Connecting to ProfileConnected is recorded as the setup time. Each
+ * sample goes into the device's own histograms and into process-wide
+ * aggregate histograms, so the aggregate survives device removal. Events
+ * that do not apply in the current state are ignored. Thread-safe.
+ */
+class DeviceLifecycle
+{
+public:
+  /**
+   * @brief Construct a new Device Lifecycle object in the Discovered state
+   * @param name Name used in log messages
+   */
+  explicit DeviceLifecycle(std::string name);
+
+  /**
+   * @brief Feed an event to the state machine
+   * @param event Event
+   * @return True if the state changed
+   */
+  bool Handle(DeviceEvent event);
+
+  /**
+   * @brief Get the current state
+   * @return Current state
+   */
+  DeviceState State();
+
+  /**
+   * @brief Get the timing histograms of this device
+   * @return Copy of the histograms
+   */
+  DeviceLifecycleStats Stats();
+
+  /**
+   * @brief Format the timing histograms of this device
+   * @return Multi-line report
+   */
+  std::string Report();
+
+  /**
+   * @brief Format the timing histograms aggregated over all devices
+   * @return Multi-line report
+   */
+  static std::string AggregateReport();
+
+  /**
+   * @brief Get the name of a state
+   * @param state State
+   * @return State name
+   */
+  static const char *StateName(DeviceState state);
+
+private:
+  /**
+   * @brief Compute the state an event leads to
+   * @param state Current state
+   * @param event Event
+   * @param resume State to return to when a pairing or connection attempt fails
+   * @return Next state, equal to state if the event does not apply
+   */
+  static DeviceState Next(DeviceState state, DeviceEvent event, DeviceState resume);
+
+  /**
+   * @brief Record a transition into a set of histograms
+   * @param stats Histograms to update
+   * @param from State being left
+   * @param to State being entered
+   * @param inStateUs Time spent in the state being left
+   * @param setupUs Connection setup time, 0 if this transition does not finish a setup
+   */
+  static void Record(DeviceLifecycleStats &stats, DeviceState from, DeviceState to, uint64_t inStateUs, uint64_t setupUs);
+
+  /**
+   * @brief Format a set of histograms
+   * @param stats Histograms
+   * @return Multi-line report
+   */
+  static std::string Format(const DeviceLifecycleStats &stats);
+
+  /**
+   * @brief Get the current time for transition timestamps
+   * @return Microseconds on the steady clock
+   */
+  static uint64_t NowUs();
+
+private:
+  std::string m_name;            ///< Name used in log messages
+  std::mutex m_lifecycleMutex;   ///< Protects the members below
+  DeviceState m_state;           ///< Current state
+  DeviceState m_resumeState;     ///< State before the current pairing or connection attempt
+  uint64_t m_enteredUs;          ///< When the current state was entered
+  uint64_t m_connectingUs;       ///< When Connecting was last entered, 0 if not set up since
+  DeviceLifecycleStats m_stats;  ///< Timing histograms of this device
+};
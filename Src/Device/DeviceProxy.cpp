@@ -11,39 +11,23 @@
 #include <functional>
 
 #include "DeviceProxy.h"
+#include "DBusCallMetrics.h"
 
 #include "Logger.h"
+#include "DispatchWatchdog.h"
 #include "Utilities.h"
 
 
 #define TAG "DeviceProxy::"
+#define DEVICE_INTERFACE_NAME "org.bluez.Device1" ///< Interface label of the call metrics
 
 const std::string DEVICE_WELLKNOWN_NAME = "org.bluez";
 
-std::map<const std::string, const std::function<void(IDevice& callback, sdbus::Variant)>> dispatchDeviceCallbacks{
-  {DEVICE_PROPERTY_Address, [](IDevice& callback, sdbus::Variant value) { callback.AddressChanged(getFromSVariant<std::string>(value)); }},
-  {DEVICE_PROPERTY_AddressType, [](IDevice& callback, sdbus::Variant value) { callback.AddressTypeChanged(getFromSVariant<std::string>(value)); }},
-  {DEVICE_PROPERTY_Name, [](IDevice& callback, sdbus::Variant value) { callback.NameChanged(getFromSVariant<std::string>(value)); }},
-  {DEVICE_PROPERTY_UUIDs, [](IDevice& callback, sdbus::Variant value) { callback.UUIDsChanged(getFromSVariant<std::vector<std::string>>(value)); }},
-  {DEVICE_PROPERTY_Paired, [](IDevice& callback, sdbus::Variant value) { callback.PairedChanged(getFromSVariant<bool>(value)); }},
-  {DEVICE_PROPERTY_Connected, [](IDevice& callback, sdbus::Variant value) { callback.ConnectedChanged(getFromSVariant<bool>(value)); }},
-  {DEVICE_PROPERTY_Trusted, [](IDevice& callback, sdbus::Variant value) { callback.TrustedChanged(getFromSVariant<bool>(value)); }},
-  {DEVICE_PROPERTY_Blocked, [](IDevice& callback, sdbus::Variant value) { callback.BlockedChanged(getFromSVariant<bool>(value)); }},
-  {DEVICE_PROPERTY_Alias, [](IDevice& callback, sdbus::Variant value) { callback.AliasChanged(getFromSVariant<std::string>(value)); }},
-  {DEVICE_PROPERTY_Adapter, [](IDevice& callback, sdbus::Variant value) { callback.AdapterChanged(getFromSVariant<std::string>(value)); }},
-  {DEVICE_PROPERTY_LegacyPairing, [](IDevice& callback, sdbus::Variant value) { callback.LegacyPairingChanged(getFromSVariant<bool>(value)); }},
-  {DEVICE_PROPERTY_ServiceData, [](IDevice& callback, sdbus::Variant value) { }},
-  {DEVICE_PROPERTY_ServicesResolved, [](IDevice& callback, sdbus::Variant value) { callback.ServicesResolvedChanged(getFromSVariant<bool>(value)); }},
-  {DEVICE_PROPERTY_Icon, [](IDevice& callback, sdbus::Variant value) { callback.IconChanged(getFromSVariant<std::string>(value)); }},
-  {DEVICE_PROPERTY_Class, [](IDevice& callback, sdbus::Variant value) { callback.ClassChanged(getFromSVariant<uint32_t>(value)); }},
-  {DEVICE_PROPERTY_ManufacturerData, [](IDevice& callback, sdbus::Variant value) {  }}
-};
-
 std::map<const std::string, const std::function<void(DeviceProperties& properties, DeviceProxy &proxy)>> dispatchDeviceProperties{
   {DEVICE_PROPERTY_Address, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.Address = proxy.GetAddress(); }},
   {DEVICE_PROPERTY_AddressType, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.AddressType = proxy.GetAddressType(); }},
   {DEVICE_PROPERTY_Name, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.Name = proxy.GetName(); }},
-  {DEVICE_PROPERTY_UUIDs, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.UUIDs = proxy.GetUUIDs(); }},
+  {DEVICE_PROPERTY_UUIDs, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.UUIDs = UuidSet(proxy.GetUUIDs()); }},
   {DEVICE_PROPERTY_Paired, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.Paired = proxy.GetPaired(); }},
   {DEVICE_PROPERTY_Connected, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.Connected = proxy.GetConnected(); }},
   {DEVICE_PROPERTY_Trusted, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.Trusted = proxy.GetTrusted(); }},
@@ -55,7 +39,37 @@ std::map<const std::string, const std::function<void(DeviceProperties& propertie
   {DEVICE_PROPERTY_ServicesResolved, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.ServicesResolved = proxy.GetServicesResolved(); }},
   {DEVICE_PROPERTY_Icon, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.Icon = proxy.GetIcon(); }},
   {DEVICE_PROPERTY_Class, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.Class = proxy.GetClass(); }},
-  {DEVICE_PROPERTY_ManufacturerData, [](DeviceProperties& properties, DeviceProxy &proxy) {  }}
+  {DEVICE_PROPERTY_ManufacturerData, [](DeviceProperties& properties, DeviceProxy &proxy) {  }},
+  {DEVICE_PROPERTY_RSSI, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.RSSI = proxy.GetRSSI(); }},
+  {DEVICE_PROPERTY_TxPower, [](DeviceProperties& properties, DeviceProxy &proxy) { properties.TxPower = proxy.GetTxPower(); }}
+};
+
+/**
+ * @struct PropertyParser
+ * @brief Decoder of one Device1 property and the change bit it sets
+ */
+typedef struct {
+  uint32_t field;                                                                       ///< DEVICE_FIELD_* bit of the property
+  std::function<void(DeviceProperties& properties, const sdbus::Variant &value)> parse; ///< Stores the value in properties
+} PropertyParser;
+
+std::map<const std::string, const PropertyParser> parseDeviceProperties{
+  {DEVICE_PROPERTY_Address, {DEVICE_FIELD_Address, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.Address = value.get<std::string>(); }}},
+  {DEVICE_PROPERTY_AddressType, {DEVICE_FIELD_AddressType, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.AddressType = value.get<std::string>(); }}},
+  {DEVICE_PROPERTY_Name, {DEVICE_FIELD_Name, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.Name = value.get<std::string>(); }}},
+  {DEVICE_PROPERTY_UUIDs, {DEVICE_FIELD_UUIDs, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.UUIDs = UuidSet(Uuid128::FromStrings(value.get<std::vector<std::string>>())); }}},
+  {DEVICE_PROPERTY_Paired, {DEVICE_FIELD_Paired, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.Paired = value.get<bool>(); }}},
+  {DEVICE_PROPERTY_Connected, {DEVICE_FIELD_Connected, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.Connected = value.get<bool>(); }}},
+  {DEVICE_PROPERTY_Trusted, {DEVICE_FIELD_Trusted, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.Trusted = value.get<bool>(); }}},
+  {DEVICE_PROPERTY_Blocked, {DEVICE_FIELD_Blocked, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.Blocked = value.get<bool>(); }}},
+  {DEVICE_PROPERTY_Alias, {DEVICE_FIELD_Alias, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.Alias = value.get<std::string>(); }}},
+  {DEVICE_PROPERTY_Adapter, {DEVICE_FIELD_Adapter, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.AdapterPath = std::string(value.get<sdbus::ObjectPath>()); }}},
+  {DEVICE_PROPERTY_LegacyPairing, {DEVICE_FIELD_LegacyPairing, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.LegacyPairing = value.get<bool>(); }}},
+  {DEVICE_PROPERTY_ServicesResolved, {DEVICE_FIELD_ServicesResolved, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.ServicesResolved = value.get<bool>(); }}},
+  {DEVICE_PROPERTY_Icon, {DEVICE_FIELD_Icon, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.Icon = value.get<std::string>(); }}},
+  {DEVICE_PROPERTY_Class, {DEVICE_FIELD_Class, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.Class = value.get<uint32_t>(); }}},
+  {DEVICE_PROPERTY_RSSI, {DEVICE_FIELD_RSSI, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.RSSI = value.get<int16_t>(); }}},
+  {DEVICE_PROPERTY_TxPower, {DEVICE_FIELD_TxPower, [](DeviceProperties& properties, const sdbus::Variant &value) { properties.TxPower = value.get<int16_t>(); }}}
 };
 
 DeviceProxy::DeviceProxy(sdbus::IConnection &connection,IDevice &device, std::string devicePath):
@@ -65,16 +79,7 @@ m_connection(connection),
 m_device(device)
 {
   Log("%s%s", TAG,__func__);
-  try
-  {
-    DeviceProperties properites = GetProperties();
-    device.PropertiesChanged(properites);
-    registerProxy();
-  }
-  catch(const std::exception& e)
-  {
-    Log("%s%s Error - %s", TAG,__func__, e.what());
-  }
+  // No registerProxy(): PropertiesChanged arrives through DeviceManager's shared match
 }
 
 DeviceProxy::~DeviceProxy()
@@ -85,127 +90,137 @@ DeviceProxy::~DeviceProxy()
 
 void DeviceProxy::Connect()
 {
-  org::bluez::Device1_proxy::Connect();
+  DBUS_CALL(DEVICE_INTERFACE_NAME, "Connect", org::bluez::Device1_proxy::Connect());
 }
 
 void DeviceProxy::Disconnect()
 {
-  org::bluez::Device1_proxy::Disconnect();
+  DBUS_CALL(DEVICE_INTERFACE_NAME, "Disconnect", org::bluez::Device1_proxy::Disconnect());
 }
 
 void DeviceProxy::ConnectProfile(std::string uuid)
 {
-  org::bluez::Device1_proxy::ConnectProfile(uuid);
+  DBUS_CALL(DEVICE_INTERFACE_NAME, "ConnectProfile", org::bluez::Device1_proxy::ConnectProfile(uuid));
 }
 
 void DeviceProxy::DisconnectProfile(std::string uuid)
 {
-  org::bluez::Device1_proxy::DisconnectProfile(uuid);
+  DBUS_CALL(DEVICE_INTERFACE_NAME, "DisconnectProfile", org::bluez::Device1_proxy::DisconnectProfile(uuid));
 }
 
 void DeviceProxy::Pair()
 {
-  org::bluez::Device1_proxy::Pair();
+  DBUS_CALL(DEVICE_INTERFACE_NAME, "Pair", org::bluez::Device1_proxy::Pair());
 }
 
 void DeviceProxy::CancelPairing()
 {
-  org::bluez::Device1_proxy::CancelPairing();
+  DBUS_CALL(DEVICE_INTERFACE_NAME, "CancelPairing", org::bluez::Device1_proxy::CancelPairing());
 }
 
 std::string DeviceProxy::GetAddress()
 {
-  return Address();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:Address", Address());
 }
 
 std::string DeviceProxy::GetAddressType()
 {
-  return AddressType();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:AddressType", AddressType());
 }
 
 std::string DeviceProxy::GetName()
 {
-  return Name();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:Name", Name());
 }
 
 std::string DeviceProxy::GetIcon()
 {
-  return Icon();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:Icon", Icon());
 }
 
 uint32_t DeviceProxy::GetClass()
 {
-  return Class();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:Class", Class());
 }
 
-std::vector<std::string> DeviceProxy::GetUUIDs()
+std::vector<Uuid128> DeviceProxy::GetUUIDs()
 {
- return UUIDs(); 
+ return Uuid128::FromStrings(DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:UUIDs", UUIDs()));
 }
 
 bool DeviceProxy::GetPaired()
 {
-  return Paired();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:Paired", Paired());
 }
 
 bool DeviceProxy::GetConnected()
 {
-  return Connected();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:Connected", Connected());
 }
 
 bool DeviceProxy::GetTrusted()
 {
-  return Trusted();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:Trusted", Trusted());
 }
 
 bool DeviceProxy::GetBlocked()
 {
-  return Blocked();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:Blocked", Blocked());
 }
 
 std::string DeviceProxy::GetAlias()
 {
-  return Alias();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:Alias", Alias());
 }
 
 sdbus::ObjectPath DeviceProxy::GetAdapter()
 {
-  return Adapter();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:Adapter", Adapter());
 }
 
 bool DeviceProxy::GetLegacyPairing()
 {
-  return LegacyPairing();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:LegacyPairing", LegacyPairing());
 }
 
 std::map<std::string, sdbus::Variant> DeviceProxy::GetServiceData()
 {
-  return ServiceData();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:ServiceData", ServiceData());
 }
 
 bool DeviceProxy::GetServicesResolved()
 {
-  return ServicesResolved();
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:ServicesResolved", ServicesResolved());
+}
+
+int16_t DeviceProxy::GetRSSI()
+{
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:RSSI", RSSI());
+}
+
+int16_t DeviceProxy::GetTxPower()
+{
+  return DBUS_CALL(DEVICE_INTERFACE_NAME, "Get:TxPower", TxPower());
 }
 
 void DeviceProxy::SetTrusted(bool value)
 {
-  Trusted(value);
+  DBUS_CALL(DEVICE_INTERFACE_NAME, "Set:Trusted", Trusted(value));
 }
 
 void DeviceProxy::SetBlocked(bool value)
 {
-  Blocked(value);
+  DBUS_CALL(DEVICE_INTERFACE_NAME, "Set:Blocked", Blocked(value));
 }
 
 void DeviceProxy::SetAlias(const std::string &value)
 {
-  Alias(value);
+  DBUS_CALL(DEVICE_INTERFACE_NAME, "Set:Alias", Alias(value));
 }
 
 DeviceProperties DeviceProxy::GetProperties()
 {
-  DeviceProperties properties;
+  DeviceProperties properties{};
   for (const auto &prop : dispatchDeviceProperties) {
     try
     {
@@ -215,23 +230,52 @@ DeviceProperties DeviceProxy::GetProperties()
     {
       Log("%s%s %s Not Available in List", TAG,__func__, LOG_STRING(prop.first));
     }
+    catch(const sdbus::Error& e)
+    {
+      // RSSI and TxPower are absent unless BlueZ has a reading
+      Log("%s%s %s Not Available - %s", TAG,__func__, LOG_STRING(prop.first), e.what());
+    }
   }
   return properties;
 }
 
- void DeviceProxy::onPropertiesChanged( const sdbus::InterfaceName& interface_name,
-                            const  std::map<sdbus::PropertyName, sdbus::Variant>& changed_properties, 
-                            const std::vector<sdbus::PropertyName>& invalidated_properties )
+DeviceChangeSet DeviceProxy::ParseChanges(const std::map<sdbus::PropertyName, sdbus::Variant> &properties)
 {
-  for (const auto &prop : changed_properties) {
-    Log("%s%s Name - %s", TAG, __func__, LOG_STRING(prop.first));
+  DeviceChangeSet changes{};
+  for (const auto &prop : properties) {
+    auto it = parseDeviceProperties.find(prop.first);
+    if (it == parseDeviceProperties.end()) {
+      continue;
+    }
     try
     {
-      dispatchDeviceCallbacks.at(prop.first)(m_device, prop.second);
+      it->second.parse(changes.values, prop.second);
+      changes.fields |= it->second.field;
     }
-    catch(const std::out_of_range& e)
+    catch(const sdbus::Error& e)
     {
-      Log("%s%s %s Not Available in List", TAG,__func__, LOG_STRING(prop.first));
+      Log("%s%s %s Error - %s", TAG,__func__, LOG_STRING(prop.first), e.what());
     }
   }
+  return changes;
+}
+
+DeviceProperties DeviceProxy::ParseProperties(const std::map<sdbus::PropertyName, sdbus::Variant> &properties)
+{
+  return ParseChanges(properties).values;
+}
+
+void DeviceProxy::DispatchChanged(IDevice &device, const std::map<sdbus::PropertyName, sdbus::Variant> &changed_properties)
+{
+  device.Seen();
+  // One decoded change set per signal, applied to the cache in one step
+  device.ApplyChanges(ParseChanges(changed_properties));
+}
+
+ void DeviceProxy::onPropertiesChanged( const sdbus::InterfaceName& interface_name,
+                            const  std::map<sdbus::PropertyName, sdbus::Variant>& changed_properties, 
+                            const std::vector<sdbus::PropertyName>& invalidated_properties )
+{
+  WATCHDOG_HANDLER("DeviceProxy::onPropertiesChanged");
+  DispatchChanged(m_device, changed_properties);
 }
@@ -26,8 +26,13 @@
  * 
  * This class provides a C++ wrapper around the generated D-Bus proxy for
  * BlueZ Device1 interface. It handles property change notifications,
- * method calls, and property access for Bluetooth devices. The class
- * automatically forwards property changes to the registered IDevice callback.
+ * method calls, and property access for Bluetooth devices.
+ *
+ * The proxy does not register its own signal match: DeviceManager
+ * subscribes once to PropertiesChanged for every device under /org/bluez
+ * and forwards each signal with DispatchChanged(), so the bus carries one
+ * match rule however many devices are known. Constructing a proxy makes
+ * no D-Bus calls.
  */
 class DeviceProxy : sdbus::ProxyInterfaces<org::bluez::Device1_proxy, sdbus::Properties_proxy>
 {
@@ -90,7 +95,7 @@ public:
   std::string GetName();                                       ///< Get device name
   std::string GetIcon();                                       ///< Get device icon name
   uint32_t GetClass();                                         ///< Get device class
-  std::vector<std::string> GetUUIDs();                        ///< Get list of supported service UUIDs
+  std::vector<Uuid128> GetUUIDs();                            ///< Get list of supported service UUIDs, parsed
   bool GetPaired();                                            ///< Get pairing status
   bool GetConnected();                                         ///< Get connection status
   bool GetTrusted();                                           ///< Get trusted status
@@ -100,6 +105,8 @@ public:
   bool GetLegacyPairing();                                     ///< Get legacy pairing status
   std::map<std::string, sdbus::Variant> GetServiceData();     ///< Get service data
   bool GetServicesResolved();                                  ///< Get services resolved status
+  int16_t GetRSSI();                                           ///< Get received signal strength
+  int16_t GetTxPower();                                        ///< Get advertised transmit power
   
   // Property setter methods
   /**
@@ -129,6 +136,27 @@ public:
    * @throws sdbus::Error if property retrieval fails
    */
   DeviceProperties GetProperties();
+
+  /**
+   * @brief Build a DeviceProperties from an a{sv} property map
+   * @param properties Property map, e.g. from InterfacesAdded
+   * @return Properties; fields missing from the map are left zeroed
+   */
+  static DeviceProperties ParseProperties(const std::map<sdbus::PropertyName, sdbus::Variant> &properties);
+
+  /**
+   * @brief Decode an a{sv} property map into a change set
+   * @param properties Property map, e.g. from PropertiesChanged
+   * @return Values of the recognised properties and their DEVICE_FIELD_* bits
+   */
+  static DeviceChangeSet ParseChanges(const std::map<sdbus::PropertyName, sdbus::Variant> &properties);
+
+  /**
+   * @brief Forward a PropertiesChanged signal to a device as one change set
+   * @param device Device callbacks
+   * @param changed_properties Map of changed properties and their new values
+   */
+  static void DispatchChanged(IDevice &device, const std::map<sdbus::PropertyName, sdbus::Variant> &changed_properties);
   
   /**
    * @brief Handle D-Bus property change notifications
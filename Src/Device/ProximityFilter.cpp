@@ -0,0 +1,51 @@
+/**
+ * @file ProximityFilter.cpp
+ * @brief Implementation of RSSI smoothing and distance estimation
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <cmath>
+
+#include "ProximityFilter.h"
+
+void ProximityFilter::Update(int16_t rssi, uint64_t nowMs)
+{
+  if (rssi == DEVICE_RSSI_UNKNOWN)
+  {
+    return;
+  }
+  if (m_samples == 0 || nowMs - m_lastUpdateMs > PROXIMITY_STALE_MS)
+  {
+    m_smoothedRssi = rssi;
+    m_samples = 0;
+  }
+  else
+  {
+    m_smoothedRssi += PROXIMITY_ALPHA * (rssi - m_smoothedRssi);
+  }
+  m_lastRssi = rssi;
+  m_lastUpdateMs = nowMs;
+  ++m_samples;
+}
+
+void ProximityFilter::SetTxPower(int16_t txPower)
+{
+  m_txPower = txPower;
+}
+
+DeviceProximity ProximityFilter::Get() const
+{
+  DeviceProximity proximity = {m_lastRssi, m_smoothedRssi, -1.0, m_samples};
+  if (m_samples == 0)
+  {
+    return proximity;
+  }
+  double rssiAt1m = PROXIMITY_DEFAULT_1M_RSSI;
+  if (m_txPower != DEVICE_RSSI_UNKNOWN)
+  {
+    rssiAt1m = m_txPower - PROXIMITY_TXPOWER_1M_LOSS;
+  }
+  proximity.distanceM = std::pow(10.0, (rssiAt1m - m_smoothedRssi) / (10.0 * PROXIMITY_PATH_LOSS));
+  return proximity;
+}
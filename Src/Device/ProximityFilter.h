@@ -0,0 +1,60 @@
+/**
+ * @file ProximityFilter.h
+ * @brief RSSI smoothing and distance estimation for one device
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "DeviceHelper.h"
+
+#define PROXIMITY_ALPHA 0.25          ///< Weight of a new RSSI reading in the moving average
+#define PROXIMITY_STALE_MS 30000      ///< Gap after which old readings are discarded
+#define PROXIMITY_PATH_LOSS 2.0       ///< Path-loss exponent (2 is free space)
+#define PROXIMITY_DEFAULT_1M_RSSI -59 ///< Expected RSSI at 1 m when TxPower is not advertised
+#define PROXIMITY_TXPOWER_1M_LOSS 41  ///< Loss between the antenna and 1 m, subtracted from TxPower
+
+/**
+ * @class ProximityFilter
+ * @brief Exponentially weighted moving average of RSSI readings
+ *
+ * Single RSSI readings jump by 10 dB or more between advertisements, so
+ * sorting devices by the last reading reorders them at random. Each
+ * reading moves the average by PROXIMITY_ALPHA of its difference; a reading
+ * after a gap longer than PROXIMITY_STALE_MS restarts the average, since
+ * the device has likely moved. The distance follows the log-distance path
+ * loss model, referenced to the advertised TxPower when there is one. Not
+ * thread-safe; Device guards it with its property mutex.
+ */
+class ProximityFilter
+{
+public:
+  /**
+   * @brief Add an RSSI reading
+   * @param rssi Received signal strength in dBm
+   * @param nowMs Current time on the steady clock
+   */
+  void Update(int16_t rssi, uint64_t nowMs);
+
+  /**
+   * @brief Set the advertised transmit power used as the distance reference
+   * @param txPower Transmit power in dBm, DEVICE_RSSI_UNKNOWN if not advertised
+   */
+  void SetTxPower(int16_t txPower);
+
+  /**
+   * @brief Get the current estimate
+   * @return Proximity; samples is 0 if there was no reading
+   */
+  DeviceProximity Get() const;
+
+private:
+  int16_t m_lastRssi = DEVICE_RSSI_UNKNOWN; ///< Last raw reading
+  int16_t m_txPower = DEVICE_RSSI_UNKNOWN;  ///< Advertised transmit power
+  double m_smoothedRssi = 0;                ///< Moving average in dBm
+  uint32_t m_samples = 0;                   ///< Readings since the last restart
+  uint64_t m_lastUpdateMs = 0;              ///< Time of the last reading
+};
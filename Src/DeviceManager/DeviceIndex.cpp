@@ -0,0 +1,263 @@
+/**
+ * @file DeviceIndex.cpp
+ * @brief Implementation of the secondary indexes over the admitted devices
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "DeviceIndex.h"
+
+void DeviceIndex::Insert(const std::string &mac, const std::shared_ptr<Device> &device)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // Read the key under the lock, so a Refresh() racing with the insert cannot be lost
+  DeviceIndexKey key = device->IndexKey();
+  auto it = m_rows.find(device.get());
+  if (it != m_rows.end())
+  {
+    Relink(device.get(), &it->second.key, &key);
+    it->second.key = std::move(key);
+    return;
+  }
+  Relink(device.get(), nullptr, &key);
+  m_rows.emplace(device.get(), Row{mac, device, std::move(key)});
+}
+
+bool DeviceIndex::Refresh(Device &device, uint32_t fields)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_rows.find(&device);
+  if (it == m_rows.end())
+  {
+    return false;
+  }
+  if (!(fields & DEVICE_INDEX_FIELDS))
+  {
+    return true;
+  }
+  DeviceIndexKey key = device.IndexKey();
+  Relink(&device, &it->second.key, &key);
+  it->second.key = std::move(key);
+  return true;
+}
+
+void DeviceIndex::Remove(const Device *device)
+{
+  // Declared before the lock: if this is the last reference the Device is destroyed unlocked
+  std::shared_ptr<Device> removed;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_rows.find(device);
+  if (it == m_rows.end())
+  {
+    return;
+  }
+  Relink(device, &it->second.key, nullptr);
+  removed = std::move(it->second.device);
+  m_rows.erase(it);
+}
+
+void DeviceIndex::Clear()
+{
+  std::unordered_map<const Device *, Row> removed;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  removed.swap(m_rows);
+  m_paired = {};
+  m_connected = {};
+  m_byUuid.clear();
+  m_byMajorClass = {};
+  m_byAdapter.clear();
+}
+
+void DeviceIndex::Relink(const Device *device, const DeviceIndexKey *from, const DeviceIndexKey *to)
+{
+  if (!from || !to || from->paired != to->paired)
+  {
+    if (from)
+    {
+      m_paired[from->paired].erase(device);
+    }
+    if (to)
+    {
+      m_paired[to->paired].insert(device);
+    }
+  }
+  if (!from || !to || from->connected != to->connected)
+  {
+    if (from)
+    {
+      m_connected[from->connected].erase(device);
+    }
+    if (to)
+    {
+      m_connected[to->connected].insert(device);
+    }
+  }
+  if (!from || !to || from->majorClass != to->majorClass)
+  {
+    if (from)
+    {
+      m_byMajorClass[from->majorClass % DEVICE_INDEX_MAJOR_CLASSES].erase(device);
+    }
+    if (to)
+    {
+      m_byMajorClass[to->majorClass % DEVICE_INDEX_MAJOR_CLASSES].insert(device);
+    }
+  }
+  if (!from || !to || from->adapter != to->adapter)
+  {
+    if (from)
+    {
+      auto it = m_byAdapter.find(from->adapter);
+      if (it != m_byAdapter.end() && it->second.erase(device) && it->second.empty())
+      {
+        m_byAdapter.erase(it);
+      }
+    }
+    if (to)
+    {
+      m_byAdapter[to->adapter].insert(device);
+    }
+  }
+  if (!from || !to || from->uuids != to->uuids)
+  {
+    if (from)
+    {
+      for (const Uuid128 &uuid : from->uuids)
+      {
+        if (to && to->uuids.Contains(uuid))
+        {
+          continue;
+        }
+        auto it = m_byUuid.find(uuid);
+        if (it != m_byUuid.end() && it->second.erase(device) && it->second.empty())
+        {
+          m_byUuid.erase(it);
+        }
+      }
+    }
+    if (to)
+    {
+      for (const Uuid128 &uuid : to->uuids)
+      {
+        m_byUuid[uuid].insert(device);
+      }
+    }
+  }
+}
+
+bool DeviceIndex::Matches(const DeviceIndexKey &key, const DeviceQuery &query)
+{
+  if (query.paired && key.paired != *query.paired)
+  {
+    return false;
+  }
+  if (query.connected && key.connected != *query.connected)
+  {
+    return false;
+  }
+  if (query.majorClass && key.majorClass != *query.majorClass)
+  {
+    return false;
+  }
+  if (query.adapter && key.adapter != *query.adapter)
+  {
+    return false;
+  }
+  return query.anyUuid.empty() || key.uuids.Intersects(query.anyUuid);
+}
+
+DeviceQueryResult DeviceIndex::Query(const DeviceQuery &query) const
+{
+  static const Postings none;
+  std::vector<DeviceMatch> matches;
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // Pick the smallest source of candidates; UUIDs contribute the union of their lists
+  std::vector<const Postings *> sources;
+  size_t sourceSize = m_rows.size();
+  bool narrowed = false;
+  auto consider = [&sources, &sourceSize, &narrowed](std::vector<const Postings *> lists) {
+    size_t size = 0;
+    for (const Postings *list : lists)
+    {
+      size += list->size();
+    }
+    if (!narrowed || size < sourceSize)
+    {
+      sources = std::move(lists);
+      sourceSize = size;
+      narrowed = true;
+    }
+  };
+  if (query.paired)
+  {
+    consider({&m_paired[*query.paired]});
+  }
+  if (query.connected)
+  {
+    consider({&m_connected[*query.connected]});
+  }
+  if (query.majorClass)
+  {
+    consider({*query.majorClass < DEVICE_INDEX_MAJOR_CLASSES ? &m_byMajorClass[*query.majorClass] : &none});
+  }
+  if (query.adapter)
+  {
+    auto it = m_byAdapter.find(*query.adapter);
+    consider({it != m_byAdapter.end() ? &it->second : &none});
+  }
+  if (!query.anyUuid.empty())
+  {
+    std::vector<const Postings *> lists;
+    for (const Uuid128 &uuid : query.anyUuid)
+    {
+      auto it = m_byUuid.find(uuid);
+      if (it != m_byUuid.end())
+      {
+        lists.push_back(&it->second);
+      }
+    }
+    consider(std::move(lists));
+  }
+
+  auto collect = [&matches, &query](const Row &row) {
+    if (Matches(row.key, query))
+    {
+      matches.push_back({row.mac, row.device});
+    }
+  };
+  if (!narrowed)
+  {
+    matches.reserve(m_rows.size());
+    for (const auto &row : m_rows)
+    {
+      collect(row.second);
+    }
+  }
+  else
+  {
+    matches.reserve(sourceSize);
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+      for (const Device *device : *sources[i])
+      {
+        const Row &row = m_rows.at(device);
+        // A device offering several of the UUIDs is taken from the first list that has it
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; ++j)
+        {
+          seen = sources[j]->count(device) != 0;
+        }
+        if (!seen)
+        {
+          collect(row);
+        }
+      }
+    }
+  }
+  std::sort(matches.begin(), matches.end(), [](const DeviceMatch &a, const DeviceMatch &b) { return a.mac < b.mac; });
+  return DeviceQueryResult(std::move(matches));
+}
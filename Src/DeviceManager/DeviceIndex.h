@@ -0,0 +1,113 @@
+/**
+ * @file DeviceIndex.h
+ * @brief Secondary indexes over the admitted devices for property queries
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "IDeviceManager.h"
+#include "Device.h"
+
+#define DEVICE_INDEX_MAJOR_CLASSES 32 ///< Major device class is a 5-bit field
+
+/// DEVICE_FIELD_* bits that DeviceIndexKey is built from
+#define DEVICE_INDEX_FIELDS (DEVICE_FIELD_Paired | DEVICE_FIELD_Connected | DEVICE_FIELD_UUIDs | DEVICE_FIELD_Class | DEVICE_FIELD_Adapter)
+
+/**
+ * @class DeviceIndex
+ * @brief Posting lists of admitted devices by paired, connected, UUID, class and adapter
+ *
+ * Each Device has one row holding the DeviceIndexKey it was last indexed
+ * with. Devices report property changes through the hook DeviceManager
+ * hands them; for changes in DEVICE_INDEX_FIELDS, Refresh() moves the
+ * device only between the lists whose field changed. A query walks the
+ * smallest list its criteria name and checks the remaining criteria on the row, so "paired,
+ * offering SPP, not connected" reads about as many rows as it returns.
+ * Thread-safe.
+ */
+class DeviceIndex
+{
+public:
+  /**
+   * @brief Index a device that joined the registry
+   * @param mac MAC address of the device
+   * @param device Device; its current properties are read under the index lock
+   */
+  void Insert(const std::string &mac, const std::shared_ptr<Device> &device);
+
+  /**
+   * @brief Re-read the indexed properties of a device after a change
+   * @param device Device; ignored if it is not indexed (yet)
+   * @param fields DEVICE_FIELD_* bits that changed; the key is re-read only for DEVICE_INDEX_FIELDS
+   * @return False if the device is not indexed
+   */
+  bool Refresh(Device &device, uint32_t fields);
+
+  /**
+   * @brief Drop a device that left the registry
+   * @param device Device
+   */
+  void Remove(const Device *device);
+
+  /**
+   * @brief Drop every device
+   */
+  void Clear();
+
+  /**
+   * @brief Get the devices matching a query
+   * @param query Criteria; a default query matches every device
+   * @return Matches ordered by MAC address
+   */
+  DeviceQueryResult Query(const DeviceQuery &query) const;
+
+private:
+  /// Devices in one posting list
+  typedef std::unordered_set<const Device *> Postings;
+
+  /**
+   * @struct Row
+   * @brief One indexed device
+   */
+  typedef struct
+  {
+    std::string mac;                ///< MAC address
+    std::shared_ptr<Device> device; ///< Device
+    DeviceIndexKey key;             ///< Properties the device is listed under
+  } Row;
+
+  /**
+   * @brief Move a device between the posting lists of the fields that changed
+   * @param device Device
+   * @param from Key the device is listed under; nullptr if it is listed nowhere
+   * @param to Key to list it under; nullptr to unlist it
+   */
+  void Relink(const Device *device, const DeviceIndexKey *from, const DeviceIndexKey *to);
+
+  /**
+   * @brief Check a row against every criterion of a query
+   * @param key Indexed properties
+   * @param query Criteria
+   * @return True if all criteria hold
+   */
+  static bool Matches(const DeviceIndexKey &key, const DeviceQuery &query);
+
+  mutable std::mutex m_mutex;                                      ///< Protects all members below
+  std::unordered_map<const Device *, Row> m_rows;                  ///< Indexed devices
+  std::array<Postings, 2> m_paired;                                ///< Devices by pairing status
+  std::array<Postings, 2> m_connected;                             ///< Devices by connection status
+  std::map<Uuid128, Postings> m_byUuid;                            ///< Devices offering each UUID
+  std::array<Postings, DEVICE_INDEX_MAJOR_CLASSES> m_byMajorClass; ///< Devices by major class
+  std::map<uint8_t, Postings> m_byAdapter;                         ///< Devices by adapter index
+};
@@ -6,11 +6,27 @@
  * @date 2025
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
 #include "Logger.h"
+#include "DispatchWatchdog.h"
 
 #include "DeviceManager.h"
+#include "Trace.h"
 
 #define TAG "DeviceManager::" ///< Tag for logging messages
+#define DEVICE_QUEUE_CAPACITY 1024 ///< Device events queued before producers drop them
+#define DEVICE_COMMAND_THREADS 4   ///< Workers running device commands across all devices
+#define EVICTION_INTERVAL_MS 10000 ///< Idle-timeout sweep period when an idle timeout is set
+#define NOTIFIER_QUEUE_CAPACITY 4096 ///< Registry events queued for subscribers before they are dropped
+
+/// One match rule for PropertiesChanged of every BlueZ device object
+const std::string DEVICE_PROPERTIES_MATCH = "type='signal',sender='org.bluez',"
+                                            "interface='org.freedesktop.DBus.Properties',member='PropertiesChanged',"
+                                            "path_namespace='/org/bluez',arg0='org.bluez.Device1'";
 
 /**
  * @brief Construct a new Device Manager object
@@ -19,71 +35,261 @@
  * the running state for the event loop thread.
  * 
  * @param connection Reference to D-Bus system bus connection
+ * @param config Registry caps
  */
-DeviceManager::DeviceManager(sdbus::IConnection &connection) : m_running(true),
-                                                               m_connection(connection)
+DeviceManager::DeviceManager(sdbus::IConnection &connection, const DeviceManagerConfig &config) : m_running(true),
+                                                                                                 m_connection(connection),
+                                                                                                 m_config(config),
+                                                                                                 m_deviceQueue(DEVICE_QUEUE_CAPACITY),
+                                                                                                 m_commandExecutor(DEVICE_COMMAND_THREADS),
+                                                                                                 m_evictedDevices(MetricsRegistry::Instance().GetCounter("bluezeg_devices_evicted_total", "Idle devices evicted from the registry")),
+                                                                                                 m_queueDepth(MetricsRegistry::Instance().GetGauge("bluezeg_device_queue_depth", "Device events waiting for the device manager")),
+                                                                                                 m_queueDrops(MetricsRegistry::Instance().GetCounter("bluezeg_device_queue_dropped_total", "Device events dropped on a full queue")),
+                                                                                                 m_sightings(config.maxSightings),
+                                                                                                 m_notifier(NOTIFIER_QUEUE_CAPACITY, config.notifyDebounceMs)
 {
-  Log("%s%s", TAG, __func__);
+  Log("%s%s Max Devices - %zu Idle Timeout - %u s Notify Debounce - %u ms", TAG, __func__, m_config.maxDevices,
+      m_config.idleTimeoutSec, m_config.notifyDebounceMs);
+  MetricsRegistry::Instance().SetGaugeCallback("bluezeg_devices", "Devices in the registry", [this]() {
+    std::lock_guard<std::mutex> lock(m_deviceManagerMutex);
+    return static_cast<int64_t>(m_devicesMap.size());
+  });
+  MetricsRegistry::Instance().SetGaugeCallback("bluezeg_sightings", "Devices seen but not admitted", [this]() {
+    return static_cast<int64_t>(m_sightings.Size());
+  });
 }
 
 DeviceManager::~DeviceManager()
 {
   Log("%s%s", TAG, __func__);
-  {
-    std::lock_guard<std::mutex> lock(m_deviceManagerMutex);
-    m_running = false;
-  }
-  m_deviceQueueCV.notify_one();
+  MetricsRegistry::Instance().Remove("bluezeg_devices");
+  MetricsRegistry::Instance().Remove("bluezeg_sightings");
+  m_propertiesMatch.reset();
+  m_running = false;
+  m_deviceQueue.Close();
   if (m_eventLoopThread.joinable())
   {
     m_eventLoopThread.join();
   }
   RemoveDevices();
+  Log("%s%s Evicted Devices - %llu", TAG, __func__, static_cast<unsigned long long>(m_evictedDevices.Value()));
+  Log("%s%s Lifecycle\n%s", TAG, __func__, DeviceLifecycle::AggregateReport().c_str());
 }
 
 void DeviceManager::StartLooping()
 {
   Log("%s%s", TAG, __func__);
   m_eventLoopThread = std::thread(&DeviceManager::RunEventLoop, this);
+  try
+  {
+    m_propertiesMatch = m_connection.addMatch(DEVICE_PROPERTIES_MATCH, [this](sdbus::Message message) {
+      OnDevicePropertiesChanged(std::move(message));
+    });
+  }
+  catch (const sdbus::Error &e)
+  {
+    Log("%s%s Error adding PropertiesChanged match - %s", TAG, __func__, e.what());
+  }
 }
 
-void DeviceManager::DeviceAdded(std::string devicePath, bool enableLoop)
+void DeviceManager::OnDevicePropertiesChanged(sdbus::Message message)
 {
-  std::lock_guard<std::mutex> lock(m_deviceManagerMutex);
-  m_deviceQueue.push({devicePath, enableLoop});
-  m_deviceQueueCV.notify_one();
+  WATCHDOG_HANDLER("DeviceManager::OnDevicePropertiesChanged");
+  const char *path = message.getPath();
+  if (path == nullptr)
+  {
+    return;
+  }
+  std::string interfaceName;
+  std::map<sdbus::PropertyName, sdbus::Variant> changed;
+  try
+  {
+    message >> interfaceName >> changed;
+  }
+  catch (const sdbus::Error &e)
+  {
+    Log("%s%s Error: Malformed signal from %s - %s", TAG, __func__, path, e.what());
+    return;
+  }
+  std::string deviceMAC = GetMACFromPath(path);
+  std::shared_ptr<Device> device;
+  {
+    std::lock_guard<std::mutex> lock(m_deviceManagerMutex);
+    auto it = m_devicesMap.find(deviceMAC);
+    if (it != m_devicesMap.end() && it->second->GetPathHandle().Str() == path)
+    {
+      device = it->second;
+    }
+  }
+  if (device)
+  {
+    DeviceProxy::DispatchChanged(*device, changed);
+    return;
+  }
+
+  // Not admitted: only refresh the sighting
+  std::optional<int16_t> rssi;
+  std::optional<uint32_t> nameHash;
+  std::optional<uint32_t> deviceClass;
+  try
+  {
+    auto it = changed.find(sdbus::PropertyName(DEVICE_PROPERTY_RSSI));
+    if (it != changed.end())
+    {
+      rssi = it->second.get<int16_t>();
+    }
+    it = changed.find(sdbus::PropertyName(DEVICE_PROPERTY_Name));
+    if (it != changed.end())
+    {
+      nameHash = SightingTable::NameHash(it->second.get<std::string>());
+    }
+    it = changed.find(sdbus::PropertyName(DEVICE_PROPERTY_Class));
+    if (it != changed.end())
+    {
+      deviceClass = it->second.get<uint32_t>();
+    }
+  }
+  catch (const sdbus::Error &e)
+  {
+    Log("%s%s Error: Unexpected property type from %s - %s", TAG, __func__, path, e.what());
+  }
+  m_sightings.Update(SightingTable::ParseMac(deviceMAC), NowMs(), rssi, nameHash, deviceClass);
+}
+
+uint64_t DeviceManager::NowMs()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+DeviceSighting DeviceManager::MakeSighting(const std::string &devicePath, const DeviceProperties &properties, int16_t rssi)
+{
+  DeviceSighting sighting{};
+  sighting.mac = SightingTable::ParseMac(GetMACFromPath(devicePath));
+  sighting.lastSeenMs = NowMs();
+  sighting.deviceClass = properties.Class;
+  sighting.nameHash = SightingTable::NameHash(properties.Name);
+  sighting.rssi = rssi;
+  size_t pos = devicePath.find("/hci");
+  sighting.adapter = pos == std::string::npos ? 0 : static_cast<uint8_t>(strtoul(devicePath.c_str() + pos + 4, nullptr, 10));
+  return sighting;
+}
+
+void DeviceManager::DeviceSighted(std::string devicePath, DeviceProperties properties, int16_t rssi)
+{
+  DeviceSighting sighting = MakeSighting(devicePath, properties, rssi);
+  if (!sighting.mac)
+  {
+    Log("%s%s Error: No address in %s", TAG, __func__, LOG_STRING(devicePath));
+    return;
+  }
+  m_sightings.Record(sighting);
+}
+
+std::vector<DeviceSighting> DeviceManager::GetSightings(const SightingFilter &filter)
+{
+  return m_sightings.Query(filter, NowMs());
+}
+
+void DeviceManager::DeviceAdded(std::string devicePath, bool enableLoop, std::optional<DeviceProperties> properties)
+{
+  // Count before publishing so the consumer never takes the depth below zero
+  m_queueDepth.Add(1);
+  uint64_t flowId = Trace::NewFlowId();
+  Trace::FlowStart("admission", __func__, flowId);
+  // Queued as a handle: repeated reports of a path share one copy of it
+  if (!m_deviceQueue.TryPush({StringInterner::Instance().Intern(devicePath), enableLoop, false, std::move(properties), flowId}))
+  {
+    m_queueDepth.Add(-1);
+    m_queueDrops.Add();
+    Log("%s%s Error: Queue full, dropping Device - %s", TAG, __func__, LOG_STRING(devicePath));
+    return;
+  }
   Log("%s%s Device - %s added to queue", TAG, __func__, LOG_STRING(devicePath));
 }
 
 void DeviceManager::DeviceRemoved(std::string devicePath)
 {
-  std::string deviceMAC = GetMACFromPath(devicePath);
-  Log("%s%s Device - %s MAC - %s", TAG, __func__, LOG_STRING(devicePath), LOG_STRING(GetMACFromPath(devicePath)));
-  try
+  // Tear the Device down on the event thread, in order with additions
+  // Count before publishing so the consumer never takes the depth below zero
+  m_queueDepth.Add(1);
+  uint64_t flowId = Trace::NewFlowId();
+  Trace::FlowStart("admission", __func__, flowId);
+  if (!m_deviceQueue.TryPush({StringInterner::Instance().Intern(devicePath), false, true, std::nullopt, flowId}))
   {
-    m_devicesMap.at(deviceMAC).reset();
-    m_devicesMap.erase(deviceMAC);
+    m_queueDepth.Add(-1);
+    m_queueDrops.Add();
+    Log("%s%s Error: Queue full, dropping Device - %s", TAG, __func__, LOG_STRING(devicePath));
+    return;
   }
-  catch (const std::exception &e)
+  Log("%s%s Device - %s added to queue", TAG, __func__, LOG_STRING(devicePath));
+}
+
+void DeviceManager::EraseDevice(const InternedString &devicePath)
+{
+  std::string deviceMAC = GetMACFromPath(devicePath.Str());
+  Log("%s%s Device - %s MAC - %s", TAG, __func__, LOG_STRING(devicePath), LOG_STRING(deviceMAC));
+  m_sightings.Remove(SightingTable::ParseMac(deviceMAC));
+  std::shared_ptr<Device> device;
   {
-    Log("%s%s Device - %s Seleting %s, Error - %s", TAG, __func__, LOG_STRING(devicePath), LOG_STRING(deviceMAC), e.what());
+    std::lock_guard<std::mutex> lock(m_deviceManagerMutex);
+    auto it = m_devicesMap.find(deviceMAC);
+    if (it == m_devicesMap.end())
+    {
+      Log("%s%s Device - %s not in registry", TAG, __func__, LOG_STRING(deviceMAC));
+      return;
+    }
+    device = std::move(it->second);
+    m_devicesMap.erase(it);
+    m_index.Remove(device.get());
+    m_table.Remove(device.get());
   }
+  m_notifier.Publish(DeviceNotificationType::Removed, device->GetPathHandle());
+  // The proxy is torn down here, outside the registry lock
+  device.reset();
 }
 
 std::shared_ptr<IDevice> DeviceManager::GetDevice(std::string mac)
 {
-  std::shared_ptr<IDevice> device = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(m_deviceManagerMutex);
+    auto it = m_devicesMap.find(mac);
+    if (it != m_devicesMap.end())
+    {
+      return it->second;
+    }
+  }
+
+  // Admit a sighted device now that an operation targets it
+  TRACE_SCOPE("admission", "PromoteDevice");
+  DeviceSighting sighting;
+  if (!m_sightings.Find(SightingTable::ParseMac(mac), sighting))
+  {
+    Log("%s%s Device - %s not found", TAG, __func__, LOG_STRING(mac));
+    return nullptr;
+  }
+  std::string deviceMAC = SightingTable::FormatMac(sighting.mac);
+  std::string devicePath = "/org/bluez/hci" + std::to_string(sighting.adapter) + "/dev_" + deviceMAC;
+  std::replace(devicePath.begin(), devicePath.end(), ':', '_');
   try
   {
+    auto device = MakeDevice(StringInterner::Instance().Intern(devicePath), std::nullopt);
     std::lock_guard<std::mutex> lock(m_deviceManagerMutex);
-    auto it = m_devicesMap.at(mac);
-    device = it;
+    auto inserted = m_devicesMap.emplace(deviceMAC, std::move(device));
+    if (inserted.second)
+    {
+      m_notifier.Publish(DeviceNotificationType::Added, inserted.first->second->GetPathHandle());
+      m_index.Insert(deviceMAC, inserted.first->second);
+      m_table.Insert(deviceMAC, *inserted.first->second);
+    }
+    m_sightings.Remove(sighting.mac);
+    Log("%s%s Promoted Device - %s Device Count - %zu", TAG, __func__, LOG_STRING(devicePath), m_devicesMap.size());
+    return inserted.first->second;
   }
-  catch(const std::out_of_range& e)
+  catch (const sdbus::Error &e)
   {
-    Log("%s%s Out of Range Error", TAG, __func__, e.what());
+    Log("%s%s Error creating device for devicePath - %s, Error - %s", TAG, __func__, LOG_STRING(devicePath), e.what());
   }
-  return device;
+  return nullptr;
 }
 
 std::vector<std::string> DeviceManager::GetDevicesMAC()
@@ -97,53 +303,82 @@ std::vector<std::string> DeviceManager::GetDevicesMAC()
   return DevicesMAC;
 }
 
+DeviceQueryResult DeviceManager::QueryDevices(const DeviceQuery &query)
+{
+  return m_index.Query(query);
+}
+
+std::shared_ptr<Device> DeviceManager::MakeDevice(const InternedString &devicePath, std::optional<DeviceProperties> properties)
+{
+  return std::make_shared<Device>(m_connection, devicePath, m_commandExecutor, std::move(properties),
+                                  [this](Device &device, uint32_t fields) { OnDeviceChanged(device, fields); });
+}
+
+void DeviceManager::OnDeviceChanged(Device &device, uint32_t fields)
+{
+  m_table.Refresh(device, fields);
+  // Lifecycle state and last-seen changes only concern the table
+  fields &= DEVICE_FIELD_ALL;
+  // Changes before the device is indexed are covered by its Added event
+  if (!fields || !m_index.Refresh(device, fields))
+  {
+    return;
+  }
+  m_notifier.Publish(DeviceNotificationType::Changed, device.GetPathHandle(), fields);
+}
+
+uint64_t DeviceManager::Subscribe(uint32_t fields, DeviceNotificationCallback callback)
+{
+  return m_notifier.Subscribe(fields, std::move(callback));
+}
+
+void DeviceManager::Unsubscribe(uint64_t id)
+{
+  m_notifier.Unsubscribe(id);
+}
+
+std::vector<std::string> DeviceManager::GetDevicesByProximity()
+{
+  return m_table.ByProximity();
+}
+
+std::string DeviceManager::GetLifecycleReport()
+{
+  return DeviceLifecycle::AggregateReport();
+}
+
 void DeviceManager::RunEventLoop()
 {
+  Trace::SetThreadName("DeviceManager");
   try
   {
+    int waitMs = m_config.idleTimeoutSec ? EVICTION_INTERVAL_MS : -1;
     while (m_running)
     {
-      std::unique_lock<std::mutex> lock(m_deviceManagerMutex);
-      m_deviceQueueCV.wait(lock, [this]
-                           { return !m_running || !m_deviceQueue.empty(); });
+      m_deviceQueue.Wait(waitMs);
       if (!m_running)
       {
         Log("%s%s Exiting RunEventLoop", TAG, __func__);
         break;
       }
 
-      while (!m_deviceQueue.empty())
+      // Drain everything queued since the last wakeup
+      DeviceStruct devicePath;
+      while (m_deviceQueue.TryPop(devicePath))
       {
-        auto devicePath = m_deviceQueue.front();
-        m_deviceQueue.pop();
-        std::string deviceMAC = GetMACFromPath(devicePath.path);
-        Log("%s%s Processing Device - %s MAC - %s", TAG, __func__, LOG_STRING(devicePath.path), LOG_STRING(deviceMAC));
-
-        if (devicePath.path.empty() || deviceMAC.empty())
+        m_queueDepth.Add(-1);
+        if (devicePath.removed)
         {
-          Log("%s%s Error: devicePath or deviceMAC is empty", TAG, __func__);
-          continue;
+          TRACE_SCOPE_FLOW("admission", "EraseDevice", devicePath.flowId);
+          EraseDevice(devicePath.path);
         }
-        if (m_devicesMap.find(deviceMAC) != m_devicesMap.end())
+        else
         {
-          Log("%s%s Device - %s already exists", TAG, __func__, LOG_STRING(deviceMAC));
-          continue;
+          TRACE_SCOPE_FLOW("admission", "AddDevice", devicePath.flowId);
+          AddDevice(devicePath.path, std::move(devicePath.properties));
         }
-        try
-        {
-          m_devicesMap[deviceMAC] = std::make_shared<Device>(m_connection, devicePath.path);
-          Log("%s%s Device Count - %d", TAG, __func__, m_devicesMap.size());
-          if (lock.owns_lock())
-          {
-            lock.unlock();
-          }
-        }
-        catch (const sdbus::Error &e)
-        {
-          Log("%s%s Error creating device for devicePath - %s, Error - %s", TAG, __func__, LOG_STRING(devicePath.path), e.what());
-        }
-        // No need to re-lock the mutex here
       }
+      EvictDevices();
     }
   }
   catch (const std::system_error &e)
@@ -152,9 +387,111 @@ void DeviceManager::RunEventLoop()
   }
 }
 
+void DeviceManager::AddDevice(const InternedString &devicePath, std::optional<DeviceProperties> properties)
+{
+  std::string deviceMAC = GetMACFromPath(devicePath.Str());
+  Log("%s%s Processing Device - %s MAC - %s", TAG, __func__, LOG_STRING(devicePath), LOG_STRING(deviceMAC));
+
+  if (devicePath.Empty() || deviceMAC.empty())
+  {
+    Log("%s%s Error: devicePath or deviceMAC is empty", TAG, __func__);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_deviceManagerMutex);
+    auto it = m_devicesMap.find(deviceMAC);
+    if (it != m_devicesMap.end())
+    {
+      Log("%s%s Device - %s already exists", TAG, __func__, LOG_STRING(deviceMAC));
+      it->second->Seen();
+      return;
+    }
+  }
+  m_sightings.Remove(SightingTable::ParseMac(deviceMAC));
+  try
+  {
+    auto device = MakeDevice(devicePath, std::move(properties));
+    std::lock_guard<std::mutex> lock(m_deviceManagerMutex);
+    auto inserted = m_devicesMap.emplace(deviceMAC, std::move(device));
+    if (inserted.second)
+    {
+      // Added first: changes reported once the device is indexed must follow it
+      m_notifier.Publish(DeviceNotificationType::Added, devicePath);
+      m_index.Insert(deviceMAC, inserted.first->second);
+      m_table.Insert(deviceMAC, *inserted.first->second);
+    }
+    Log("%s%s Device Count - %zu", TAG, __func__, m_devicesMap.size());
+  }
+  catch (const sdbus::Error &e)
+  {
+    Log("%s%s Error creating device for devicePath - %s, Error - %s", TAG, __func__, LOG_STRING(devicePath), e.what());
+  }
+}
+
+void DeviceManager::EvictDevices()
+{
+  uint64_t nowMs = NowMs();
+  uint64_t idleMs = static_cast<uint64_t>(m_config.idleTimeoutSec) * 1000;
+  std::vector<std::shared_ptr<Device>> evicted;
+  size_t remaining = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_deviceManagerMutex);
+    if (!idleMs && m_devicesMap.size() <= m_config.maxDevices)
+    {
+      return;
+    }
+    // Idle devices, least recently seen first, from a scan of the table columns
+    for (const auto &candidate : m_table.IdleDevices())
+    {
+      bool overCap = m_devicesMap.size() > m_config.maxDevices;
+      // The column lags the device by up to a second, so it only ever looks older
+      if (!overCap && !(idleMs && nowMs - candidate.first > idleMs))
+      {
+        break;
+      }
+      auto it = m_devicesMap.find(candidate.second);
+      // Commands in flight are not in the table; the device has the final say
+      if (it == m_devicesMap.end() || !it->second->IsEvictable() ||
+          (!overCap && nowMs - it->second->LastSeenMs() <= idleMs))
+      {
+        continue;
+      }
+      m_index.Remove(it->second.get());
+      m_table.Remove(it->second.get());
+      evicted.push_back(std::move(it->second));
+      m_devicesMap.erase(it);
+    }
+    remaining = m_devicesMap.size();
+  }
+  if (evicted.empty())
+  {
+    return;
+  }
+  m_evictedDevices.Add(evicted.size());
+  for (const auto &device : evicted)
+  {
+    m_notifier.Publish(DeviceNotificationType::Removed, device->GetPathHandle());
+  }
+  Log("%s%s Evicted %zu Devices, Device Count - %zu", TAG, __func__, evicted.size(), remaining);
+  // Keep evicted devices listable as sightings
+  for (const auto &device : evicted)
+  {
+    DeviceSighting sighting = MakeSighting(device->GetPathHandle().Str(), *device->GetPropertiesSnapshot(), SIGHTING_RSSI_UNKNOWN);
+    sighting.lastSeenMs = device->LastSeenMs();
+    if (sighting.mac)
+    {
+      m_sightings.Record(sighting);
+    }
+  }
+  // Proxies are torn down here, outside the registry lock
+  evicted.clear();
+}
+
 void DeviceManager::RemoveDevices()
 {
   Log("%s%s", TAG, __func__);
+  m_index.Clear();
+  m_table.Clear();
   try
   {
     for (auto it = m_devicesMap.begin(); it != m_devicesMap.end();)
@@ -164,15 +501,16 @@ void DeviceManager::RemoveDevices()
         ++it;
         continue;
       }
-      auto properties = it->second->GetProperties();
-      if (properties.Connected)
+      auto properties = it->second->GetPropertiesSnapshot();
+      if (properties->Connected)
       {
         it->second->Disconnect();
       }
-      if (properties.Paired)
+      if (properties->Paired)
       {
         it->second->CancelPairing();
       }
+      it->second->WaitIdle();
       it->second.reset();
       it = m_devicesMap.erase(it);
     }
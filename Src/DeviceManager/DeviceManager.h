@@ -12,12 +12,20 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
-#include <queue>
-#include <condition_variable>
+#include <optional>
 
 #include <sdbus-c++/sdbus-c++.h>
 
 #include "IDeviceManager.h"
+#include "MPSCQueue.h"
+#include "Metrics.h"
+#include "CommandExecutor.h"
+#include "DeviceManagerConfig.h"
+#include "SightingTable.h"
+#include "DeviceIndex.h"
+#include "DeviceTable.h"
+#include "DeviceNotifier.h"
+#include "StringInterner.h"
 
 #include "Device.h"
 
@@ -29,8 +37,11 @@ typedef std::map<std::string, std::shared_ptr<Device>> DevicesMap;
  * @brief Structure for queuing device operations
  */
 typedef struct{
-  std::string path;   ///< D-Bus path of the device
+  InternedString path; ///< D-Bus path of the device
   bool enableLoop;    ///< Whether to enable event loop for this device
+  bool removed;       ///< True if BlueZ removed the device, false if it was added
+  std::optional<DeviceProperties> properties; ///< Properties announced with the device, if any
+  uint64_t flowId;    ///< Trace flow from the producer to the event loop
 }DeviceStruct;
 
 /**
@@ -40,6 +51,37 @@ typedef struct{
  * This class maintains a registry of discovered Bluetooth devices, handles
  * device addition/removal events, and provides thread-safe access to device
  * operations. It processes device events in a dedicated thread.
+ *
+ * Bus callbacks hand events over through a lock-free queue, so they never
+ * wait for the event thread; the registry lock is held only for map
+ * lookups and updates, never while a Device is being constructed.
+ *
+ * The registry is bounded: past DeviceManagerConfig::maxDevices, and
+ * optionally after an idle timeout, devices that are neither paired,
+ * connected nor busy with a command are evicted, least recently seen
+ * first, so the footprint stays flat however many devices pass by.
+ *
+ * Discovery only records devices in a SightingTable; a full Device is
+ * created when a device is paired or connected on arrival, when the agent
+ * sees it, or when GetDevice() asks for it. Evicted devices fall back to a
+ * sighting.
+ *
+ * A single match rule covers PropertiesChanged of every org.bluez.Device1
+ * object under /org/bluez; signals are routed to the Device by path, and
+ * signals for other devices refresh their sighting.
+ *
+ * Admitted devices are also listed in a DeviceIndex that each Device
+ * keeps current as its paired, connected, UUID, class or adapter
+ * properties change, so QueryDevices() filters without visiting every
+ * device or calling BlueZ.
+ *
+ * The fields that registry-wide scans read (flags, class, smoothed RSSI,
+ * last-seen time, lifecycle state) are mirrored in a DeviceTable, so
+ * eviction and proximity ordering read a few contiguous arrays instead of
+ * every Device.
+ *
+ * Subscribers registered with Subscribe() get added, removed and changed
+ * events in batches from a DeviceNotifier thread, instead of polling.
  */
 class DeviceManager : public IDeviceManager
 {
@@ -47,8 +89,9 @@ public:
   /**
    * @brief Construct a new Device Manager object
    * @param connection Reference to D-Bus system bus connection
+   * @param config Registry caps
    */
-  explicit DeviceManager(sdbus::IConnection &connection);
+  DeviceManager(sdbus::IConnection &connection, const DeviceManagerConfig &config);
   
   /**
    * @brief Destroy the Device Manager object and cleanup resources
@@ -67,9 +110,18 @@ public:
    * @brief Handle device addition event
    * @param devicePath D-Bus object path of the added device
    * @param enableLoop Whether to start event loop for this device
+   * @param properties Properties announced with the device, if any
    */
-  void DeviceAdded(std::string devicePath, bool enableLoop) override;
+  void DeviceAdded(std::string devicePath, bool enableLoop, std::optional<DeviceProperties> properties) override;
   
+  /**
+   * @brief Record a device seen during discovery without admitting it
+   * @param devicePath D-Bus object path of the device
+   * @param properties Properties announced with the device
+   * @param rssi RSSI in dBm, SIGHTING_RSSI_UNKNOWN if none
+   */
+  void DeviceSighted(std::string devicePath, DeviceProperties properties, int16_t rssi) override;
+
   /**
    * @brief Handle device removal event
    * @param devicePath D-Bus object path of the removed device
@@ -77,7 +129,7 @@ public:
   void DeviceRemoved(std::string devicePath) override;
 
   /**
-   * @brief Get device instance by MAC address
+   * @brief Get device instance by MAC address, admitting it if it was only sighted
    * @param mac MAC address of the device to retrieve
    * @return Shared pointer to IDevice instance, or nullptr if not found
    */
@@ -88,6 +140,46 @@ public:
    * @return Vector containing MAC addresses of all managed devices
    */
   std::vector<std::string> GetDevicesMAC() override;
+
+  /**
+   * @brief Get the admitted devices matching a query, from the registry indexes
+   * @param query Criteria; a default query matches every admitted device
+   * @return Matching devices
+   */
+  DeviceQueryResult QueryDevices(const DeviceQuery &query) override;
+
+  /**
+   * @brief Receive registry events instead of polling
+   * @param fields DEVICE_FIELD_* bits of interest
+   * @param callback Called on the notifier thread with each batch
+   * @return Subscription id for Unsubscribe()
+   */
+  uint64_t Subscribe(uint32_t fields, DeviceNotificationCallback callback) override;
+
+  /**
+   * @brief Stop a subscription
+   * @param id Id returned by Subscribe()
+   */
+  void Unsubscribe(uint64_t id) override;
+
+  /**
+   * @brief Get the MAC addresses of all managed devices, closest first
+   * @return MAC addresses ordered by smoothed RSSI; devices without a reading come last
+   */
+  std::vector<std::string> GetDevicesByProximity() override;
+
+  /**
+   * @brief Get the sightings of devices that are not admitted
+   * @param filter Criteria; a default filter matches every sighting
+   * @return Matching sightings
+   */
+  std::vector<DeviceSighting> GetSightings(const SightingFilter &filter) override;
+
+  /**
+   * @brief Get the lifecycle transition timings aggregated over all devices
+   * @return Multi-line report
+   */
+  std::string GetLifecycleReport() override;
   
 private:
   /**
@@ -105,6 +197,60 @@ private:
    * all managed devices and their event loops.
    */
   void RemoveDevices();
+
+  /**
+   * @brief Create a Device for a path reported by BlueZ and add it to the registry
+   * @param devicePath Interned D-Bus object path of the device
+   * @param properties Properties announced with the device, if any
+   */
+  void AddDevice(const InternedString &devicePath, std::optional<DeviceProperties> properties);
+
+  /**
+   * @brief Route a Device1 PropertiesChanged signal to its Device
+   * @param message PropertiesChanged signal
+   */
+  void OnDevicePropertiesChanged(sdbus::Message message);
+
+  /**
+   * @brief Drop the Device for a path BlueZ no longer exports
+   * @param devicePath Interned D-Bus object path of the device
+   */
+  void EraseDevice(const InternedString &devicePath);
+
+  /**
+   * @brief Evict idle devices over the cap or past the idle timeout
+   */
+  void EvictDevices();
+
+  /**
+   * @brief Create a Device wired to the registry index
+   * @param devicePath Interned D-Bus object path of the device
+   * @param properties Properties announced with the device, if any
+   * @return New device, not yet in the registry
+   */
+  std::shared_ptr<Device> MakeDevice(const InternedString &devicePath, std::optional<DeviceProperties> properties);
+
+  /**
+   * @brief Handle a change of cached properties reported by a Device
+   * @param device Device
+   * @param fields DEVICE_FIELD_* bits that changed
+   */
+  void OnDeviceChanged(Device &device, uint32_t fields);
+
+  /**
+   * @brief Build a sighting record from a device path and properties
+   * @param devicePath D-Bus object path of the device
+   * @param properties Device properties
+   * @param rssi RSSI in dBm, SIGHTING_RSSI_UNKNOWN if none
+   * @return Sighting; its mac is 0 if the path holds no address
+   */
+  DeviceSighting MakeSighting(const std::string &devicePath, const DeviceProperties &properties, int16_t rssi);
+
+  /**
+   * @brief Get the current time for last-seen stamps
+   * @return Milliseconds on the steady clock
+   */
+  static uint64_t NowMs();
   
   /**
    * @brief Extract MAC address from D-Bus device path
@@ -115,10 +261,19 @@ private:
   
 private:
   sdbus::IConnection &m_connection;         ///< Reference to D-Bus connection
+  DeviceManagerConfig m_config;             ///< Registry caps
   DevicesMap m_devicesMap;                  ///< Map of MAC addresses to Device objects
-  std::mutex m_deviceManagerMutex;          ///< Mutex for thread-safe access
+  std::mutex m_deviceManagerMutex;          ///< Protects m_devicesMap
   std::atomic<bool> m_running;              ///< Flag to control event loop execution
   std::thread m_eventLoopThread;            ///< Thread for running the event loop
-  std::queue<DeviceStruct> m_deviceQueue;   ///< Queue for device operations
-  std::condition_variable m_deviceQueueCV;  ///< Condition variable for queue synchronization
+  MPSCQueue<DeviceStruct> m_deviceQueue;    ///< Queue for device operations
+  CommandExecutor m_commandExecutor;        ///< Workers shared by the device command strands
+  Counter &m_evictedDevices;                ///< Devices evicted so far
+  Gauge &m_queueDepth;                      ///< Events waiting in m_deviceQueue
+  Counter &m_queueDrops;                    ///< Events dropped because m_deviceQueue was full
+  sdbus::Slot m_propertiesMatch;            ///< Shared PropertiesChanged match for all devices
+  SightingTable m_sightings;                ///< Devices seen but not admitted
+  DeviceNotifier m_notifier;                ///< Fans registry events out to subscribers
+  DeviceIndex m_index;                      ///< Secondary indexes over m_devicesMap
+  DeviceTable m_table;                      ///< Hot fields of m_devicesMap in columns
 };
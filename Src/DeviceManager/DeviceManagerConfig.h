@@ -0,0 +1,22 @@
+/**
+ * @file DeviceManagerConfig.h
+ * @brief Limits applied to the device registry
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct DeviceManagerConfig
+ * @brief Registry caps; only devices that are neither paired nor connected are ever evicted
+ */
+typedef struct{
+  size_t maxDevices = 256;     ///< Devices kept before the least recently seen idle one is evicted
+  uint32_t idleTimeoutSec = 0; ///< Evict idle devices not seen for this many seconds, 0 to disable
+  size_t maxSightings = 4096;  ///< Sighting records kept for devices that are not admitted
+  uint32_t notifyDebounceMs = 50; ///< Window over which subscriber events are collected and merged, 0 to deliver at once
+}DeviceManagerConfig;
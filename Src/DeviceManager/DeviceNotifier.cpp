@@ -0,0 +1,221 @@
+/**
+ * @file DeviceNotifier.cpp
+ * @brief Implementation of the batched registry event fan-out
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+
+#include "DeviceNotifier.h"
+
+#include "Logger.h"
+#include "Trace.h"
+
+#define TAG "DeviceNotifier::" ///< Tag for logging messages
+#define DEBOUNCE_DRAIN_MS 10        ///< Queue drain period while a debounce window is open
+
+namespace
+{
+/**
+ * @brief Get the MAC address named by a device path
+ * @param path D-Bus object path, e.g. /org/bluez/hci0/dev_AA_BB_CC_DD_EE_FF
+ * @return MAC address with colons, empty if the path names none
+ */
+std::string MacFromPath(const std::string &path)
+{
+  size_t pos = path.find("dev_");
+  if (pos == std::string::npos)
+  {
+    return "";
+  }
+  std::string mac = path.substr(pos + 4);
+  std::replace(mac.begin(), mac.end(), '_', ':');
+  return mac;
+}
+} // namespace
+
+DeviceNotifier::DeviceNotifier(size_t capacity, uint32_t debounceMs) : m_subscribers(std::make_shared<const SubscriberList>()),
+                                                  m_wantedFields(0),
+                                                  m_hasSubscribers(false),
+                                                  m_nextId(1),
+                                                  m_debounceMs(debounceMs),
+                                                  m_queue(capacity),
+                                                  m_drops(MetricsRegistry::Instance().GetCounter("bluezeg_device_notifications_dropped_total", "Registry events dropped on a full notifier queue")),
+                                                  m_running(true)
+{
+  m_thread = std::thread(&DeviceNotifier::RunLoop, this);
+}
+
+DeviceNotifier::~DeviceNotifier()
+{
+  m_running = false;
+  m_queue.Close();
+  if (m_thread.joinable())
+  {
+    m_thread.join();
+  }
+}
+
+uint64_t DeviceNotifier::Subscribe(uint32_t fields, DeviceNotificationCallback callback)
+{
+  std::lock_guard<std::mutex> lock(m_subscribeMutex);
+  auto subscribers = std::make_shared<SubscriberList>(*m_subscribers.load());
+  uint64_t id = m_nextId++;
+  subscribers->push_back({id, fields & DEVICE_FIELD_ALL, std::move(callback)});
+  UpdateInterest(*subscribers);
+  m_subscribers.store(std::move(subscribers));
+  Log("%s%s Id - %llu Fields - 0x%x", TAG, __func__, static_cast<unsigned long long>(id), fields);
+  return id;
+}
+
+void DeviceNotifier::Unsubscribe(uint64_t id)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_subscribeMutex);
+    auto subscribers = std::make_shared<SubscriberList>(*m_subscribers.load());
+    subscribers->erase(std::remove_if(subscribers->begin(), subscribers->end(),
+                                      [id](const Subscriber &subscriber) { return subscriber.id == id; }),
+                       subscribers->end());
+    UpdateInterest(*subscribers);
+    m_subscribers.store(std::move(subscribers));
+  }
+  Log("%s%s Id - %llu", TAG, __func__, static_cast<unsigned long long>(id));
+  // The batch in flight may hold the old list; wait it out unless we are that batch
+  if (std::this_thread::get_id() != m_thread.get_id())
+  {
+    std::lock_guard<std::mutex> wait(m_deliveryMutex);
+  }
+}
+
+void DeviceNotifier::UpdateInterest(const SubscriberList &subscribers)
+{
+  uint32_t fields = 0;
+  for (const auto &subscriber : subscribers)
+  {
+    fields |= subscriber.fields;
+  }
+  m_wantedFields.store(fields, std::memory_order_relaxed);
+  m_hasSubscribers.store(!subscribers.empty(), std::memory_order_relaxed);
+}
+
+void DeviceNotifier::Publish(DeviceNotificationType type, const InternedString &devicePath, uint32_t fields)
+{
+  if (type == DeviceNotificationType::Changed)
+  {
+    fields &= m_wantedFields.load(std::memory_order_relaxed);
+    if (!fields)
+    {
+      return;
+    }
+  }
+  else if (!m_hasSubscribers.load(std::memory_order_relaxed))
+  {
+    return;
+  }
+  if (!m_queue.TryPush({type, devicePath, fields}))
+  {
+    m_drops.Add();
+  }
+}
+
+void DeviceNotifier::RunLoop()
+{
+  Trace::SetThreadName("DeviceNotifier");
+  std::vector<DeviceNotification> batch;
+  // Path id -> position of its Changed event in batch; the handle keeps the id from being recycled meanwhile
+  std::unordered_map<uint32_t, std::pair<size_t, InternedString>> lastChanged;
+  while (m_running)
+  {
+    m_queue.Wait();
+    if (!m_running)
+    {
+      break;
+    }
+    batch.clear();
+    lastChanged.clear();
+    auto merge = [&batch, &lastChanged](PendingNotification pending) {
+      uint32_t pathId = pending.path.Id();
+      if (pending.type != DeviceNotificationType::Changed)
+      {
+        // Changes after an add or remove start a new event, keeping the order
+        lastChanged.erase(pathId);
+        batch.push_back({pending.type, MacFromPath(pending.path.Str()), 0});
+        return;
+      }
+      auto it = lastChanged.find(pathId);
+      if (it != lastChanged.end())
+      {
+        batch[it->second.first].fields |= pending.fields;
+        return;
+      }
+      lastChanged.emplace(pathId, std::make_pair(batch.size(), pending.path));
+      batch.push_back({pending.type, MacFromPath(pending.path.Str()), pending.fields});
+    };
+    m_queue.Drain(merge);
+    // Hold the batch open for the window, draining as we go so the queue does not fill
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_debounceMs);
+    while (m_debounceMs && m_running)
+    {
+      auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+      if (remaining.count() <= 0)
+      {
+        break;
+      }
+      std::this_thread::sleep_for(std::min(remaining, std::chrono::milliseconds(DEBOUNCE_DRAIN_MS)));
+      m_queue.Drain(merge);
+    }
+    if (!batch.empty())
+    {
+      TRACE_SCOPE("device", "NotifyBatch");
+      Deliver(batch);
+    }
+  }
+}
+
+void DeviceNotifier::Deliver(const std::vector<DeviceNotification> &batch)
+{
+  std::lock_guard<std::mutex> lock(m_deliveryMutex);
+  std::shared_ptr<const SubscriberList> subscribers = m_subscribers.load();
+  uint32_t batchFields = 0;
+  for (const auto &notification : batch)
+  {
+    batchFields |= notification.fields;
+  }
+  std::vector<DeviceNotification> filtered;
+  for (const auto &subscriber : *subscribers)
+  {
+    const std::vector<DeviceNotification> *view = &batch;
+    // Only build a filtered copy for subscribers that do not want every field in the batch
+    if ((batchFields & subscriber.fields) != batchFields)
+    {
+      filtered.clear();
+      for (const auto &notification : batch)
+      {
+        if (notification.type != DeviceNotificationType::Changed)
+        {
+          filtered.push_back(notification);
+        }
+        else if (notification.fields & subscriber.fields)
+        {
+          filtered.push_back({notification.type, notification.mac, notification.fields & subscriber.fields});
+        }
+      }
+      if (filtered.empty())
+      {
+        continue;
+      }
+      view = &filtered;
+    }
+    try
+    {
+      subscriber.callback(*view);
+    }
+    catch (const std::exception &e)
+    {
+      Log("%s%s Error: Subscriber %llu threw - %s", TAG, __func__, static_cast<unsigned long long>(subscriber.id), e.what());
+    }
+  }
+}
@@ -0,0 +1,134 @@
+/**
+ * @file DeviceNotifier.h
+ * @brief Batched fan-out of registry events to subscribers
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "IDeviceManager.h"
+#include "MPSCQueue.h"
+#include "Metrics.h"
+#include "StringInterner.h"
+
+/**
+ * @class DeviceNotifier
+ * @brief Delivers registry events to subscribers from its own thread
+ *
+ * Publishing is one lock-free queue push of an interned path and a mask,
+ * whatever the number of subscribers, and is skipped outright when no
+ * subscriber wants the event, so the bus thread pays nothing for
+ * subscribers. The notifier thread drains everything queued since its
+ * last wakeup as one batch, merges the Changed events of each device and
+ * hands every subscriber its filtered view of the batch. With a debounce
+ * window, the batch stays open for that long after its first event, so a
+ * device flapping ServicesResolved or UUIDs yields one Changed event per
+ * window rather than one per signal.
+ *
+ * The subscriber list is copy-on-write behind an atomic pointer: the
+ * notifier thread reads it once per batch without locking, and
+ * Subscribe()/Unsubscribe() publish a new copy.
+ */
+class DeviceNotifier
+{
+public:
+  /**
+   * @brief Construct a new Device Notifier object and start its thread
+   * @param capacity Events queued before further events are dropped
+   * @param debounceMs Time a batch collects events before delivery, 0 to deliver at once
+   */
+  DeviceNotifier(size_t capacity, uint32_t debounceMs);
+
+  /**
+   * @brief Stop the thread; events still queued are discarded
+   */
+  ~DeviceNotifier();
+
+  DeviceNotifier(const DeviceNotifier &) = delete;
+  DeviceNotifier &operator=(const DeviceNotifier &) = delete;
+
+  /**
+   * @brief Add a subscriber
+   * @param fields DEVICE_FIELD_* bits of interest for Changed events
+   * @param callback Receives each batch
+   * @return Subscription id
+   */
+  uint64_t Subscribe(uint32_t fields, DeviceNotificationCallback callback);
+
+  /**
+   * @brief Remove a subscriber, waiting for a delivery in progress unless called from it
+   * @param id Subscription id
+   */
+  void Unsubscribe(uint64_t id);
+
+  /**
+   * @brief Queue an event; safe to call from any thread
+   * @param type Event
+   * @param devicePath Interned D-Bus object path of the device
+   * @param fields DEVICE_FIELD_* bits that changed, for Changed events
+   */
+  void Publish(DeviceNotificationType type, const InternedString &devicePath, uint32_t fields = 0);
+
+private:
+  /**
+   * @struct Subscriber
+   * @brief One subscription
+   */
+  typedef struct
+  {
+    uint64_t id;                         ///< Subscription id
+    uint32_t fields;                     ///< DEVICE_FIELD_* bits of interest
+    DeviceNotificationCallback callback; ///< Receives each batch
+  } Subscriber;
+
+  /**
+   * @struct PendingNotification
+   * @brief Queued event, resolved to a MAC address on the notifier thread
+   */
+  typedef struct
+  {
+    DeviceNotificationType type; ///< Event
+    InternedString path;         ///< D-Bus object path of the device
+    uint32_t fields;             ///< DEVICE_FIELD_* bits that changed
+  } PendingNotification;
+
+  /// Immutable snapshot of the subscribers
+  typedef std::vector<Subscriber> SubscriberList;
+
+  /**
+   * @brief Drain, merge and deliver batches until destruction
+   */
+  void RunLoop();
+
+  /**
+   * @brief Deliver one merged batch to every subscriber
+   * @param batch Events in order
+   */
+  void Deliver(const std::vector<DeviceNotification> &batch);
+
+  /**
+   * @brief Recompute which events have subscribers
+   * @param subscribers Current subscribers
+   */
+  void UpdateInterest(const SubscriberList &subscribers);
+
+  std::atomic<std::shared_ptr<const SubscriberList>> m_subscribers; ///< Current subscribers, copy-on-write
+  std::mutex m_subscribeMutex;                                     ///< Serialises Subscribe() and Unsubscribe()
+  std::mutex m_deliveryMutex;                                      ///< Held while a batch is delivered
+  std::atomic<uint32_t> m_wantedFields;                            ///< Union of the subscriber masks
+  std::atomic<bool> m_hasSubscribers;                              ///< Any subscriber, for Added and Removed
+  uint64_t m_nextId;                                               ///< Next subscription id
+  uint32_t m_debounceMs;                                           ///< Time a batch collects events
+  MPSCQueue<PendingNotification> m_queue;                          ///< Events waiting for the notifier thread
+  Counter &m_drops;                                                ///< Events dropped on a full queue
+  std::atomic<bool> m_running;                                     ///< Cleared to stop the thread
+  std::thread m_thread;                                            ///< Notifier thread
+};
@@ -0,0 +1,154 @@
+/**
+ * @file DeviceTable.cpp
+ * @brief Implementation of the column store of admitted devices
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "DeviceTable.h"
+
+void DeviceTable::Insert(const std::string &mac, Device &device)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_slots.find(&device);
+  if (it != m_slots.end())
+  {
+    Load(it->second, device);
+    return;
+  }
+  size_t slot = m_devices.size();
+  m_flags.push_back(0);
+  m_class.push_back(0);
+  m_rssi.push_back(NAN);
+  m_lastSeenMs.push_back(0);
+  m_state.push_back(DeviceState::Discovered);
+  m_macs.push_back(mac);
+  m_devices.push_back(&device);
+  m_slots.emplace(&device, slot);
+  // Read under the lock, so a Refresh() racing with the insert cannot be lost
+  Load(slot, device);
+}
+
+void DeviceTable::Refresh(Device &device, uint32_t fields)
+{
+  if (!(fields & DEVICE_TABLE_FIELDS))
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_slots.find(&device);
+  if (it != m_slots.end())
+  {
+    Load(it->second, device);
+  }
+}
+
+void DeviceTable::Load(size_t slot, Device &device)
+{
+  std::shared_ptr<const DeviceProperties> properties = device.GetPropertiesSnapshot();
+  DeviceProximity proximity = device.GetProximity();
+  m_flags[slot] = (properties->Paired ? DEVICE_FLAG_Paired : 0) | (properties->Connected ? DEVICE_FLAG_Connected : 0) |
+                  (properties->Trusted ? DEVICE_FLAG_Trusted : 0) | (properties->Blocked ? DEVICE_FLAG_Blocked : 0) |
+                  (properties->ServicesResolved ? DEVICE_FLAG_ServicesResolved : 0);
+  m_class[slot] = properties->Class;
+  m_rssi[slot] = proximity.samples ? static_cast<float>(proximity.smoothedRssi) : NAN;
+  m_lastSeenMs[slot] = device.LastSeenMs();
+  m_state[slot] = device.State();
+}
+
+void DeviceTable::Remove(const Device *device)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_slots.find(device);
+  if (it == m_slots.end())
+  {
+    return;
+  }
+  size_t slot = it->second;
+  m_slots.erase(it);
+
+  // Move the last row into the freed slot to keep the columns dense
+  size_t last = m_devices.size() - 1;
+  if (slot != last)
+  {
+    m_flags[slot] = m_flags[last];
+    m_class[slot] = m_class[last];
+    m_rssi[slot] = m_rssi[last];
+    m_lastSeenMs[slot] = m_lastSeenMs[last];
+    m_state[slot] = m_state[last];
+    m_macs[slot] = std::move(m_macs[last]);
+    m_devices[slot] = m_devices[last];
+    m_slots[m_devices[slot]] = slot;
+  }
+  m_flags.pop_back();
+  m_class.pop_back();
+  m_rssi.pop_back();
+  m_lastSeenMs.pop_back();
+  m_state.pop_back();
+  m_macs.pop_back();
+  m_devices.pop_back();
+}
+
+void DeviceTable::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_flags.clear();
+  m_class.clear();
+  m_rssi.clear();
+  m_lastSeenMs.clear();
+  m_state.clear();
+  m_macs.clear();
+  m_devices.clear();
+  m_slots.clear();
+}
+
+std::vector<std::pair<uint64_t, std::string>> DeviceTable::IdleDevices() const
+{
+  std::vector<std::pair<uint64_t, std::string>> idle;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  size_t count = m_devices.size();
+
+  // First pass over the flags and state columns only, without branches
+  std::vector<uint8_t> selected(count);
+  for (size_t slot = 0; slot < count; ++slot)
+  {
+    selected[slot] = ((m_flags[slot] & (DEVICE_FLAG_Paired | DEVICE_FLAG_Connected)) == 0) &
+                     ((m_state[slot] == DeviceState::Discovered) | (m_state[slot] == DeviceState::Disconnected));
+  }
+  for (size_t slot = 0; slot < count; ++slot)
+  {
+    if (selected[slot])
+    {
+      idle.emplace_back(m_lastSeenMs[slot], m_macs[slot]);
+    }
+  }
+  std::sort(idle.begin(), idle.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  return idle;
+}
+
+std::vector<std::string> DeviceTable::ByProximity() const
+{
+  std::vector<std::string> devicesMAC;
+  std::vector<std::pair<float, size_t>> ranked;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  size_t count = m_devices.size();
+  ranked.reserve(count);
+  for (size_t slot = 0; slot < count; ++slot)
+  {
+    // Without a reading the device sorts after every device with one
+    ranked.emplace_back(std::isnan(m_rssi[slot]) ? -INFINITY : m_rssi[slot], slot);
+  }
+  // Ties keep MAC order, as the registry map had them
+  std::sort(ranked.begin(), ranked.end(), [this](const auto &a, const auto &b) {
+    return a.first != b.first ? a.first > b.first : m_macs[a.second] < m_macs[b.second];
+  });
+  devicesMAC.reserve(count);
+  for (const auto &entry : ranked)
+  {
+    devicesMAC.push_back(m_macs[entry.second]);
+  }
+  return devicesMAC;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file DeviceTable.h
+ * @brief Column store of the hot fields of admitted devices
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Device.h"
+
+// Bits of the flags column
+#define DEVICE_FLAG_Paired 0x01           ///< Paired
+#define DEVICE_FLAG_Connected 0x02        ///< Connected
+#define DEVICE_FLAG_Trusted 0x04          ///< Trusted
+#define DEVICE_FLAG_Blocked 0x08          ///< Blocked
+#define DEVICE_FLAG_ServicesResolved 0x10 ///< ServicesResolved
+
+/// DEVICE_FIELD_* bits that the columns are built from
+#define DEVICE_TABLE_FIELDS (DEVICE_FIELD_Paired | DEVICE_FIELD_Connected | DEVICE_FIELD_Trusted | DEVICE_FIELD_Blocked | \
+                             DEVICE_FIELD_ServicesResolved | DEVICE_FIELD_Class | DEVICE_FIELD_RSSI |                   \
+                             DEVICE_FIELD_State | DEVICE_FIELD_LastSeen)
+
+/**
+ * @class DeviceTable
+ * @brief Struct-of-arrays copy of the fields that registry scans read
+ *
+ * Each admitted device has a slot; its flags, class, smoothed RSSI,
+ * last-seen time and lifecycle state sit at that slot in one contiguous
+ * array per field, next to those of every other device. Scans such as
+ * eviction and proximity ordering walk the few arrays they need from start
+ * to end instead of dereferencing one heap Device after another, and the
+ * per-field loops are simple enough for the compiler to vectorise. Strings
+ * and maps stay in the Device; the table keeps only the MAC address and
+ * Device pointer of a slot, in side arrays that scans read for the rows they return.
+ *
+ * Slots are dense: removing a device moves the last one into its slot.
+ * Devices report changes through the hook DeviceManager hands them, and
+ * Refresh() re-reads the row for changes in DEVICE_TABLE_FIELDS.
+ * Thread-safe.
+ */
+class DeviceTable
+{
+public:
+  /**
+   * @brief Give a device that joined the registry a slot
+   * @param mac MAC address of the device
+   * @param device Device; its current fields are read under the table lock
+   */
+  void Insert(const std::string &mac, Device &device);
+
+  /**
+   * @brief Re-read the row of a device after a change
+   * @param device Device; ignored if it has no slot
+   * @param fields DEVICE_FIELD_* bits that changed; the row is re-read only for DEVICE_TABLE_FIELDS
+   */
+  void Refresh(Device &device, uint32_t fields);
+
+  /**
+   * @brief Free the slot of a device that left the registry
+   * @param device Device
+   */
+  void Remove(const Device *device);
+
+  /**
+   * @brief Free every slot
+   */
+  void Clear();
+
+  /**
+   * @brief Get the devices that are neither paired, connected nor in a transient state
+   * @return (last-seen time, MAC address) pairs, least recently seen first
+   */
+  std::vector<std::pair<uint64_t, std::string>> IdleDevices() const;
+
+  /**
+   * @brief Get the MAC addresses of all devices, closest first
+   * @return MAC addresses ordered by smoothed RSSI; devices without a reading come last
+   */
+  std::vector<std::string> ByProximity() const;
+
+private:
+  /**
+   * @brief Read the fields of a device into a slot
+   * @param slot Slot
+   * @param device Device
+   */
+  void Load(size_t slot, Device &device);
+
+  mutable std::mutex m_mutex;                          ///< Protects all members below
+  std::vector<uint8_t> m_flags;                        ///< DEVICE_FLAG_* bits per slot
+  std::vector<uint32_t> m_class;                       ///< Class of device per slot
+  std::vector<float> m_rssi;                           ///< Smoothed RSSI in dBm per slot, NaN without a reading
+  std::vector<uint64_t> m_lastSeenMs;                  ///< Last BlueZ activity on the steady clock per slot
+  std::vector<DeviceState> m_state;                    ///< Lifecycle state per slot
+  std::vector<std::string> m_macs;                     ///< MAC address per slot
+  std::vector<const Device *> m_devices;               ///< Device per slot
+  std::unordered_map<const Device *, size_t> m_slots;  ///< Slot of each device
+};
@@ -0,0 +1,239 @@
+/**
+ * @file SightingTable.cpp
+ * @brief Implementation of the device sighting table
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <cstdio>
+
+#include "SightingTable.h"
+
+SightingTable::SightingTable(size_t capacity) : m_capacity(std::max<size_t>(capacity, 1))
+{
+  // Keep the index at most half full so probe sequences stay short
+  size_t size = 2;
+  while (size < m_capacity * 2)
+  {
+    size <<= 1;
+  }
+  m_index.assign(size, -1);
+  m_indexMask = size - 1;
+  m_records.reserve(m_capacity);
+  m_referenced.reserve(m_capacity);
+}
+
+size_t SightingTable::Probe(uint64_t mac) const
+{
+  size_t slot = static_cast<size_t>((mac * 0x9E3779B97F4A7C15ull) >> 32) & m_indexMask;
+  while (m_index[slot] >= 0 && m_records[m_index[slot]].mac != mac)
+  {
+    slot = (slot + 1) & m_indexMask;
+  }
+  return slot;
+}
+
+void SightingTable::UnlinkSlot(size_t slot)
+{
+  // Backward-shift deletion: pull later entries of the probe run into the gap
+  size_t hole = slot;
+  size_t next = (hole + 1) & m_indexMask;
+  while (m_index[next] >= 0)
+  {
+    size_t home = static_cast<size_t>((m_records[m_index[next]].mac * 0x9E3779B97F4A7C15ull) >> 32) & m_indexMask;
+    if (((next - home) & m_indexMask) >= ((next - hole) & m_indexMask))
+    {
+      m_index[hole] = m_index[next];
+      hole = next;
+    }
+    next = (next + 1) & m_indexMask;
+  }
+  m_index[hole] = -1;
+}
+
+void SightingTable::EraseSlot(size_t slot)
+{
+  size_t record = static_cast<size_t>(m_index[slot]);
+  UnlinkSlot(slot);
+
+  // Move the last record into the freed entry to keep the array dense
+  size_t last = m_records.size() - 1;
+  if (record != last)
+  {
+    m_index[Probe(m_records[last].mac)] = static_cast<int32_t>(record);
+    m_records[record] = m_records[last];
+    m_referenced[record] = m_referenced[last];
+  }
+  m_records.pop_back();
+  m_referenced.pop_back();
+}
+
+size_t SightingTable::NextVictim()
+{
+  // Every bit cleared here was set by a repeat sighting, so the sweep is O(1) amortised
+  while (true)
+  {
+    if (m_hand >= m_records.size())
+    {
+      m_hand = 0;
+    }
+    if (!m_referenced[m_hand])
+    {
+      return m_hand++;
+    }
+    m_referenced[m_hand++] = 0;
+  }
+}
+
+void SightingTable::Record(const DeviceSighting &sighting)
+{
+  std::lock_guard<std::mutex> lock(m_sightingMutex);
+  size_t slot = Probe(sighting.mac);
+  if (m_index[slot] >= 0)
+  {
+    m_records[m_index[slot]] = sighting;
+    m_referenced[m_index[slot]] = 1;
+    return;
+  }
+  if (m_records.size() >= m_capacity)
+  {
+    // Replace the victim in place, so nothing else in the array moves; the hand
+    // has just passed it, so the newcomer gets a full sweep before it can go
+    size_t victim = NextVictim();
+    UnlinkSlot(Probe(m_records[victim].mac));
+    m_index[Probe(sighting.mac)] = static_cast<int32_t>(victim);
+    m_records[victim] = sighting;
+    m_referenced[victim] = 0;
+    return;
+  }
+  // New records start unreferenced: one seen only once goes before any seen again
+  m_index[slot] = static_cast<int32_t>(m_records.size());
+  m_records.push_back(sighting);
+  m_referenced.push_back(0);
+}
+
+bool SightingTable::Update(uint64_t mac, uint64_t nowMs, std::optional<int16_t> rssi, std::optional<uint32_t> nameHash,
+                           std::optional<uint32_t> deviceClass)
+{
+  std::lock_guard<std::mutex> lock(m_sightingMutex);
+  size_t slot = Probe(mac);
+  if (m_index[slot] < 0)
+  {
+    return false;
+  }
+  DeviceSighting &sighting = m_records[m_index[slot]];
+  sighting.lastSeenMs = nowMs;
+  m_referenced[m_index[slot]] = 1;
+  if (rssi)
+  {
+    sighting.rssi = *rssi;
+  }
+  if (nameHash)
+  {
+    sighting.nameHash = *nameHash;
+  }
+  if (deviceClass)
+  {
+    sighting.deviceClass = *deviceClass;
+  }
+  return true;
+}
+
+bool SightingTable::Find(uint64_t mac, DeviceSighting &sighting)
+{
+  std::lock_guard<std::mutex> lock(m_sightingMutex);
+  size_t slot = Probe(mac);
+  if (m_index[slot] < 0)
+  {
+    return false;
+  }
+  sighting = m_records[m_index[slot]];
+  return true;
+}
+
+bool SightingTable::Remove(uint64_t mac)
+{
+  std::lock_guard<std::mutex> lock(m_sightingMutex);
+  size_t slot = Probe(mac);
+  if (m_index[slot] < 0)
+  {
+    return false;
+  }
+  EraseSlot(slot);
+  return true;
+}
+
+std::vector<DeviceSighting> SightingTable::Query(const SightingFilter &filter, uint64_t nowMs)
+{
+  std::vector<DeviceSighting> matches;
+  std::lock_guard<std::mutex> lock(m_sightingMutex);
+  for (const auto &sighting : m_records)
+  {
+    if (filter.majorClass && ((sighting.deviceClass >> 8) & 0x1F) != *filter.majorClass)
+    {
+      continue;
+    }
+    if (filter.minRssi && (sighting.rssi == SIGHTING_RSSI_UNKNOWN || sighting.rssi < *filter.minRssi))
+    {
+      continue;
+    }
+    if (filter.maxAgeMs && nowMs - sighting.lastSeenMs > *filter.maxAgeMs)
+    {
+      continue;
+    }
+    if (filter.nameHash && sighting.nameHash != *filter.nameHash)
+    {
+      continue;
+    }
+    matches.push_back(sighting);
+  }
+  return matches;
+}
+
+size_t SightingTable::Size()
+{
+  std::lock_guard<std::mutex> lock(m_sightingMutex);
+  return m_records.size();
+}
+
+uint64_t SightingTable::ParseMac(const std::string &mac)
+{
+  unsigned int octets[6];
+  char trailing;
+  if (sscanf(mac.c_str(), "%2x:%2x:%2x:%2x:%2x:%2x%c", &octets[0], &octets[1], &octets[2], &octets[3], &octets[4],
+             &octets[5], &trailing) != 6)
+  {
+    return 0;
+  }
+  uint64_t value = 0;
+  for (unsigned int octet : octets)
+  {
+    value = (value << 8) | octet;
+  }
+  return value;
+}
+
+std::string SightingTable::FormatMac(uint64_t mac)
+{
+  char text[18];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", static_cast<unsigned>((mac >> 40) & 0xFF),
+           static_cast<unsigned>((mac >> 32) & 0xFF), static_cast<unsigned>((mac >> 24) & 0xFF),
+           static_cast<unsigned>((mac >> 16) & 0xFF), static_cast<unsigned>((mac >> 8) & 0xFF),
+           static_cast<unsigned>(mac & 0xFF));
+  return text;
+}
+
+uint32_t SightingTable::NameHash(const std::string &name)
+{
+  if (name.empty())
+  {
+    return 0;
+  }
+  uint32_t hash = 2166136261u;
+  for (unsigned char c : name)
+  {
+    hash = (hash ^ c) * 16777619u;
+  }
+  return hash;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file SightingTable.h
+ * @brief Compact records of devices seen during discovery but not admitted
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "DeviceHelper.h"
+
+/**
+ * @class SightingTable
+ * @brief Flat table of device sightings with an open-addressed MAC index
+ *
+ * Devices seen during discovery are recorded here instead of getting a
+ * full Device with its proxy and property cache. Records live in one
+ * contiguous array, so listing and filtering thousands of them is a linear
+ * scan over 32-byte entries; lookups by MAC go through a linear-probing
+ * index. When the table is full, a record not seen recently is replaced,
+ * chosen by a CLOCK hand sweeping the array: each record has a reference
+ * bit set whenever it is seen again, and the hand clears set bits
+ * until it reaches a clear one, so eviction costs O(1) amortised however
+ * large the table is. Thread-safe.
+ */
+class SightingTable
+{
+public:
+  /**
+   * @brief Construct a new Sighting Table object
+   * @param capacity Maximum number of records
+   */
+  explicit SightingTable(size_t capacity);
+
+  /**
+   * @brief Insert or replace the record of a device
+   * @param sighting Record; its mac field is the key
+   */
+  void Record(const DeviceSighting &sighting);
+
+  /**
+   * @brief Update fields of an existing record and its last-seen time
+   * @param mac Device address
+   * @param nowMs Current time on the steady clock
+   * @param rssi New RSSI, if reported
+   * @param nameHash New name hash, if reported
+   * @param deviceClass New class, if reported
+   * @return False if the device has no record
+   */
+  bool Update(uint64_t mac, uint64_t nowMs, std::optional<int16_t> rssi, std::optional<uint32_t> nameHash,
+              std::optional<uint32_t> deviceClass);
+
+  /**
+   * @brief Look up the record of a device
+   * @param mac Device address
+   * @param sighting Receives the record
+   * @return False if the device has no record
+   */
+  bool Find(uint64_t mac, DeviceSighting &sighting);
+
+  /**
+   * @brief Remove the record of a device
+   * @param mac Device address
+   * @return False if the device had no record
+   */
+  bool Remove(uint64_t mac);
+
+  /**
+   * @brief Copy the records matching a filter
+   * @param filter Criteria
+   * @param nowMs Current time on the steady clock, used by maxAgeMs
+   * @return Matching records in table order
+   */
+  std::vector<DeviceSighting> Query(const SightingFilter &filter, uint64_t nowMs);
+
+  /**
+   * @brief Get the number of records
+   * @return Record count
+   */
+  size_t Size();
+
+  /**
+   * @brief Parse a colon-separated address
+   * @param mac Address such as "AA:BB:CC:DD:EE:FF"
+   * @return 48-bit address, or 0 if malformed
+   */
+  static uint64_t ParseMac(const std::string &mac);
+
+  /**
+   * @brief Format a 48-bit address
+   * @param mac Address
+   * @return Address such as "AA:BB:CC:DD:EE:FF"
+   */
+  static std::string FormatMac(uint64_t mac);
+
+  /**
+   * @brief Hash a device name for SightingFilter::nameHash
+   * @param name Device name
+   * @return FNV-1a hash, 0 for an empty name
+   */
+  static uint32_t NameHash(const std::string &name);
+
+private:
+  /**
+   * @brief Find the index slot of a device
+   * @param mac Device address
+   * @return Slot holding the device, or the empty slot where it would go
+   */
+  size_t Probe(uint64_t mac) const;
+
+  /**
+   * @brief Clear an index slot, keeping the probe runs through it intact
+   * @param slot Index slot holding a record
+   */
+  void UnlinkSlot(size_t slot);
+
+  /**
+   * @brief Remove the record in an index slot
+   * @param slot Index slot holding the record
+   */
+  void EraseSlot(size_t slot);
+
+  /**
+   * @brief Advance the CLOCK hand to a record whose reference bit is clear
+   * @return Entry in m_records to replace
+   */
+  size_t NextVictim();
+
+private:
+  std::mutex m_sightingMutex;            ///< Protects the members below
+  size_t m_capacity;                     ///< Maximum number of records
+  std::vector<DeviceSighting> m_records; ///< Dense record array
+  std::vector<uint8_t> m_referenced;     ///< CLOCK reference bit per record
+  size_t m_hand = 0;                     ///< CLOCK hand, the next record considered for eviction
+  std::vector<int32_t> m_index;          ///< Open-addressed MAC index into m_records, -1 if empty
+  size_t m_indexMask;                    ///< Index size minus one
+};
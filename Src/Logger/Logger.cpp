@@ -12,6 +12,7 @@
 #include <string>
 
 #include "Logger.h"
+#include "Metrics.h"
 
 #define BUFFER_LEN  512  ///< Maximum length for log message buffer
 char Buffer[BUFFER_LEN]; ///< Static buffer for formatting log messages
@@ -35,10 +36,19 @@ void Log(const char* fmt, ...)
   std::ostringstream timeStream;
   timeStream << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S");
 
+  static Counter &messages = MetricsRegistry::Instance().GetCounter("bluezeg_log_messages_total", "Log lines written");
+  static Counter &truncated = MetricsRegistry::Instance().GetCounter(
+      "bluezeg_log_truncated_total", "Log lines cut to the log buffer length");
+
   // Initialize the variadic arguments
   va_list args;
   va_start(args, fmt);
-  vsnprintf(Buffer, BUFFER_LEN, fmt, args);
+  int len = vsnprintf(Buffer, BUFFER_LEN, fmt, args);
   va_end(args);
+  messages.Add();
+  if (len >= BUFFER_LEN)
+  {
+    truncated.Add();
+  }
   std::cout << timeStream.str() << " " << Buffer<< std::endl;
 }
@@ -9,13 +9,17 @@
 #include <string>
 #include <map>
 #include <functional>
+#include <algorithm>
 
 #include <cstdint>
+#include <ctime>
 
 #include "Menu.h"
 #include "main.h"
+#include "SightingTable.h"
 
 #include "Logger.h"
+#include "Trace.h"
 
 #define TAG "Menu::"    ///< Tag for logging messages
 
@@ -42,6 +46,8 @@ typedef enum
   DISCONNECT_SPP_PROFILE,
   PAIR,
   CANCEL_PAIRING,
+  LIFECYCLE_STATS,
+  DUMP_TRACE,
   EXIT,
   MAX_MENU
 } MenuEnum;
@@ -62,28 +68,12 @@ std::map<uint8_t, std::string> menu_map = {
     {DISCONNECT_SPP_PROFILE, "Disconnect SPP Profile"},
     {PAIR, "Pair"},
     {CANCEL_PAIRING, "Cancel Pairing"},
+    {LIFECYCLE_STATS, "Lifecycle Stats"},
+    {DUMP_TRACE, "Dump Trace"},
     {EXIT, "Exit"}};
 
-std::map<std::string, std::string> UUIDDescription{
-    {"00001101-0000-1000-8000-00805f9b34fb", "Serial Port Profile (SPP)"},
-    {"00001105-0000-1000-8000-00805f9b34fb", "Dial-Up Networking (DUN)"},
-    {"00001106-0000-1000-8000-00805f9b34fb", "IrMC Sync"},
-    {"00001107-0000-1000-8000-00805f9b34fb", "OBEX Object Push"},
-    {"00001108-0000-1000-8000-00805f9b34fb", "OBEX File Transfer"},
-    {"00001109-0000-1000-8000-00805f9b34fb", "IrMC Sync Command"},
-    {"0000110a-0000-1000-8000-00805f9b34fb", "Headset Profile (HSP)"},
-    {"0000110b-0000-1000-8000-00805f9b34fb", "Audio Gateway (AG)"},
-    {"0000110c-0000-1000-8000-00805f9b34fb", "Audio/Video Remote Control Profile (AVRCP)"},
-    {"0000110d-0000-1000-8000-00805f9b34fb", "Hands-Free Profile (HFP)"},
-    {"0000110e-0000-1000-8000-00805f9b34fb", "Hands-Free Profile (HFP)"},
-    {"0000110f-0000-1000-8000-00805f9b34fb", "Basic Imaging Profile (BIP)"},
-    {"00001110-0000-1000-8000-00805f9b34fb", "Basic Imaging Profile (BIP)"},
-    {"00001111-0000-1000-8000-00805f9b34fb", "Basic Imaging Profile (BIP)"},
-    {"00001112-0000-1000-8000-00805f9b34fb", "Basic Imaging Profile (BIP)"},
-    {"00001113-0000-1000-8000-00805f9b34fb", "Basic Imaging Profile (BIP)"},
-    {"00001114-0000-1000-8000-00805f9b34fb", "Basic Imaging Profile (BIP)"},
-    {"00001115-0000-1000-8000-00805f9b34fb", "Basic Imaging Profile (BIP)"},
-};
+/// Profiles AutoConnectSPP connects to
+const UuidSet autoConnectProfiles = {Uuid128::FromString(SPP_UUID)};
 
 std::map<uint8_t, std::function<void(Menu* callback)>> dispatchMenuCallbacks = {
   {START_DISCOVERY,         [](Menu* callback) { callback->StartDiscovery(); }},
@@ -101,6 +91,8 @@ std::map<uint8_t, std::function<void(Menu* callback)>> dispatchMenuCallbacks = {
   {DISCONNECT_SPP_PROFILE,  [](Menu* callback) { callback->DisconnectSPP(); }},
   {PAIR,                    [](Menu* callback) { callback->Pair(); }},
   {CANCEL_PAIRING,          [](Menu* callback) { callback->CancelPairing(); }},
+  {LIFECYCLE_STATS,         [](Menu* callback) { callback->LifecycleStats(); }},
+  {DUMP_TRACE,              [](Menu* callback) { callback->DumpTrace(); }},
   {EXIT,                    [](Menu* callback) { callback->StopApplication(); }},
 };
 Menu::Menu(std::shared_ptr<Application> app) : m_application(app)
@@ -177,6 +169,13 @@ void Menu::ListDevices()
   for (auto device : devices) {
     Log("%s%s Device - %s", TAG, __func__, LOG_STRING(device));
   }
+  auto sightings = m_application->GetDeviceManager().GetSightings(SightingFilter{});
+  for (const auto &sighting : sightings) {
+    BluetoothDeviceClass deviceClass = BluetoothDeviceClass::from_uint32_t(sighting.deviceClass);
+    Log("%s%s Nearby - %s Major Class - %u RSSI - %d", TAG, __func__, SightingTable::FormatMac(sighting.mac).c_str(),
+        static_cast<unsigned>(deviceClass.major_device_class), sighting.rssi);
+  }
+  Log("%s%s %zu Devices, %zu Nearby", TAG, __func__, devices.size(), sightings.size());
 }
 
 void Menu::PrintProperties()
@@ -193,17 +192,22 @@ void Menu::PrintProperties()
   Log("Class: %d", properties.Class);
   Log("Paired: %d", properties.Paired);
   Log("Connected: %d", properties.Connected);
+  DeviceProximity proximity = m_device->GetProximity();
+  if (proximity.samples > 0)
+  {
+    Log("RSSI: %d dBm (smoothed %.1f dBm, ~%.1f m)", proximity.rssi, proximity.smoothedRssi, proximity.distanceM);
+  }
   int i = 1;
-  for (auto uuid : properties.UUIDs)
+  for (const auto &uuid : properties.UUIDs)
   {
-    try
+    const char *description = UuidSet::Describe(uuid);
+    if (description)
     {
-      auto it = UUIDDescription.at(uuid);
-      Log("%d UUID: %s - %s", i++, LOG_STRING(uuid), LOG_STRING(it));
+      Log("%d UUID: %s - %s", i++, uuid.ToString().c_str(), description);
     }
-    catch (std::out_of_range &e)
+    else
     {
-      Log("%d UUID: %s", i++, LOG_STRING(uuid));
+      Log("%d UUID: %s", i++, uuid.ToString().c_str());
     }
   }
 }
@@ -211,19 +215,28 @@ void Menu::PrintProperties()
 void Menu::AutoConnectSPP()
 {
   Log("%s%s", TAG,__func__);
-  auto devices_mac = GetDevicesMac();
-  for (auto mac : devices_mac) {
-    auto device = m_application->GetDeviceManager().GetDevice(mac);
-    if (!device)
-    {
-      Log("Device is null");
-      continue;
-    }
-    DeviceProperties properties = device->GetProperties();
-    if (properties.Paired && IsSPPAvailable(properties.UUIDs))
+  if (!m_application) {
+    return;
+  }
+  DeviceQuery query{};
+  query.paired = true;
+  query.anyUuid = autoConnectProfiles;
+  auto matches = m_application->GetDeviceManager().QueryDevices(query);
+  // Closest devices first; far ones are the likeliest to fail
+  std::vector<std::pair<DeviceProximity, std::shared_ptr<IDevice>>> ranked;
+  ranked.reserve(matches.size());
+  for (const auto &match : matches) {
+    ranked.emplace_back(match.device->GetProximity(), match.device);
+  }
+  std::stable_sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b) {
+    if ((a.first.samples == 0) != (b.first.samples == 0))
     {
-      device->ConnectProfile(SPP_UUID);
+      return b.first.samples == 0;
     }
+    return a.first.smoothedRssi > b.first.smoothedRssi;
+  });
+  for (const auto &entry : ranked) {
+    entry.second->ConnectProfile(SPP_UUID);
   }
 }
 
@@ -327,6 +340,29 @@ void Menu::CancelPairing()
   m_device->CancelPairing();
 }
 
+void Menu::LifecycleStats()
+{
+  Log("%s%s", TAG,__func__);
+  if (m_device)
+  {
+    Log("%s", m_device->GetLifecycleReport().c_str());
+  }
+  Log("%s", m_application->GetDeviceManager().GetLifecycleReport().c_str());
+}
+
+void Menu::DumpTrace()
+{
+  Log("%s%s", TAG,__func__);
+  std::string path = "bluezeg-trace-" + std::to_string(time(nullptr)) + ".json";
+  long events = Trace::DumpChromeJson(path);
+  if (events < 0)
+  {
+    Log("%s%s Failed to write %s", TAG, __func__, path.c_str());
+    return;
+  }
+  Log("%s%s Wrote %ld events to %s", TAG, __func__, events, path.c_str());
+}
+
 void Menu::StopApplication()
 {
   Log("%s%s", TAG,__func__);
@@ -357,13 +393,3 @@ std::vector<std::string> Menu::GetDevicesMac()
   }
   return devices_mac;
 }
-
-bool Menu::IsSPPAvailable(std::vector<std::string> UUIDs)
-{
-  bool out = false;
-  auto it = std::find_if(UUIDs.begin(), UUIDs.end(), [](const std::string &u) { return u == SPP_UUID; });
-  if (it != UUIDs.end()) {
-    out = true;
-  }
-  return out;
-}
@@ -113,6 +113,16 @@ public:
    * @brief Cancel ongoing pairing operation
    */
   void CancelPairing();
+
+  /**
+   * @brief Print lifecycle timings of the selected device and of all devices
+   */
+  void LifecycleStats();
+
+  /**
+   * @brief Write the buffered trace spans to a Chrome trace JSON file
+   */
+  void DumpTrace();
   
   /**
    * @brief Stop the application gracefully
@@ -138,13 +148,6 @@ private:
    */
   std::vector<std::string> GetDevicesMac();
   
-  /**
-   * @brief Check if Serial Port Profile is available in UUID list
-   * @param UUIDs Vector of service UUIDs to check
-   * @return True if SPP UUID is found, false otherwise
-   */
-  bool IsSPPAvailable(std::vector<std::string> UUIDs);
-  
 private:
   std::shared_ptr<Application> m_application; ///< Reference to main application instance
   std::shared_ptr<IDevice> m_device;          ///< Currently selected device for operations
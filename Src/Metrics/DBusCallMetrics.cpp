@@ -0,0 +1,34 @@
+/**
+ * @file DBusCallMetrics.cpp
+ * @brief Implementation of the D-Bus call metrics
+ * @author Gokul
+ * @date 2025
+ */
+
+#include "DBusCallMetrics.h"
+
+std::atomic<bool> DBusCallSite::s_enabled{false};
+
+DBusCallSite::DBusCallSite(const char *interface, const char *method)
+    : m_method(method),
+      m_labels(MetricsRegistry::Label("interface", interface) + "," + MetricsRegistry::Label("method", method)),
+      m_latency(MetricsRegistry::Instance().GetHistogram("bluezeg_dbus_call_duration_seconds",
+                                                         "Round-trip time of D-Bus calls to bluetoothd", m_labels)),
+      m_inFlight(MetricsRegistry::Instance().GetGauge("bluezeg_dbus_calls_in_flight",
+                                                      "D-Bus calls waiting for a reply", m_labels))
+{
+}
+
+void DBusCallSite::Enable(bool enabled)
+{
+  s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void DBusCallSite::CountError(const std::string &name)
+{
+  // Failures are rare next to the round trip, so the lookup is not cached
+  MetricsRegistry::Instance()
+      .GetCounter("bluezeg_dbus_call_errors_total", "Failed D-Bus calls by error name",
+                  m_labels + "," + MetricsRegistry::Label("error", name))
+      .Add();
+}
@@ -0,0 +1,116 @@
+/**
+ * @file DBusCallMetrics.h
+ * @brief Latency, error and in-flight metrics around blocking D-Bus calls
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include <sdbus-c++/sdbus-c++.h>
+
+#include "Metrics.h"
+#include "Trace.h"
+
+/**
+ * @def DBUS_CALL(interface, method, expr)
+ * @brief Run a proxy call and record it under the given interface and method labels
+ *
+ * Each expansion owns a function-local DBusCallSite, so the series are
+ * looked up once per call site. Use "Get:<Property>" and "Set:<Property>"
+ * as the method of property accesses.
+ *
+ * @param interface D-Bus interface name
+ * @param method Method or property access being called
+ * @param expr Call expression; its result is returned
+ */
+#define DBUS_CALL(interface, method, expr)                                   \
+  ([&]() -> decltype(auto) {                                                 \
+    static DBusCallSite dbusCallSite(interface, method);                     \
+    return dbusCallSite.Run([&]() -> decltype(auto) { return expr; });       \
+  }())
+
+/**
+ * @class DBusCallSite
+ * @brief Metric series of one D-Bus method or property access
+ *
+ * Records the round-trip time, the number of calls currently blocked on
+ * bluetoothd and the failures by sdbus::Error name. Recording is off
+ * until Enable() is called; while off, a call costs one relaxed load on
+ * top of the proxy call itself. Each call is also a "dbus" trace span.
+ */
+class DBusCallSite
+{
+public:
+  /**
+   * @brief Construct a new DBus Call Site object
+   * @param interface D-Bus interface name
+   * @param method Method or property access
+   */
+  DBusCallSite(const char *interface, const char *method);
+
+  /**
+   * @brief Run a call, recording it when enabled
+   * @param call Callable performing the D-Bus call
+   * @return Result of the call; sdbus::Error is counted and rethrown
+   */
+  template <typename Call>
+  decltype(auto) Run(Call &&call)
+  {
+    TraceScope scope("dbus", m_method);
+    if (!s_enabled.load(std::memory_order_relaxed))
+    {
+      return call();
+    }
+    Timer timer(*this);
+    try
+    {
+      return call();
+    }
+    catch (const sdbus::Error &e)
+    {
+      CountError(e.getName());
+      throw;
+    }
+  }
+
+  /**
+   * @brief Turn recording on or off for every call site
+   * @param enabled True to record
+   */
+  static void Enable(bool enabled);
+
+private:
+  /**
+   * @struct Timer
+   * @brief Tracks one call while it is in flight
+   */
+  struct Timer
+  {
+    explicit Timer(DBusCallSite &site) : site(site), start(std::chrono::steady_clock::now()) { site.m_inFlight.Add(1); }
+    ~Timer()
+    {
+      site.m_inFlight.Add(-1);
+      site.m_latency.Record(
+          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+    DBusCallSite &site;                           ///< Call site being timed
+    std::chrono::steady_clock::time_point start;  ///< Time the call started
+  };
+
+  /**
+   * @brief Count a failed call
+   * @param name D-Bus error name
+   */
+  void CountError(const std::string &name);
+
+  std::string m_method;       ///< Method or property access, used as the trace span name
+  std::string m_labels;       ///< interface and method label set
+  LatencyHistogram &m_latency; ///< Round-trip time of completed and failed calls
+  Gauge &m_inFlight;          ///< Calls currently waiting for a reply
+  static std::atomic<bool> s_enabled; ///< Recording switch shared by all call sites
+};
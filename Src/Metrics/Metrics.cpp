@@ -0,0 +1,209 @@
+/**
+ * @file Metrics.cpp
+ * @brief Implementation of the metrics registry and text exposition
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <stdexcept>
+
+#include "Metrics.h"
+
+namespace
+{
+/**
+ * @brief Append one sample line
+ * @param out Exposition text being built
+ * @param name Series name including any suffix
+ * @param labels Label set without braces, may be empty
+ * @param value Formatted value
+ */
+void AppendSample(std::string &out, const std::string &name, const std::string &labels, const char *value)
+{
+  out += name;
+  if (!labels.empty())
+  {
+    out += '{';
+    out += labels;
+    out += '}';
+  }
+  out += ' ';
+  out += value;
+  out += '\n';
+}
+
+/**
+ * @brief Get the exposition name of a metric type
+ * @param type Metric type
+ * @return Type keyword for the # TYPE line
+ */
+const char *TypeName(MetricType type)
+{
+  switch (type)
+  {
+  case MetricType::Counter:
+    return "counter";
+  case MetricType::Gauge:
+    return "gauge";
+  case MetricType::Histogram:
+    return "histogram";
+  }
+  return "untyped";
+}
+} // namespace
+
+void Counter::Expose(std::string &out, const std::string &name, const std::string &labels) const
+{
+  char value[32];
+  snprintf(value, sizeof(value), "%" PRIu64, Value());
+  AppendSample(out, name, labels, value);
+}
+
+void Gauge::Expose(std::string &out, const std::string &name, const std::string &labels) const
+{
+  char value[32];
+  snprintf(value, sizeof(value), "%" PRId64, Value());
+  AppendSample(out, name, labels, value);
+}
+
+void LatencyHistogram::Expose(std::string &out, const std::string &name, const std::string &labels) const
+{
+  std::string bucketName = name + "_bucket";
+  std::string prefix = labels.empty() ? "" : labels + ",";
+  char value[32];
+  uint64_t cumulative = 0;
+  // The last bucket also holds everything above its range, so it is only reported as +Inf
+  for (int i = 0; i < HISTOGRAM_BUCKETS - 1; ++i)
+  {
+    cumulative += m_buckets[i].load(std::memory_order_relaxed);
+    char le[48];
+    snprintf(le, sizeof(le), "le=\"%.9g\"", static_cast<double>(uint64_t(2) << i) / 1e6);
+    snprintf(value, sizeof(value), "%" PRIu64, cumulative);
+    AppendSample(out, bucketName, prefix + le, value);
+  }
+  uint64_t count = Count();
+  snprintf(value, sizeof(value), "%" PRIu64, count);
+  AppendSample(out, bucketName, prefix + "le=\"+Inf\"", value);
+  snprintf(value, sizeof(value), "%.6f", m_sumUs.load(std::memory_order_relaxed) / 1e6);
+  AppendSample(out, name + "_sum", labels, value);
+  snprintf(value, sizeof(value), "%" PRIu64, count);
+  AppendSample(out, name + "_count", labels, value);
+}
+
+MetricsRegistry &MetricsRegistry::Instance()
+{
+  // Leaked on purpose: objects destroyed during exit may still update metrics
+  static MetricsRegistry *registry = new MetricsRegistry();
+  return *registry;
+}
+
+std::unique_ptr<Metric> &MetricsRegistry::Slot(const std::string &name, const std::string &help, MetricType type,
+                                               const std::string &labels)
+{
+  auto it = m_families.find(name);
+  if (it == m_families.end())
+  {
+    it = m_families.emplace(name, Family{help, type, {}}).first;
+  }
+  else if (it->second.type != type)
+  {
+    throw std::invalid_argument("Metric " + name + " registered with another type");
+  }
+  return it->second.series[labels];
+}
+
+Counter &MetricsRegistry::GetCounter(const std::string &name, const std::string &help, const std::string &labels)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto &slot = Slot(name, help, MetricType::Counter, labels);
+  if (!slot)
+  {
+    slot = std::make_unique<Counter>();
+  }
+  return static_cast<Counter &>(*slot);
+}
+
+Gauge &MetricsRegistry::GetGauge(const std::string &name, const std::string &help, const std::string &labels)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto &slot = Slot(name, help, MetricType::Gauge, labels);
+  if (!slot)
+  {
+    slot = std::make_unique<Gauge>();
+  }
+  return static_cast<Gauge &>(*slot);
+}
+
+void MetricsRegistry::SetGaugeCallback(const std::string &name, const std::string &help, std::function<int64_t()> sample,
+                                       const std::string &labels)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Slot(name, help, MetricType::Gauge, labels) = std::make_unique<Gauge>(std::move(sample));
+}
+
+LatencyHistogram &MetricsRegistry::GetHistogram(const std::string &name, const std::string &help, const std::string &labels)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto &slot = Slot(name, help, MetricType::Histogram, labels);
+  if (!slot)
+  {
+    slot = std::make_unique<LatencyHistogram>();
+  }
+  return static_cast<LatencyHistogram &>(*slot);
+}
+
+void MetricsRegistry::Remove(const std::string &name, const std::string &labels)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_families.find(name);
+  if (it == m_families.end())
+  {
+    return;
+  }
+  it->second.series.erase(labels);
+  if (it->second.series.empty())
+  {
+    m_families.erase(it);
+  }
+}
+
+std::string MetricsRegistry::Expose() const
+{
+  std::string out;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto &family : m_families)
+  {
+    out += "# HELP " + family.first + " " + family.second.help + "\n";
+    out += "# TYPE " + family.first + " " + TypeName(family.second.type) + "\n";
+    for (const auto &series : family.second.series)
+    {
+      series.second->Expose(out, family.first, series.first);
+    }
+  }
+  return out;
+}
+
+std::string MetricsRegistry::Label(const std::string &key, const std::string &value)
+{
+  std::string label = key + "=\"";
+  for (char c : value)
+  {
+    if (c == '\\' || c == '"')
+    {
+      label += '\\';
+      label += c;
+    }
+    else if (c == '\n')
+    {
+      label += "\\n";
+    }
+    else
+    {
+      label += c;
+    }
+  }
+  label += '"';
+  return label;
+}
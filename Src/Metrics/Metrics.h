@@ -0,0 +1,229 @@
+/**
+ * @file Metrics.h
+ * @brief Process-wide counters, gauges and latency histograms
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "Histogram.h"
+
+/**
+ * @enum MetricType
+ * @brief Kind of a metric family in the text exposition format
+ */
+enum class MetricType
+{
+  Counter,  ///< Monotonic total
+  Gauge,    ///< Value that goes up and down
+  Histogram ///< Latency distribution
+};
+
+/**
+ * @class Metric
+ * @brief One labelled series of a metric family
+ */
+class Metric
+{
+public:
+  virtual ~Metric() = default;
+
+  /**
+   * @brief Append the sample lines of this series
+   * @param out Exposition text being built
+   * @param name Family name
+   * @param labels Label set without braces, may be empty
+   */
+  virtual void Expose(std::string &out, const std::string &name, const std::string &labels) const = 0;
+};
+
+/**
+ * @class Counter
+ * @brief Monotonic total; updates are a single relaxed atomic add
+ */
+class Counter : public Metric
+{
+public:
+  void Add(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); } ///< Increase the total
+  uint64_t Value() const { return m_value.load(std::memory_order_relaxed); }    ///< Current total
+
+  void Expose(std::string &out, const std::string &name, const std::string &labels) const override;
+
+private:
+  std::atomic<uint64_t> m_value{0}; ///< Total
+};
+
+/**
+ * @class Gauge
+ * @brief Value that goes up and down, either stored or sampled at scrape time
+ */
+class Gauge : public Metric
+{
+public:
+  Gauge() = default;
+
+  /**
+   * @brief Construct a gauge whose value is read when scraped
+   * @param sample Returns the current value; called on the metrics server thread
+   */
+  explicit Gauge(std::function<int64_t()> sample) : m_sample(std::move(sample)) {}
+
+  void Set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }  ///< Replace the value
+  void Add(int64_t n) { m_value.fetch_add(n, std::memory_order_relaxed); }      ///< Move the value by n
+  int64_t Value() const { return m_sample ? m_sample() : m_value.load(std::memory_order_relaxed); } ///< Current value
+
+  void Expose(std::string &out, const std::string &name, const std::string &labels) const override;
+
+private:
+  std::atomic<int64_t> m_value{0};   ///< Stored value
+  std::function<int64_t()> m_sample; ///< Scrape-time source, empty for stored gauges
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief Lock-free counterpart of Histogram for concurrent recording
+ *
+ * Uses the same power-of-two microsecond buckets. Each sample is three
+ * relaxed atomic adds, so a scrape may see a count one ahead of the
+ * buckets; that skew is accepted by the exposition format.
+ */
+class LatencyHistogram : public Metric
+{
+public:
+  /**
+   * @brief Record a sample
+   * @param us Duration in microseconds
+   */
+  void Record(uint64_t us)
+  {
+    int bucket = us ? std::bit_width(us) - 1 : 0;
+    m_buckets[std::min(bucket, HISTOGRAM_BUCKETS - 1)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumUs.fetch_add(us, std::memory_order_relaxed);
+  }
+
+  uint64_t Count() const { return m_count.load(std::memory_order_relaxed); } ///< Number of samples
+
+  void Expose(std::string &out, const std::string &name, const std::string &labels) const override;
+
+private:
+  std::atomic<uint64_t> m_buckets[HISTOGRAM_BUCKETS] = {}; ///< Sample count per power-of-two bucket
+  std::atomic<uint64_t> m_count{0};                        ///< Number of samples
+  std::atomic<uint64_t> m_sumUs{0};                        ///< Sum of all samples
+};
+
+/**
+ * @class MetricsRegistry
+ * @brief Named metric families rendered in the Prometheus text format
+ *
+ * Looking a metric up takes a mutex, so callers fetch the reference once
+ * (in a constructor or a function-local static) and update it lock-free
+ * afterwards. References stay valid until Remove() is called for the
+ * series. Series are identified by family name plus a label set such as
+ * `method="Connect"`; build label values with Label() so they are escaped.
+ */
+class MetricsRegistry
+{
+public:
+  /**
+   * @brief Get the process-wide registry
+   * @return Registry; never destroyed, so it is safe to use during exit
+   */
+  static MetricsRegistry &Instance();
+
+  /**
+   * @brief Get or create a counter
+   * @param name Family name
+   * @param help One-line description of the family
+   * @param labels Label set, empty for an unlabelled series
+   * @return Counter
+   */
+  Counter &GetCounter(const std::string &name, const std::string &help, const std::string &labels = "");
+
+  /**
+   * @brief Get or create a stored gauge
+   * @param name Family name
+   * @param help One-line description of the family
+   * @param labels Label set, empty for an unlabelled series
+   * @return Gauge
+   */
+  Gauge &GetGauge(const std::string &name, const std::string &help, const std::string &labels = "");
+
+  /**
+   * @brief Create or replace a gauge sampled at scrape time
+   * @param name Family name
+   * @param help One-line description of the family
+   * @param sample Returns the current value; must stay callable until Remove()
+   * @param labels Label set, empty for an unlabelled series
+   */
+  void SetGaugeCallback(const std::string &name, const std::string &help, std::function<int64_t()> sample,
+                        const std::string &labels = "");
+
+  /**
+   * @brief Get or create a latency histogram
+   * @param name Family name
+   * @param help One-line description of the family
+   * @param labels Label set, empty for an unlabelled series
+   * @return Histogram
+   */
+  LatencyHistogram &GetHistogram(const std::string &name, const std::string &help, const std::string &labels = "");
+
+  /**
+   * @brief Drop a series; references to it become invalid
+   * @param name Family name
+   * @param labels Label set of the series
+   */
+  void Remove(const std::string &name, const std::string &labels = "");
+
+  /**
+   * @brief Render every series
+   * @return Text exposition format, version 0.0.4
+   */
+  std::string Expose() const;
+
+  /**
+   * @brief Format one label pair with the value escaped
+   * @param key Label name
+   * @param value Label value
+   * @return key="value"
+   */
+  static std::string Label(const std::string &key, const std::string &value);
+
+private:
+  MetricsRegistry() = default;
+
+  /**
+   * @struct Family
+   * @brief Series sharing a name, help text and type
+   */
+  typedef struct
+  {
+    std::string help;                                      ///< Description
+    MetricType type;                                       ///< Kind of every series
+    std::map<std::string, std::unique_ptr<Metric>> series; ///< Series by label set
+  } Family;
+
+  /**
+   * @brief Find or create a series; caller holds m_mutex
+   * @param name Family name
+   * @param help Description used when the family is created
+   * @param type Expected family type
+   * @param labels Label set
+   * @return Slot holding the series, null when newly created
+   */
+  std::unique_ptr<Metric> &Slot(const std::string &name, const std::string &help, MetricType type,
+                                const std::string &labels);
+
+  mutable std::mutex m_mutex;             ///< Protects m_families, not the metric values
+  std::map<std::string, Family> m_families; ///< Families by name
+};
@@ -0,0 +1,186 @@
+/**
+ * @file MetricsServer.cpp
+ * @brief Implementation of the Unix socket metrics endpoint
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "MetricsServer.h"
+
+#include "Logger.h"
+#include "Metrics.h"
+
+#define TAG "MetricsServer::"         ///< Tag for logging messages
+#define METRICS_LISTEN_BACKLOG 8      ///< Pending connections before new ones are refused
+#define METRICS_REQUEST_WAIT_MS 100   ///< Time a client has to send a request before plain text is sent
+#define METRICS_SEND_TIMEOUT_SEC 2    ///< Time a stalled client may block a scrape
+
+MetricsServer::MetricsServer(std::string path) : m_path(std::move(path)),
+                                                 m_running(false)
+{
+  Log("%s%s Path - %s", TAG, __func__, LOG_STRING(m_path));
+}
+
+MetricsServer::~MetricsServer()
+{
+  Log("%s%s", TAG, __func__);
+  m_running = false;
+  if (m_wakeFd >= 0)
+  {
+    uint64_t one = 1;
+    if (write(m_wakeFd, &one, sizeof(one)) < 0)
+    {
+      Log("%s%s Error: Writing eventfd, Error - %s", TAG, __func__, strerror(errno));
+    }
+  }
+  if (m_eventLoopThread.joinable())
+  {
+    m_eventLoopThread.join();
+  }
+  if (m_listenFd >= 0)
+  {
+    close(m_listenFd);
+    unlink(m_path.c_str());
+  }
+  if (m_wakeFd >= 0)
+  {
+    close(m_wakeFd);
+  }
+}
+
+bool MetricsServer::Start()
+{
+  struct sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if (m_path.empty() || m_path.size() >= sizeof(addr.sun_path))
+  {
+    Log("%s%s Error: Invalid socket path - %s", TAG, __func__, LOG_STRING(m_path));
+    return false;
+  }
+  memcpy(addr.sun_path, m_path.c_str(), m_path.size());
+
+  m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (m_wakeFd < 0 || m_listenFd < 0)
+  {
+    Log("%s%s Error: Creating socket, Error - %s", TAG, __func__, strerror(errno));
+    return false;
+  }
+  // A socket left by an earlier run would make bind fail; anything else at the path is not ours to delete
+  struct stat st = {};
+  if (lstat(m_path.c_str(), &st) == 0)
+  {
+    if (!S_ISSOCK(st.st_mode))
+    {
+      Log("%s%s Error: %s exists and is not a socket", TAG, __func__, LOG_STRING(m_path));
+      close(m_listenFd);
+      m_listenFd = -1;
+      return false;
+    }
+    unlink(m_path.c_str());
+  }
+  if (bind(m_listenFd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      listen(m_listenFd, METRICS_LISTEN_BACKLOG) < 0)
+  {
+    Log("%s%s Error: Binding %s, Error - %s", TAG, __func__, LOG_STRING(m_path), strerror(errno));
+    close(m_listenFd);
+    m_listenFd = -1;
+    return false;
+  }
+  m_running = true;
+  try
+  {
+    m_eventLoopThread = std::thread(&MetricsServer::RunEventLoop, this);
+  }
+  catch (const std::system_error &e)
+  {
+    Log("%s%s Error - %s", TAG, __func__, e.what());
+    m_running = false;
+    return false;
+  }
+  Log("%s%s Serving metrics on %s", TAG, __func__, LOG_STRING(m_path));
+  return true;
+}
+
+void MetricsServer::RunEventLoop()
+{
+  Log("%s%s", TAG, __func__);
+  struct pollfd fds[2] = {{m_listenFd, POLLIN, 0}, {m_wakeFd, POLLIN, 0}};
+  while (m_running)
+  {
+    if (poll(fds, 2, -1) < 0)
+    {
+      if (errno != EINTR)
+      {
+        Log("%s%s Error: poll, Error - %s", TAG, __func__, strerror(errno));
+      }
+      continue;
+    }
+    if (!m_running || (fds[1].revents & POLLIN))
+    {
+      break;
+    }
+    if (fds[0].revents & POLLIN)
+    {
+      int client = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+      if (client < 0)
+      {
+        Log("%s%s Error: accept, Error - %s", TAG, __func__, strerror(errno));
+        continue;
+      }
+      Serve(client);
+    }
+  }
+  Log("%s%s Exiting RunEventLoop", TAG, __func__);
+}
+
+void MetricsServer::Serve(int client)
+{
+  struct timeval timeout = {METRICS_SEND_TIMEOUT_SEC, 0};
+  setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  // HTTP clients speak first; raw clients just read
+  bool http = false;
+  struct pollfd pfd = {client, POLLIN, 0};
+  if (poll(&pfd, 1, METRICS_REQUEST_WAIT_MS) > 0 && (pfd.revents & POLLIN))
+  {
+    char request[1024];
+    ssize_t len = recv(client, request, sizeof(request), MSG_DONTWAIT);
+    http = len >= 4 && memcmp(request, "GET ", 4) == 0;
+  }
+
+  std::string body = MetricsRegistry::Instance().Expose();
+  std::string response;
+  if (http)
+  {
+    response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+  }
+  response += body;
+
+  size_t offset = 0;
+  while (offset < response.size())
+  {
+    ssize_t sent = send(client, response.data() + offset, response.size() - offset, MSG_NOSIGNAL);
+    if (sent < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      Log("%s%s Error: Sending scrape, Error - %s", TAG, __func__, strerror(errno));
+      break;
+    }
+    offset += sent;
+  }
+  close(client);
+}
@@ -0,0 +1,62 @@
+/**
+ * @file MetricsServer.h
+ * @brief Serves the metrics registry on a local Unix socket
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+/**
+ * @class MetricsServer
+ * @brief Answers each connection on a Unix stream socket with a metrics scrape
+ *
+ * A client that sends an HTTP request (for example
+ * `curl --unix-socket <path> http://localhost/metrics`) gets an HTTP/1.0
+ * response; any other client (for example `socat - UNIX-CONNECT:<path>`)
+ * gets the bare exposition text. The connection is closed after one
+ * scrape. Connections are served one at a time on a single poll loop, so a
+ * slow scraper never touches the Bluetooth threads.
+ */
+class MetricsServer
+{
+public:
+  /**
+   * @brief Construct a new Metrics Server object
+   * @param path Filesystem path of the socket; an existing socket there is replaced
+   */
+  explicit MetricsServer(std::string path);
+
+  /**
+   * @brief Stop serving and remove the socket
+   */
+  ~MetricsServer();
+
+  /**
+   * @brief Bind the socket and start the serving thread
+   * @return False if the socket could not be created
+   */
+  bool Start();
+
+private:
+  /**
+   * @brief Accept and serve connections until stopped
+   */
+  void RunEventLoop();
+
+  /**
+   * @brief Send one scrape to a client and close it
+   * @param client Accepted connection
+   */
+  void Serve(int client);
+
+  std::string m_path;           ///< Socket path
+  int m_listenFd = -1;          ///< Listening socket
+  int m_wakeFd = -1;            ///< eventfd waking the loop on shutdown
+  std::atomic<bool> m_running;  ///< Flag to control event loop execution
+  std::thread m_eventLoopThread; ///< Thread serving connections
+};
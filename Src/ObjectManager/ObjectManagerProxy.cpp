@@ -1,9 +1,13 @@
 #include "ObjectManagerProxy.h"
 
 #include "Logger.h"
+#include "DispatchWatchdog.h"
 #include "DeviceHelper.h"
+#include "DeviceProxy.h"
+#include "Trace.h"
 
 #define TAG "ObjectManagerProxy::"
+#define INTERFACE_QUEUE_CAPACITY 1024 ///< InterfacesAdded signals queued before the bus thread drops them
 
 
 const std::string OBJECT_MANAGER_WELLKNOWN_NAME = "org.bluez";
@@ -16,6 +20,9 @@ ObjectManagerProxy::ObjectManagerProxy(sdbus::IConnection& connection, IDeviceMa
 m_running(true),
 m_connection(connection),
 m_deviceManager(deviceManager),
+m_interface_added_queue(INTERFACE_QUEUE_CAPACITY),
+m_queueDepth(MetricsRegistry::Instance().GetGauge("bluezeg_interfaces_queue_depth", "InterfacesAdded signals waiting to be processed")),
+m_queueDrops(MetricsRegistry::Instance().GetCounter("bluezeg_interfaces_queue_dropped_total", "InterfacesAdded signals dropped on a full queue")),
 ProxyInterfaces(connection, sdbus::ServiceName(OBJECT_MANAGER_WELLKNOWN_NAME), sdbus::ObjectPath(OBJECT_MANAGER_INTERFACE_OBJECT_PATH))
 {
   Log("%s%s", TAG,__func__);
@@ -25,11 +32,8 @@ ObjectManagerProxy::~ObjectManagerProxy()
 {
   Log("%s%s", TAG,__func__);
   unregisterProxy();
-  {
-    std::lock_guard<std::mutex> lock(m_obj_manager_mutex);
-    m_running = false;
-  }
-  m_queueCV.notify_one();
+  m_running = false;
+  m_interface_added_queue.Close();
   if(m_eventLoopThread.joinable()){
     m_eventLoopThread.join();
   }
@@ -45,20 +49,29 @@ void ObjectManagerProxy::StartLooping()
 void ObjectManagerProxy::onInterfacesAdded( const sdbus::ObjectPath& objectPath,
       const std::map<sdbus::InterfaceName,  std::map<sdbus::PropertyName, sdbus::Variant>>& interfacesAndProperties)
 {
+  WATCHDOG_HANDLER("ObjectManagerProxy::onInterfacesAdded");
   Log("%s%s Object Path - %s", TAG, __func__, LOG_STRING(std::string(objectPath)));
-  std::lock_guard<std::mutex> lock(m_obj_manager_mutex);
-  m_interface_added_queue.push({objectPath, interfacesAndProperties});
-  bool toAdd = false;
-  m_queueCV.notify_one();
+  // Count before publishing so the consumer never takes the depth below zero
+  m_queueDepth.Add(1);
+  uint64_t flowId = Trace::NewFlowId();
+  Trace::FlowStart("discovery", __func__, flowId);
+  if (!m_interface_added_queue.TryPush({objectPath, interfacesAndProperties, flowId}))
+  {
+    m_queueDepth.Add(-1);
+    m_queueDrops.Add();
+    Log("%s%s Error: Queue full, dropping Object Path - %s", TAG, __func__, LOG_STRING(std::string(objectPath)));
+    return;
+  }
 }
 
 void ObjectManagerProxy::onInterfacesRemoved( const sdbus::ObjectPath& objectPath,const std::vector<sdbus::InterfaceName>& interfaces)
 {
+  WATCHDOG_HANDLER("ObjectManagerProxy::onInterfacesRemoved");
   Log("%s%s Object Path - %s", TAG, __func__, LOG_STRING(objectPath));
   for (const auto& interface : interfaces)
   {
     if(DEVICE_INTERFACE == interface) {
-      m_deviceManager.DeviceRemoved(std::string(interface));
+      m_deviceManager.DeviceRemoved(std::string(objectPath));
     }
   }
 }
@@ -66,42 +79,33 @@ void ObjectManagerProxy::onInterfacesRemoved( const sdbus::ObjectPath& objectPat
 void ObjectManagerProxy::RunEventLoop()
 {
   Log("%s%s", TAG,__func__);
+  Trace::SetThreadName("ObjectManager");
   while(m_running) {
-    std::unique_lock<std::mutex> lock(m_obj_manager_mutex);
-    m_queueCV.wait(lock, [this] { return !m_running || !m_interface_added_queue.empty(); });
-    
+    m_interface_added_queue.Wait();
+
     if(!m_running) {
       Log("%s%s Exiting RunEventLoop", TAG,__func__);
       break;
     }
-    if (!m_interface_added_queue.empty()) {
-      auto interfaceAdded = m_interface_added_queue.front();
-      m_interface_added_queue.pop();
-      lock.unlock();
+    // Drain everything queued since the last wakeup
+    InterfaceAddedStruct interfaceAdded;
+    while (m_interface_added_queue.TryPop(interfaceAdded)) {
+      m_queueDepth.Add(-1);
+      TRACE_SCOPE_FLOW("discovery", "InterfacesAdded", interfaceAdded.flowId);
       for (const auto& interface : interfaceAdded.interfacesAndProperties)
       {
         Log("%s%s Interface - %s", TAG,__func__, LOG_STRING(interface.first));
         if(DEVICE_INTERFACE == interface.first) {
-          if(GetAndValidateClass(interface.second)) {
-            m_deviceManager.DeviceAdded(std::string(interfaceAdded.path), false);
+          DeviceProperties properties = DeviceProxy::ParseProperties(interface.second);
+          // Admit devices we already have a bond or link with; others are only sighted
+          if((properties.Paired || properties.Connected) && GetAndValidateClass(interface.second)) {
+            m_deviceManager.DeviceAdded(std::string(interfaceAdded.path), false, properties);
+          } else {
+            m_deviceManager.DeviceSighted(std::string(interfaceAdded.path), properties, GetRSSI(interface.second));
           }
         }
       }
-      lock.lock();
     }
-
-    // if (!m_interface_removed_queue.empty()) {
-    //   auto interfaceRemoved = m_interface_removed_queue.front();
-    //   m_interface_removed_queue.pop();
-    //   lock.unlock();
-    //   for (const auto& interface : interfaceRemoved.interfaces)
-    //   {
-    //     if(DEVICE_INTERFACE == interface) {
-    //       m_deviceManager.DeviceRemoved(std::string(interfaceRemoved.path));
-    //     }
-    //   }
-    // }
-    // lock.lock();
   }
 }
 
@@ -117,6 +121,23 @@ uint32_t ObjectManagerProxy::GetClass( std::map<sdbus::PropertyName, sdbus::Vari
   return device_class;
 }
 
+int16_t ObjectManagerProxy::GetRSSI(const std::map<sdbus::PropertyName, sdbus::Variant> &interfaces)
+{
+  int16_t rssi = SIGHTING_RSSI_UNKNOWN;
+  auto it = interfaces.find(sdbus::PropertyName(DEVICE_PROPERTY_RSSI));
+  if(it != interfaces.end()) {
+    try
+    {
+      rssi = it->second.get<int16_t>();
+    }
+    catch(const sdbus::Error& e)
+    {
+      Log("%s%s Error - %s", TAG,__func__, e.what());
+    }
+  }
+  return rssi;
+}
+
 bool ObjectManagerProxy::ValidateClass(uint32_t device_class)
 {
   bool valid = false;
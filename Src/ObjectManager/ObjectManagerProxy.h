@@ -9,14 +9,13 @@
 
 #include <thread>
 #include <atomic>
-#include <queue>
-#include <mutex>
-#include <condition_variable>
 #include <map>
 
 #include <sdbus-c++/sdbus-c++.h>
 
 #include "IDeviceManager.h"
+#include "MPSCQueue.h"
+#include "Metrics.h"
 
 /**
  * @struct InterfaceAddedStruct
@@ -27,6 +26,7 @@ typedef struct {
   std::map<sdbus::InterfaceName, ///< D-Bus object path
   std::map<sdbus::PropertyName,  ///< Property Name
   sdbus::Variant>> interfacesAndProperties;  ///< Interfaces and Properties Value
+  uint64_t flowId;                           ///< Trace flow from the bus thread to the event loop
 }InterfaceAddedStruct;
 
 /**
@@ -44,9 +44,10 @@ typedef struct {
  * 
  * This class monitors D-Bus objects managed by BlueZ, particularly focusing
  * on Device1 interfaces. It processes InterfacesAdded and InterfacesRemoved
- * signals to track device discovery and removal events. The class filters
- * devices based on their device class and forwards relevant events to
- * the device manager.
+ * signals to track device discovery and removal events. Devices that are
+ * already paired or connected and have an accepted device class are
+ * admitted to the device manager; every other device is only recorded as
+ * a sighting.
  */
 class ObjectManagerProxy : public sdbus::ProxyInterfaces<sdbus::ObjectManager_proxy>
 {
@@ -106,6 +107,13 @@ private:
    * @return Device class value (24-bit)
    */
   uint32_t GetClass(std::map<sdbus::PropertyName, sdbus::Variant> interfaces);
+
+  /**
+   * @brief Extract the RSSI from interface properties
+   * @param interfaces Map of interface properties
+   * @return RSSI in dBm, SIGHTING_RSSI_UNKNOWN if absent
+   */
+  int16_t GetRSSI(const std::map<sdbus::PropertyName, sdbus::Variant> &interfaces);
   
   /**
    * @brief Validate if device class is acceptable
@@ -126,8 +134,7 @@ private:
     IDeviceManager &m_deviceManager;                           ///< Reference to device manager
     std::atomic<bool> m_running;                               ///< Flag to control event loop execution
     std::thread m_eventLoopThread;                             ///< Thread for running the event loop
-    std::mutex m_obj_manager_mutex;                            ///< Mutex for thread-safe queue access
-    std::queue<InterfaceAddedStruct> m_interface_added_queue;  ///< Queue for interface addition events
-    std::queue<InterfaceRemovedStruct> m_interface_removed_queue; ///< Queue for interface removal events
-    std::condition_variable m_queueCV;                         ///< Condition variable for queue synchronization
+    MPSCQueue<InterfaceAddedStruct> m_interface_added_queue;   ///< Lock-free queue for interface addition events
+    Gauge &m_queueDepth;                                       ///< Events waiting in m_interface_added_queue
+    Counter &m_queueDrops;                                     ///< Events dropped because the queue was full
 };
@@ -1,17 +1,29 @@
 #include "ProfileProxy.h"
 
 #include "Logger.h"
+#include "DispatchWatchdog.h"
+#include "Trace.h"
 
 #define TAG "ProfileProxy::"
+#define SPP_CHUNK_SIZE 1024   ///< Size of each SPP buffer chunk
+#define SPP_CHUNK_COUNT 4096  ///< Chunks shared by all SPP connections (4 MiB)
 
 
-ProfileProxy::ProfileProxy(sdbus::IConnection &connection, std::string profilePath):
+ProfileProxy::ProfileProxy(sdbus::IConnection &connection, std::string profilePath, const SPPConfig &sppConfig):
 AdaptorInterfaces(connection, sdbus::ObjectPath(profilePath)),
 m_connection(connection),
 m_profilePath(profilePath),
+m_sppConfig(sppConfig),
+m_bufferPool(SPP_CHUNK_SIZE, SPP_CHUNK_COUNT),
+m_capture(nullptr),
+m_connectionCount(0),
 m_spp(nullptr)
 {
   Log("%s%s", TAG, __func__);
+  if (!m_sppConfig.capturePath.empty())
+  {
+    m_capture = std::make_unique<SPPCapture>(m_sppConfig.capturePath);
+  }
   registerAdaptor();
 }
 
@@ -23,6 +35,7 @@ ProfileProxy::~ProfileProxy()
 
 void ProfileProxy::Release()
 {
+  WATCHDOG_HANDLER("ProfileProxy::Release");
   Log("%s%s", TAG, __func__);
 
 }
@@ -31,11 +44,13 @@ void ProfileProxy::NewConnection(const sdbus::ObjectPath& device,
                      const sdbus::UnixFd& fd, 
                      const std::map<std::string, sdbus::Variant>& fd_properties)
 {
+  WATCHDOG_HANDLER("ProfileProxy::NewConnection");
   Log("%s%s Path - %s FD - %d", TAG, __func__, LOG_STRING(std::string(device)), fd.get());
+  TRACE_SCOPE("spp", __func__);
   for (auto properties : fd_properties) {
     Log("%s%s Properties - %s", TAG, __func__, LOG_STRING(properties.first));
   }
-  m_spp = std::make_unique<SPPHandler>(fd);
+  m_spp = std::make_unique<SPPHandler>(fd, m_bufferPool, m_sppConfig, m_capture.get(), ++m_connectionCount);
   if(m_spp) {
     m_spp->StartOperations();
   }
@@ -43,5 +58,6 @@ void ProfileProxy::NewConnection(const sdbus::ObjectPath& device,
 
 void ProfileProxy::RequestDisconnection(const sdbus::ObjectPath& device)
 {
+  WATCHDOG_HANDLER("ProfileProxy::RequestDisconnection");
   Log("%s%s Path - %s", TAG, __func__, LOG_STRING(std::string(device)));
 }
@@ -11,6 +11,8 @@
 
 #include "Profile1-adapter-generated.hpp"
 
+#include "BufferPool.h"
+#include "SPPConfig.h"
 #include "SPPHandler.h"
 
 /**
@@ -29,8 +31,9 @@ public:
    * @brief Construct a new Profile Proxy object
    * @param connection Reference to D-Bus system bus connection
    * @param profilePath D-Bus object path for this profile instance
+   * @param sppConfig Options applied to SPP connections
    */
-  ProfileProxy(sdbus::IConnection &connection, std::string profilePath);
+  ProfileProxy(sdbus::IConnection &connection, std::string profilePath, const SPPConfig &sppConfig);
   
   /**
    * @brief Destroy the Profile Proxy object and cleanup resources
@@ -72,5 +75,9 @@ protected:
 private:
   sdbus::IConnection &m_connection;       ///< Reference to D-Bus connection
   std::string m_profilePath;              ///< D-Bus object path for this profile
+  SPPConfig m_sppConfig;                  ///< Options applied to SPP connections
+  BufferPool m_bufferPool;                ///< Chunk pool shared by all SPP connections
+  std::unique_ptr<SPPCapture> m_capture;  ///< Traffic capture shared by all SPP connections, or null
+  uint32_t m_connectionCount;             ///< Connections accepted so far, used as capture ids
   std::unique_ptr<SPPHandler> m_spp;      ///< SPP connection handler
 };
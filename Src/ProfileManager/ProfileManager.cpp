@@ -18,11 +18,13 @@
  * the profile manager proxy for communication with BlueZ.
  * 
  * @param connection Reference to D-Bus system bus connection
+ * @param sppConfig Options applied to SPP connections of registered profiles
  */
-ProfileManager::ProfileManager(sdbus::IConnection &connection):
+ProfileManager::ProfileManager(sdbus::IConnection &connection, const SPPConfig &sppConfig):
 m_profileManagerProxy(connection),
 m_connection(connection),
-m_profileProxy(nullptr)
+m_profileProxy(nullptr),
+m_sppConfig(sppConfig)
 {
   Log("%s%s", TAG, __func__);
 }
@@ -40,7 +42,7 @@ void ProfileManager::RegisterProfile(const sdbus::ObjectPath& profile,
   try
   {
     m_profileManagerProxy.RegisterProfile(profile, UUID, options);
-    m_profileProxy = std::make_unique<ProfileProxy>(m_connection, profile);
+    m_profileProxy = std::make_unique<ProfileProxy>(m_connection, profile, m_sppConfig);
   }
   catch(const sdbus::Error& e)
   {
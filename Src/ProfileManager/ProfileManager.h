@@ -28,8 +28,9 @@ public:
   /**
    * @brief Construct a new Profile Manager object
    * @param connection Reference to D-Bus system bus connection
+   * @param sppConfig Options applied to SPP connections of registered profiles
    */
-  ProfileManager(sdbus::IConnection &connection);
+  ProfileManager(sdbus::IConnection &connection, const SPPConfig &sppConfig);
   
   /**
    * @brief Destroy the Profile Manager object and cleanup resources
@@ -60,4 +61,5 @@ private:
   sdbus::IConnection &m_connection;              ///< Reference to D-Bus connection
   ProfileManagerProxy m_profileManagerProxy;    ///< Proxy for BlueZ ProfileManager1 interface
   std::unique_ptr<ProfileProxy> m_profileProxy; ///< Profile implementation instance
+  SPPConfig m_sppConfig;                        ///< Options applied to SPP connections
 };
@@ -1,8 +1,10 @@
 #include "ProfileManagerProxy.h"
+#include "DBusCallMetrics.h"
 
 #include "Logger.h"
 
 #define TAG "ProfileManagerProxy::"
+#define PROFILE_MANAGER_INTERFACE_NAME "org.bluez.ProfileManager1" ///< Interface label of the call metrics
 
 const std::string PROFILE_MANAGER_WELLKNOWN_NAME = "org.bluez";
 const std::string PROFILE_MANAGER_INTERFACE_OBJECT_PATH = "/org/bluez";
@@ -26,11 +28,11 @@ void ProfileManagerProxy::RegisterProfile(const sdbus::ObjectPath& profile,
                        const std::map<std::string, sdbus::Variant>& options)
 {
   Log("%s%s Profile Path - %s, UUID - %s", TAG, __func__, LOG_STRING(profile), LOG_STRING(UUID));
-  org::bluez::ProfileManager1_proxy::RegisterProfile(profile, UUID, options);
+  DBUS_CALL(PROFILE_MANAGER_INTERFACE_NAME, "RegisterProfile", org::bluez::ProfileManager1_proxy::RegisterProfile(profile, UUID, options));
 }
 
 void ProfileManagerProxy::UnregisterProfile(const sdbus::ObjectPath& profile)
 {
   Log("%s%s Profile Path - %s", TAG, __func__, LOG_STRING(profile));
-  org::bluez::ProfileManager1_proxy::UnregisterProfile(profile);
+  DBUS_CALL(PROFILE_MANAGER_INTERFACE_NAME, "UnregisterProfile", org::bluez::ProfileManager1_proxy::UnregisterProfile(profile));
 }
@@ -0,0 +1,182 @@
+/**
+ * @file SPPCapture.cpp
+ * @brief Implementation of recording and reading SPP traffic captures
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <chrono>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SPPCapture.h"
+
+#include "Logger.h"
+
+#define TAG "SPPCapture::"                     ///< Tag for logging messages
+#define INITIAL_CAPTURE_SIZE (4 * 1024 * 1024) ///< Initial file size (4 MiB)
+
+SPPCapture::SPPCapture(const std::string &path) : m_path(path)
+{
+  Log("%s%s Path - %s", TAG, __func__, LOG_STRING(path));
+  m_fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (m_fd < 0)
+  {
+    Log("%s%s Error: Opening capture file, Error - %s", TAG, __func__, strerror(errno));
+    return;
+  }
+  if (ftruncate(m_fd, INITIAL_CAPTURE_SIZE) < 0)
+  {
+    Log("%s%s Error: Sizing capture file, Error - %s", TAG, __func__, strerror(errno));
+    return;
+  }
+  void *map = mmap(nullptr, INITIAL_CAPTURE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (map == MAP_FAILED)
+  {
+    Log("%s%s Error: Mapping capture file, Error - %s", TAG, __func__, strerror(errno));
+    return;
+  }
+  m_map = static_cast<char *>(map);
+  m_mapSize = INITIAL_CAPTURE_SIZE;
+  memcpy(m_map, SPP_CAPTURE_MAGIC, SPP_CAPTURE_MAGIC_SIZE);
+  m_used = SPP_CAPTURE_MAGIC_SIZE;
+}
+
+SPPCapture::~SPPCapture()
+{
+  Log("%s%s Path - %s, Size - %zu bytes", TAG, __func__, LOG_STRING(m_path), m_used);
+  if (m_map)
+  {
+    munmap(m_map, m_mapSize);
+  }
+  if (m_fd >= 0)
+  {
+    if (m_used && ftruncate(m_fd, m_used) < 0)
+    {
+      Log("%s%s Error: Truncating capture file, Error - %s", TAG, __func__, strerror(errno));
+    }
+    close(m_fd);
+  }
+}
+
+bool SPPCapture::Reserve(size_t len)
+{
+  if (m_used + len <= m_mapSize)
+  {
+    return true;
+  }
+  size_t size = m_mapSize * 2;
+  while (size < m_used + len)
+  {
+    size *= 2;
+  }
+  if (ftruncate(m_fd, size) < 0)
+  {
+    Log("%s%s Error: Growing capture file, Error - %s", TAG, __func__, strerror(errno));
+    return false;
+  }
+  void *map = mremap(m_map, m_mapSize, size, MREMAP_MAYMOVE);
+  if (map == MAP_FAILED)
+  {
+    Log("%s%s Error: Remapping capture file, Error - %s", TAG, __func__, strerror(errno));
+    return false;
+  }
+  m_map = static_cast<char *>(map);
+  m_mapSize = size;
+  return true;
+}
+
+void SPPCapture::Record(uint32_t connection, SPPCaptureDirection direction, const char *data, size_t len)
+{
+  uint64_t timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  uint32_t length = static_cast<uint32_t>(len);
+  uint8_t dir = static_cast<uint8_t>(direction);
+
+  std::lock_guard<std::mutex> lock(m_captureMutex);
+  if (!m_map || !Reserve(SPP_CAPTURE_RECORD_HEADER + len))
+  {
+    return;
+  }
+  char *out = m_map + m_used;
+  memcpy(out + 8, &connection, sizeof(connection));
+  memcpy(out + 12, &dir, sizeof(dir));
+  memcpy(out + 13, &length, sizeof(length));
+  memcpy(out + SPP_CAPTURE_RECORD_HEADER, data, len);
+  // Timestamp last: a record cut short by a crash still reads as the end of the capture
+  memcpy(out, &timestampNs, sizeof(timestampNs));
+  m_used += SPP_CAPTURE_RECORD_HEADER + len;
+}
+
+SPPCaptureReader::SPPCaptureReader(const std::string &path)
+{
+  Log("%s%s Path - %s", TAG, __func__, LOG_STRING(path));
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    Log("%s%s Error: Opening capture file, Error - %s", TAG, __func__, strerror(errno));
+    return;
+  }
+  struct stat st = {};
+  if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < SPP_CAPTURE_MAGIC_SIZE)
+  {
+    Log("%s%s Error: Not a capture file", TAG, __func__);
+    close(fd);
+    return;
+  }
+  void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+  {
+    Log("%s%s Error: Mapping capture file, Error - %s", TAG, __func__, strerror(errno));
+    return;
+  }
+  if (memcmp(map, SPP_CAPTURE_MAGIC, SPP_CAPTURE_MAGIC_SIZE) != 0)
+  {
+    Log("%s%s Error: Not a capture file", TAG, __func__);
+    munmap(map, st.st_size);
+    return;
+  }
+  m_map = static_cast<const char *>(map);
+  m_size = st.st_size;
+  m_offset = SPP_CAPTURE_MAGIC_SIZE;
+}
+
+SPPCaptureReader::~SPPCaptureReader()
+{
+  if (m_map)
+  {
+    munmap(const_cast<char *>(m_map), m_size);
+  }
+}
+
+bool SPPCaptureReader::Next(SPPCaptureRecord &record)
+{
+  if (!m_map || m_size - m_offset < SPP_CAPTURE_RECORD_HEADER)
+  {
+    return false;
+  }
+  const char *in = m_map + m_offset;
+  uint8_t dir = 0;
+  memcpy(&record.timestampNs, in, sizeof(record.timestampNs));
+  memcpy(&record.connection, in + 8, sizeof(record.connection));
+  memcpy(&dir, in + 12, sizeof(dir));
+  memcpy(&record.len, in + 13, sizeof(record.len));
+  if (!record.timestampNs)
+  {
+    // Zero padding left by a process that died before truncating the file
+    return false;
+  }
+  if (m_size - m_offset - SPP_CAPTURE_RECORD_HEADER < record.len)
+  {
+    Log("%s%s Error: Truncated record at offset %zu", TAG, __func__, m_offset);
+    return false;
+  }
+  record.direction = static_cast<SPPCaptureDirection>(dir);
+  record.data = in + SPP_CAPTURE_RECORD_HEADER;
+  m_offset += SPP_CAPTURE_RECORD_HEADER + record.len;
+  return true;
+}
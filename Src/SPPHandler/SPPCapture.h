@@ -0,0 +1,141 @@
+/**
+ * @file SPPCapture.h
+ * @brief Recording and reading of SPP traffic captures
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#define SPP_CAPTURE_MAGIC "SPPCAP1\n"  ///< First 8 bytes of a capture file
+#define SPP_CAPTURE_MAGIC_SIZE 8       ///< Size of the file magic
+#define SPP_CAPTURE_RECORD_HEADER 17   ///< Timestamp, connection, direction and length
+
+/**
+ * @enum SPPCaptureDirection
+ * @brief Direction of captured bytes as seen by this application
+ */
+enum class SPPCaptureDirection : uint8_t
+{
+  Inbound = 0,  ///< Received from the peer
+  Outbound = 1  ///< Sent to the peer
+};
+
+/**
+ * @struct SPPCaptureRecord
+ * @brief One captured read or write
+ */
+typedef struct
+{
+  uint64_t timestampNs;          ///< CLOCK_MONOTONIC time of the read or write
+  uint32_t connection;           ///< Connection id, unique within the capture
+  SPPCaptureDirection direction; ///< Inbound or outbound
+  const char *data;              ///< Captured bytes (points into the mapped file)
+  uint32_t len;                  ///< Number of bytes
+} SPPCaptureRecord;
+
+/**
+ * @class SPPCapture
+ * @brief Appends SPP traffic of any number of connections to a capture file
+ *
+ * File layout: the 8-byte magic followed by records of
+ * | timestamp ns u64 | connection u32 | direction u8 | length u32 | bytes |,
+ * all little-endian and unpadded. The file is memory-mapped and grown by
+ * doubling, so recording a read costs one memcpy under a short lock; the
+ * file is truncated to its used size when the capture is closed. A file
+ * left by a crashed process ends in zero padding instead; a record whose
+ * timestamp is zero marks the end of the capture, and the timestamp is
+ * written last so a half-written record reads the same way.
+ */
+class SPPCapture
+{
+public:
+  /**
+   * @brief Create the capture file, replacing any existing file
+   * @param path Capture file path
+   */
+  explicit SPPCapture(const std::string &path);
+
+  /**
+   * @brief Flush and close the capture file
+   */
+  ~SPPCapture();
+
+  /**
+   * @brief Check whether the capture file is open
+   * @return True if records are being written
+   */
+  bool IsOpen() const { return m_map != nullptr; }
+
+  /**
+   * @brief Append a record
+   * @param connection Connection id
+   * @param direction Direction of the bytes
+   * @param data Bytes read or written
+   * @param len Number of bytes
+   */
+  void Record(uint32_t connection, SPPCaptureDirection direction, const char *data, size_t len);
+
+private:
+  /**
+   * @brief Make room for len more bytes, growing the file and mapping
+   * @param len Number of bytes to append
+   * @return False if the file could not be grown
+   */
+  bool Reserve(size_t len);
+
+private:
+  std::string m_path;          ///< Capture file path
+  int m_fd = -1;               ///< Capture file descriptor
+  char *m_map = nullptr;       ///< Mapping of the whole file
+  size_t m_mapSize = 0;        ///< Current file and mapping size
+  size_t m_used = 0;           ///< Bytes written so far
+  std::mutex m_captureMutex;   ///< Serialises appends from reader and writer threads
+};
+
+/**
+ * @class SPPCaptureReader
+ * @brief Iterates over the records of a capture file
+ */
+class SPPCaptureReader
+{
+public:
+  /**
+   * @brief Map a capture file for reading
+   * @param path Capture file path
+   */
+  explicit SPPCaptureReader(const std::string &path);
+
+  /**
+   * @brief Unmap the capture file
+   */
+  ~SPPCaptureReader();
+
+  /**
+   * @brief Check whether the file was mapped and has a valid magic
+   * @return True if records can be read
+   */
+  bool IsOpen() const { return m_map != nullptr; }
+
+  /**
+   * @brief Read the next record
+   * @param record Filled with the record; data stays valid while the reader lives
+   * @return False at the end of the capture, at zero padding or on a truncated record
+   */
+  bool Next(SPPCaptureRecord &record);
+
+  /**
+   * @brief Restart from the first record
+   */
+  void Rewind() { m_offset = SPP_CAPTURE_MAGIC_SIZE; }
+
+private:
+  const char *m_map = nullptr; ///< Mapping of the whole file
+  size_t m_size = 0;           ///< File size
+  size_t m_offset = 0;         ///< Offset of the next record
+};
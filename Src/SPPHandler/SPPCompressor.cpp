@@ -0,0 +1,268 @@
+/**
+ * @file SPPCompressor.cpp
+ * @brief Implementation of per-frame payload compression for SPP links
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "SPPCompressor.h"
+
+#define HASH_BITS 12         ///< Match finder hash table size (4096 entries)
+#define MIN_MATCH 4          ///< Shortest match the format can encode
+#define MFLIMIT 12           ///< No match may start in the last 12 bytes (LZ4 rule)
+#define LAST_LITERALS 5      ///< The last 5 bytes are always literals (LZ4 rule)
+#define MAX_OFFSET 65535     ///< Largest match distance the format can encode
+#define RUN_MASK 15          ///< Length nibble value meaning "more length bytes follow"
+
+namespace
+{
+/// Shared dictionary: byte strings common in SPP traffic. Both ends must use
+/// the same bytes, so this may only ever be appended to behind a new
+/// capability bit.
+const char DICTIONARY[] =
+    "{\"seq\":0,\"ts\":0,\"type\":\"telemetry\",\"status\":\"ok\",\"error\":\"\","
+    "\"rssi\":-60,\"txpower\":0,\"battery\":100,\"temperature\":25.0,\"voltage\":3.70,"
+    "\"current\":0.00,\"speed\":0,\"heading\":0,\"latitude\":0.000000,\"longitude\":0.000000,"
+    "\"accel\":[0.00,0.00,0.00],\"gyro\":[0.00,0.00,0.00],\"firmware\":\"1.0.0\"}"
+    "Ping Pong Request Response Telemetry Status OK Error Timeout Connected Disconnected "
+    "0000000000000000000000000000000000000000000000000000000000000000";
+const size_t DICTIONARY_SIZE = sizeof(DICTIONARY) - 1;
+
+uint32_t Read32(const uint8_t *p)
+{
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(uint32_t value)
+{
+  return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+bool WriteLength(uint8_t *&op, const uint8_t *end, size_t len)
+{
+  while (len >= 255)
+  {
+    if (op >= end)
+    {
+      return false;
+    }
+    *op++ = 255;
+    len -= 255;
+  }
+  if (op >= end)
+  {
+    return false;
+  }
+  *op++ = static_cast<uint8_t>(len);
+  return true;
+}
+
+bool ReadLength(const uint8_t *&ip, const uint8_t *end, size_t &len)
+{
+  uint8_t byte = 0;
+  do
+  {
+    if (ip >= end)
+    {
+      return false;
+    }
+    byte = *ip++;
+    len += byte;
+  } while (byte == 255);
+  return true;
+}
+
+bool WriteSequence(uint8_t *&op, const uint8_t *end, const uint8_t *literals, size_t litLen, size_t offset, size_t matchLen)
+{
+  if (op >= end)
+  {
+    return false;
+  }
+  uint8_t *token = op++;
+  size_t matchCode = matchLen ? matchLen - MIN_MATCH : 0;
+  *token = static_cast<uint8_t>((std::min<size_t>(litLen, RUN_MASK) << 4) | std::min<size_t>(matchCode, RUN_MASK));
+  if (litLen >= RUN_MASK && !WriteLength(op, end, litLen - RUN_MASK))
+  {
+    return false;
+  }
+  if (static_cast<size_t>(end - op) < litLen)
+  {
+    return false;
+  }
+  memcpy(op, literals, litLen);
+  op += litLen;
+  if (!matchLen)
+  {
+    return true;
+  }
+  if (end - op < 2)
+  {
+    return false;
+  }
+  *op++ = offset & 0xFF;
+  *op++ = (offset >> 8) & 0xFF;
+  return matchCode < RUN_MASK || WriteLength(op, end, matchCode - RUN_MASK);
+}
+
+/// Match window: the dictionary followed by the frame being coded
+std::vector<uint8_t> &Window(size_t len)
+{
+  thread_local std::vector<uint8_t> window;
+  window.resize(DICTIONARY_SIZE + len);
+  memcpy(window.data(), DICTIONARY, DICTIONARY_SIZE);
+  return window;
+}
+} // namespace
+
+SPPCompressor::SPPCompressor() : m_inputBytes(0),
+                                 m_outputBytes(0),
+                                 m_compressedFrames(0),
+                                 m_storedFrames(0)
+{
+}
+
+size_t SPPCompressor::Compress(const uint8_t *src, size_t len, uint8_t *dst, size_t capacity)
+{
+  m_inputBytes += len;
+  if (len <= MFLIMIT)
+  {
+    m_outputBytes += len;
+    ++m_storedFrames;
+    return 0;
+  }
+
+  std::vector<uint8_t> &window = Window(len);
+  memcpy(window.data() + DICTIONARY_SIZE, src, len);
+  const uint8_t *base = window.data();
+  const size_t end = window.size();
+  const size_t matchLimit = end - LAST_LITERALS;
+
+  int32_t table[1 << HASH_BITS];
+  std::fill(std::begin(table), std::end(table), -1);
+  for (size_t pos = 0; pos + MIN_MATCH <= DICTIONARY_SIZE; ++pos)
+  {
+    table[Hash(Read32(base + pos))] = static_cast<int32_t>(pos);
+  }
+
+  // Never let the output grow past the input; such frames are sent as-is
+  uint8_t *op = dst;
+  const uint8_t *oend = dst + std::min(capacity, len - 1);
+  size_t anchor = DICTIONARY_SIZE;
+  size_t ip = DICTIONARY_SIZE;
+  bool fits = true;
+  while (fits && ip + MFLIMIT <= end)
+  {
+    uint32_t sequence = Read32(base + ip);
+    uint32_t hash = Hash(sequence);
+    int32_t candidate = table[hash];
+    table[hash] = static_cast<int32_t>(ip);
+    if (candidate < 0 || ip - candidate > MAX_OFFSET || Read32(base + candidate) != sequence)
+    {
+      ++ip;
+      continue;
+    }
+    size_t ref = candidate;
+    while (ip > anchor && ref > 0 && base[ip - 1] == base[ref - 1])
+    {
+      --ip;
+      --ref;
+    }
+    size_t matchLen = MIN_MATCH;
+    while (ip + matchLen < matchLimit && base[ref + matchLen] == base[ip + matchLen])
+    {
+      ++matchLen;
+    }
+    fits = WriteSequence(op, oend, base + anchor, ip - anchor, ip - ref, matchLen);
+    ip += matchLen;
+    anchor = ip;
+  }
+  fits = fits && WriteSequence(op, oend, base + anchor, end - anchor, 0, 0);
+
+  if (!fits)
+  {
+    m_outputBytes += len;
+    ++m_storedFrames;
+    return 0;
+  }
+  size_t compressed = op - dst;
+  m_outputBytes += compressed;
+  ++m_compressedFrames;
+  return compressed;
+}
+
+long SPPCompressor::Decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t capacity)
+{
+  std::vector<uint8_t> &window = Window(capacity);
+  uint8_t *base = window.data();
+  uint8_t *op = base + DICTIONARY_SIZE;
+  const uint8_t *oend = base + window.size();
+  const uint8_t *ip = src;
+  const uint8_t *iend = src + len;
+
+  while (ip < iend)
+  {
+    uint8_t token = *ip++;
+    size_t litLen = token >> 4;
+    if (litLen == RUN_MASK && !ReadLength(ip, iend, litLen))
+    {
+      return -1;
+    }
+    if (static_cast<size_t>(iend - ip) < litLen || static_cast<size_t>(oend - op) < litLen)
+    {
+      return -1;
+    }
+    memcpy(op, ip, litLen);
+    op += litLen;
+    ip += litLen;
+    if (ip == iend)
+    {
+      // The last sequence carries literals only
+      break;
+    }
+
+    if (iend - ip < 2)
+    {
+      return -1;
+    }
+    size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    size_t matchLen = token & RUN_MASK;
+    if (matchLen == RUN_MASK && !ReadLength(ip, iend, matchLen))
+    {
+      return -1;
+    }
+    matchLen += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<size_t>(op - base) || static_cast<size_t>(oend - op) < matchLen)
+    {
+      return -1;
+    }
+    // Byte-wise copy: the match may overlap the bytes it produces
+    const uint8_t *match = op - offset;
+    for (size_t i = 0; i < matchLen; ++i)
+    {
+      op[i] = match[i];
+    }
+    op += matchLen;
+  }
+
+  size_t decompressed = op - (base + DICTIONARY_SIZE);
+  memcpy(dst, base + DICTIONARY_SIZE, decompressed);
+  return static_cast<long>(decompressed);
+}
+
+SPPCompressionStats SPPCompressor::Stats() const
+{
+  return {m_inputBytes.load(), m_outputBytes.load(), m_compressedFrames.load(), m_storedFrames.load()};
+}
+
+double SPPCompressor::Ratio() const
+{
+  uint64_t input = m_inputBytes.load();
+  return input ? static_cast<double>(m_outputBytes.load()) / input : 1.0;
+}
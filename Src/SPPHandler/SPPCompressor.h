@@ -0,0 +1,85 @@
+/**
+ * @file SPPCompressor.h
+ * @brief Per-frame payload compression for SPP links
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct SPPCompressionStats
+ * @brief Snapshot of the compression counters of one link
+ */
+typedef struct
+{
+  uint64_t inputBytes;       ///< Payload bytes offered for compression
+  uint64_t outputBytes;      ///< Bytes put on the wire for those payloads
+  uint64_t compressedFrames; ///< Frames sent compressed
+  uint64_t storedFrames;     ///< Frames sent as-is because compression did not help
+} SPPCompressionStats;
+
+/**
+ * @class SPPCompressor
+ * @brief LZ4 block format codec with a built-in shared dictionary
+ *
+ * Frames on an SPP link are small (at most one pool chunk), too small for a
+ * general purpose compressor to find repeats within a single frame. Both
+ * ends therefore prime the match window with the same static dictionary of
+ * strings common in our traffic, so even short frames compress. The output
+ * is a plain LZ4 block whose offsets may reach back into the dictionary.
+ * Compression is only used when it makes the frame smaller.
+ *
+ * Compress() and Decompress() keep no per-call state in the object and may
+ * be called from several threads at once.
+ */
+class SPPCompressor
+{
+public:
+  /**
+   * @brief Construct a new SPPCompressor object
+   */
+  SPPCompressor();
+
+  /**
+   * @brief Compress a payload
+   * @param src Payload bytes
+   * @param len Payload length
+   * @param dst Output buffer
+   * @param capacity Output buffer size
+   * @return Compressed length, or 0 if the result would not be smaller than the input
+   */
+  size_t Compress(const uint8_t *src, size_t len, uint8_t *dst, size_t capacity);
+
+  /**
+   * @brief Decompress a payload produced by Compress()
+   * @param src Compressed bytes
+   * @param len Compressed length
+   * @param dst Output buffer
+   * @param capacity Output buffer size
+   * @return Decompressed length, or -1 if the input is malformed or does not fit
+   */
+  long Decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t capacity);
+
+  /**
+   * @brief Get the compression counters
+   * @return Snapshot of the counters
+   */
+  SPPCompressionStats Stats() const;
+
+  /**
+   * @brief Get the ratio of wire bytes to payload bytes
+   * @return Ratio in the range (0, 1], or 1 if nothing was sent
+   */
+  double Ratio() const;
+
+private:
+  std::atomic<uint64_t> m_inputBytes;       ///< Payload bytes offered for compression
+  std::atomic<uint64_t> m_outputBytes;      ///< Bytes put on the wire
+  std::atomic<uint64_t> m_compressedFrames; ///< Frames sent compressed
+  std::atomic<uint64_t> m_storedFrames;     ///< Frames sent as-is
+};
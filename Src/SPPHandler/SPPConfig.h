@@ -0,0 +1,31 @@
+/**
+ * @file SPPConfig.h
+ * @brief Per-connection options for the SPP data path
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <string>
+
+/**
+ * @enum SPPChecksum
+ * @brief Integrity trailer appended to outgoing frames
+ */
+enum class SPPChecksum
+{
+  None,   ///< No trailer
+  Crc16,  ///< CRC-16/CCITT-FALSE, 2 bytes
+  Crc32c  ///< CRC-32C, 4 bytes
+};
+
+/**
+ * @struct SPPConfig
+ * @brief Options applied to every SPP connection
+ */
+typedef struct{
+  bool compression = false; ///< Offer payload compression to the peer (used only if the peer offers it too)
+  SPPChecksum checksum = SPPChecksum::None; ///< Trailer added to outgoing frames; received trailers are always checked
+  std::string capturePath;  ///< Record all SPP traffic to this file when not empty (see SPPCapture)
+}SPPConfig;
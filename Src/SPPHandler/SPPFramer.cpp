@@ -0,0 +1,215 @@
+/**
+ * @file SPPFramer.cpp
+ * @brief Implementation of length-prefixed framing for the SPP byte stream
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "SPPFramer.h"
+
+#include "Checksum.h"
+#include "Logger.h"
+
+#define TAG "SPPFramer::" ///< Tag for logging messages
+
+SPPFramer::SPPFramer(BufferPool &pool) : m_pool(pool)
+{
+}
+
+size_t SPPFramer::MaxPayload() const
+{
+  return m_pool.ChunkSize() - SPP_FRAME_HEADER_SIZE;
+}
+
+/**
+ * @brief Get the trailer size selected by the frame flags
+ * @param flags Frame flags
+ * @return Trailer size in bytes
+ */
+static size_t TrailerSize(uint8_t flags)
+{
+  if (flags & SPP_FRAME_FLAG_CRC32C)
+  {
+    return 4;
+  }
+  if (flags & SPP_FRAME_FLAG_CRC16)
+  {
+    return 2;
+  }
+  return 0;
+}
+
+/**
+ * @brief Compute the trailer value over a header and payload
+ * @param header Frame header
+ * @param payload Payload bytes, without the trailer
+ * @param len Payload length
+ * @return CRC selected by the header flags
+ */
+static uint32_t TrailerValue(const uint8_t *header, const char *payload, size_t len)
+{
+  if (header[1] & SPP_FRAME_FLAG_CRC32C)
+  {
+    return Crc32c(payload, len, Crc32c(header, SPP_FRAME_HEADER_SIZE));
+  }
+  return Crc16(payload, len, Crc16(header, SPP_FRAME_HEADER_SIZE));
+}
+
+bool SPPFramer::Seal(BufferHandle &chunk, size_t payloadLen, uint8_t flags)
+{
+  size_t trailer = TrailerSize(flags);
+  size_t length = payloadLen + trailer;
+  if (!chunk || length + SPP_FRAME_HEADER_SIZE > chunk.Capacity() || length > UINT16_MAX)
+  {
+    return false;
+  }
+  uint8_t *header = reinterpret_cast<uint8_t *>(chunk.Data());
+  header[0] = SPP_FRAME_MAGIC;
+  header[1] = flags;
+  header[2] = length & 0xFF;
+  header[3] = (length >> 8) & 0xFF;
+  if (trailer)
+  {
+    uint32_t crc = TrailerValue(header, Payload(chunk), payloadLen);
+    uint8_t *out = header + SPP_FRAME_HEADER_SIZE + payloadLen;
+    for (size_t i = 0; i < trailer; ++i)
+    {
+      out[i] = (crc >> (8 * i)) & 0xFF;
+    }
+  }
+  chunk.SetSize(length + SPP_FRAME_HEADER_SIZE);
+  return true;
+}
+
+bool SPPFramer::Verify(SPPFrame &frame)
+{
+  size_t trailer = TrailerSize(frame.flags);
+  if (!trailer)
+  {
+    return true;
+  }
+  size_t length = frame.payload.Size();
+  if (length < trailer)
+  {
+    return false;
+  }
+  const uint8_t header[SPP_FRAME_HEADER_SIZE] = {SPP_FRAME_MAGIC, frame.flags, static_cast<uint8_t>(length & 0xFF),
+                                                 static_cast<uint8_t>((length >> 8) & 0xFF)};
+  size_t payloadLen = length - trailer;
+  const uint8_t *in = reinterpret_cast<const uint8_t *>(frame.payload.Data()) + payloadLen;
+  uint32_t expected = 0;
+  for (size_t i = 0; i < trailer; ++i)
+  {
+    expected |= static_cast<uint32_t>(in[i]) << (8 * i);
+  }
+  if (TrailerValue(header, frame.payload.Data(), payloadLen) != expected)
+  {
+    return false;
+  }
+  frame.payload = frame.payload.Slice(0, payloadLen);
+  frame.flags &= ~(SPP_FRAME_FLAG_CRC16 | SPP_FRAME_FLAG_CRC32C);
+  return true;
+}
+
+void SPPFramer::Append(const char *data, size_t len)
+{
+  memcpy(m_partial.Data() + m_partial.Size(), data, len);
+  m_partial.SetSize(m_partial.Size() + len);
+}
+
+void SPPFramer::Feed(const BufferHandle &data, const FrameCallback &onFrame)
+{
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data.Data());
+  size_t size = data.Size();
+  size_t pos = 0;
+
+  while (pos < size)
+  {
+    if (m_skip)
+    {
+      // Payload of a frame dropped for lack of buffers
+      size_t take = std::min(m_skip, size - pos);
+      m_skip -= take;
+      pos += take;
+      continue;
+    }
+
+    if (m_headerLen == 0)
+    {
+      if (bytes[pos] != SPP_FRAME_MAGIC)
+      {
+        ++pos;
+        ++m_dropped;
+        continue;
+      }
+      // Fast path: the whole frame is inside this chunk, hand out a slice
+      if (size - pos >= SPP_FRAME_HEADER_SIZE)
+      {
+        size_t length = bytes[pos + 2] | (bytes[pos + 3] << 8);
+        if (length > MaxPayload())
+        {
+          ++pos;
+          ++m_dropped;
+          continue;
+        }
+        if (size - pos - SPP_FRAME_HEADER_SIZE >= length)
+        {
+          if (m_dropped)
+          {
+            Log("%s%s Resynchronised after %zu bytes", TAG, __func__, m_dropped);
+            m_dropped = 0;
+          }
+          onFrame({bytes[pos + 1], data.Slice(pos + SPP_FRAME_HEADER_SIZE, length)});
+          pos += SPP_FRAME_HEADER_SIZE + length;
+          continue;
+        }
+      }
+    }
+
+    if (m_headerLen < SPP_FRAME_HEADER_SIZE)
+    {
+      m_header[m_headerLen++] = bytes[pos++];
+      if (m_headerLen < SPP_FRAME_HEADER_SIZE)
+      {
+        continue;
+      }
+      size_t length = m_header[2] | (m_header[3] << 8);
+      if (length > MaxPayload())
+      {
+        // Not a real header; the magic was payload noise
+        m_dropped += m_headerLen;
+        m_headerLen = 0;
+        continue;
+      }
+      m_partial = m_pool.Acquire();
+      if (!m_partial)
+      {
+        Log("%s%s Error: Buffer pool exhausted, dropping frame", TAG, __func__);
+        m_skip = length;
+        m_headerLen = 0;
+      }
+      else if (length == 0)
+      {
+        onFrame({m_header[1], std::move(m_partial)});
+        m_partial.Reset();
+        m_headerLen = 0;
+      }
+      continue;
+    }
+
+    // Reassembling a frame that started in an earlier chunk
+    size_t length = m_header[2] | (m_header[3] << 8);
+    size_t take = std::min(length - m_partial.Size(), size - pos);
+    Append(reinterpret_cast<const char *>(bytes + pos), take);
+    pos += take;
+    if (m_partial.Size() == length)
+    {
+      onFrame({m_header[1], std::move(m_partial)});
+      m_partial.Reset();
+      m_headerLen = 0;
+    }
+  }
+}
@@ -0,0 +1,118 @@
+/**
+ * @file SPPFramer.h
+ * @brief Length-prefixed framing for the SPP byte stream
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "BufferPool.h"
+
+#define SPP_FRAME_MAGIC 0xA5        ///< First byte of every frame, used to resynchronise
+#define SPP_FRAME_HEADER_SIZE 4     ///< Magic, flags and 16-bit little-endian payload length
+
+#define SPP_FRAME_FLAG_CONTROL 0x01    ///< Payload is a link control message, not application data
+#define SPP_FRAME_FLAG_COMPRESSED 0x02 ///< Payload is compressed (see SPPCompressor)
+#define SPP_FRAME_FLAG_CRC16 0x04      ///< Payload ends with a CRC-16 trailer (u16 LE)
+#define SPP_FRAME_FLAG_CRC32C 0x08     ///< Payload ends with a CRC-32C trailer (u32 LE)
+
+#define SPP_FRAME_TRAILER_MAX 4     ///< Largest checksum trailer
+
+#define SPP_CONTROL_HELLO 0x01            ///< Control message: | HELLO | capabilities |
+#define SPP_CAPABILITY_COMPRESSION 0x01   ///< Sender accepts compressed frames
+
+/**
+ * @struct SPPFrame
+ * @brief A decoded frame
+ */
+typedef struct
+{
+  uint8_t flags;        ///< Frame flags from the header
+  BufferHandle payload; ///< Frame payload, usually a slice of the received chunk
+} SPPFrame;
+
+/**
+ * @class SPPFramer
+ * @brief Splits the SPP byte stream into frames and builds outgoing frames
+ *
+ * Wire format: | 0xA5 | flags | length (u16 LE) | payload |. A frame that
+ * lies entirely inside one received chunk is delivered as a slice of that
+ * chunk; only frames split across reads are reassembled into a fresh chunk.
+ * Bytes that do not start with the magic are skipped until the next magic.
+ *
+ * A frame may end with a CRC trailer covering the header and the payload;
+ * the length field then includes the trailer. Seal() appends it and
+ * Verify() checks and strips it.
+ */
+class SPPFramer
+{
+public:
+  /// Callback invoked for each complete frame
+  using FrameCallback = std::function<void(SPPFrame frame)>;
+
+  /**
+   * @brief Construct a new SPPFramer object
+   * @param pool Pool used to reassemble frames split across reads
+   */
+  explicit SPPFramer(BufferPool &pool);
+
+  /**
+   * @brief Feed received bytes into the decoder
+   * @param data Chunk holding the received bytes
+   * @param onFrame Callback invoked for each complete frame
+   */
+  void Feed(const BufferHandle &data, const FrameCallback &onFrame);
+
+  /**
+   * @brief Largest payload that fits in one pool chunk
+   * @return Maximum payload size in bytes
+   */
+  size_t MaxPayload() const;
+
+  /**
+   * @brief Get a pointer to the payload area of a chunk being built
+   * @param chunk Chunk acquired from the pool
+   * @return Pointer where the payload must be written
+   */
+  static char *Payload(const BufferHandle &chunk) { return chunk.Data() + SPP_FRAME_HEADER_SIZE; }
+
+  /**
+   * @brief Write the frame header in front of a payload already in the chunk
+   *
+   * If flags contain SPP_FRAME_FLAG_CRC16 or SPP_FRAME_FLAG_CRC32C the
+   * matching trailer is appended after the payload.
+   * @param chunk Chunk whose payload area holds payloadLen bytes
+   * @param payloadLen Number of payload bytes
+   * @param flags Frame flags
+   * @return False if the payload and trailer do not fit in the chunk
+   */
+  static bool Seal(BufferHandle &chunk, size_t payloadLen, uint8_t flags);
+
+  /**
+   * @brief Check and strip the checksum trailer of a received frame
+   * @param frame Decoded frame; on success its payload no longer includes the trailer
+   * @return False if the trailer is missing or does not match
+   */
+  static bool Verify(SPPFrame &frame);
+
+private:
+  /**
+   * @brief Copy bytes into the reassembly chunk
+   * @param data Source bytes
+   * @param len Number of bytes
+   */
+  void Append(const char *data, size_t len);
+
+private:
+  BufferPool &m_pool;            ///< Pool for reassembly chunks
+  BufferHandle m_partial;        ///< Reassembly chunk for a frame split across reads
+  uint8_t m_header[SPP_FRAME_HEADER_SIZE] = {}; ///< Header bytes collected so far
+  size_t m_headerLen = 0;        ///< Number of header bytes collected
+  size_t m_skip = 0;             ///< Payload bytes left of a frame being dropped
+  size_t m_dropped = 0;          ///< Bytes skipped while resynchronising
+};
@@ -8,17 +8,27 @@
 #include <chrono>
 #include <limits>
 #include <cstring>
+#include <cinttypes>
 #include <errno.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
 #include <fcntl.h>
 
 #include "SPPHandler.h"
 
+#include "Checksum.h"
 #include "Logger.h"
+#include "Trace.h"
 
 #define TAG "SPPHandler::"                              ///< Tag for logging messages
-#define BUFFER_SIZE 1024                                ///< Size of read/write buffers
 #define SLEEP_DURATION std::chrono::seconds(1)          ///< Sleep duration for thread loops
+#define POOL_RETRY_DURATION std::chrono::milliseconds(10) ///< Backoff when the buffer pool is exhausted
+#define REQUEST_TIMEOUT std::chrono::seconds(5)         ///< Time to wait for a response to a request
+#define WRITE_POLL_TIMEOUT_MS 1000                      ///< Time to wait for a full socket to drain
+#define MAX_INFLIGHT_REQUESTS 256                       ///< Outstanding requests per connection
+#define SPP_BYTES_METRIC "bluezeg_spp_bytes_total"       ///< Bytes per connection and direction
+#define SPP_FRAMES_METRIC "bluezeg_spp_frames_total"     ///< Frames per connection and direction
 
 const int ERROR = -1; ///< Error return value constant
 
@@ -29,10 +39,22 @@ const int ERROR = -1; ///< Error return value constant
  * a control pipe for thread synchronization.
  * 
  * @param fd Unix file descriptor for the SPP connection
+ * @param pool Chunk pool shared by all SPP connections
+ * @param config Options for this connection
+ * @param capture Capture receiving this connection's traffic, or null
+ * @param connectionId Id of this connection in the capture
  */
-SPPHandler::SPPHandler(sdbus::UnixFd fd) : m_fd(fd),
-                                           m_readRunning(true),
-                                           m_writeRunning(true)
+SPPHandler::SPPHandler(sdbus::UnixFd fd, BufferPool &pool, const SPPConfig &config, SPPCapture *capture, uint32_t connectionId) : m_fd(fd),
+                                                                                                                                  m_pool(pool),
+                                                                                                                                  m_readRunning(true),
+                                                                                                                                  m_writeRunning(true),
+                                                                                                                                  m_config(config),
+                                                                                                                                  m_framer(pool),
+                                                                                                                                  m_peerCompression(false),
+                                                                                                                                  m_checksumFlag(0),
+                                                                                                                                  m_checksumErrors(0),
+                                                                                                                                  m_capture(capture),
+                                                                                                                                  m_connectionId(connectionId)
 {
   Log("%s%s", TAG, __func__);
 
@@ -41,6 +63,41 @@ SPPHandler::SPPHandler(sdbus::UnixFd fd) : m_fd(fd),
   {
     Log("%s%s Error: Creating pipe, Error - %s", TAG, __func__, strerror(errno));
   }
+
+  if (m_config.checksum == SPPChecksum::Crc32c)
+  {
+    m_checksumFlag = SPP_FRAME_FLAG_CRC32C;
+    Log("%s%s CRC-32C trailer, Implementation - %s", TAG, __func__, Crc32cImplementation());
+  }
+  else if (m_config.checksum == SPPChecksum::Crc16)
+  {
+    m_checksumFlag = SPP_FRAME_FLAG_CRC16;
+  }
+
+  m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_wakeFd < 0)
+  {
+    Log("%s%s Error: Creating eventfd, Error - %s", TAG, __func__, strerror(errno));
+  }
+
+  MetricsRegistry &metrics = MetricsRegistry::Instance();
+  m_metricLabels = MetricsRegistry::Label("connection", std::to_string(m_connectionId));
+  m_rxBytes = &metrics.GetCounter(SPP_BYTES_METRIC, "SPP bytes per connection", m_metricLabels + ",direction=\"rx\"");
+  m_txBytes = &metrics.GetCounter(SPP_BYTES_METRIC, "SPP bytes per connection", m_metricLabels + ",direction=\"tx\"");
+  m_rxFrames = &metrics.GetCounter(SPP_FRAMES_METRIC, "SPP frames per connection", m_metricLabels + ",direction=\"rx\"");
+  m_txFrames = &metrics.GetCounter(SPP_FRAMES_METRIC, "SPP frames per connection", m_metricLabels + ",direction=\"tx\"");
+
+  m_transactions = std::make_unique<SPPTransaction>(
+      pool,
+      [this](BufferHandle chunk, size_t payloadLen) { return SendFrame(std::move(chunk), payloadLen); },
+      [this]() { WakeReader(); },
+      MAX_INFLIGHT_REQUESTS);
+
+  // Answer requests from the peer by echoing the body back
+  m_transactions->SetRequestHandler([this](uint32_t seq, BufferHandle body) {
+    Log("%sRequestHandler Seq - %u, Data - %.*s", TAG, seq, static_cast<int>(body.Size()), body.Data());
+    m_transactions->Respond(seq, body.Data(), body.Size());
+  });
 }
 
 SPPHandler::~SPPHandler()
@@ -61,8 +118,30 @@ SPPHandler::~SPPHandler()
 
     CloseThread(m_read_thread);
     CloseThread(m_write_thread);
+    m_transactions->Close();
+    if (m_checksumErrors)
+    {
+      Log("%s%s Checksum errors - %" PRIu64, TAG, __func__, m_checksumErrors.load());
+    }
+    if (m_config.compression)
+    {
+      SPPCompressionStats stats = m_compressor.Stats();
+      Log("%s%s Compression - In %" PRIu64 " bytes, Out %" PRIu64 " bytes, Ratio %.2f, Compressed %" PRIu64 " frames, Stored %" PRIu64 " frames",
+          TAG, __func__, stats.inputBytes, stats.outputBytes, m_compressor.Ratio(), stats.compressedFrames, stats.storedFrames);
+    }
+    if (m_wakeFd >= 0)
+    {
+      close(m_wakeFd);
+      m_wakeFd = -1;
+    }
     ClosePipe();
     CloseFD();
+    // Closed connections would otherwise pile up as series
+    for (const char *direction : {",direction=\"rx\"", ",direction=\"tx\""})
+    {
+      MetricsRegistry::Instance().Remove(SPP_BYTES_METRIC, m_metricLabels + direction);
+      MetricsRegistry::Instance().Remove(SPP_FRAMES_METRIC, m_metricLabels + direction);
+    }
   } catch (std::system_error &e) {
     Log("%s%s Error: %s", TAG, __func__, e.what());
   }
@@ -70,6 +149,16 @@ SPPHandler::~SPPHandler()
 
 void SPPHandler::StartOperations()
 {
+  m_uring = std::make_unique<SPPUring>(m_fd.get(), m_pipeCtrl[0], m_pool);
+  if (!m_uring->Init())
+  {
+    Log("%s%s Using epoll data path", TAG, __func__);
+    m_uring.reset();
+  }
+  if (m_config.compression)
+  {
+    SendHello();
+  }
   m_read_thread = std::thread(&SPPHandler::ReadBuffer, this);
   m_write_thread = std::thread(&SPPHandler::WriteBuffer, this);
 }
@@ -77,15 +166,44 @@ void SPPHandler::StartOperations()
 void SPPHandler::ReadBuffer()
 {
   Log("%s%s", TAG, __func__);
+  Trace::SetThreadName("SPPReader-" + std::to_string(m_connectionId));
+  // One span for the whole session, recorded when the connection ends
+  TRACE_SCOPE("spp", "SPPSession");
   int fd = m_fd.get();
   MakeSocketNonBlocking(fd);
 
+  if (m_uring)
+  {
+    auto result = m_uring->Run(
+        m_readRunning,
+        [this](BufferHandle data) { ProcessData(std::move(data)); },
+        [this]() {
+          m_transactions->Tick();
+          return m_transactions->NextTimeoutMs();
+        });
+    if (result == SPPUring::RunResult::Stopped)
+    {
+      return;
+    }
+    // Kernel rejected multishot recv; send what the ring did not finish
+    for (const auto &data : m_uring->TakePendingWrites())
+    {
+      WriteData(data);
+    }
+  }
+  ReadBufferEpoll(fd);
+}
+
+void SPPHandler::ReadBufferEpoll(int fd)
+{
+  Log("%s%s", TAG, __func__);
   int nfds = 0;
   int epoll_fd = -1;
   const uint32_t MAXEVENTS = 4;
   struct epoll_event events[MAXEVENTS] = {};
   struct epoll_event fileDesPollEvents = {};
   struct epoll_event pipePollEvents = {};
+  struct epoll_event wakePollEvents = {};
 
   pipePollEvents.events = EPOLLIN | EPOLLET;
   pipePollEvents.data.fd = m_pipeCtrl[0]; // monitoring the Pipe read end
@@ -93,6 +211,9 @@ void SPPHandler::ReadBuffer()
   fileDesPollEvents.events = EPOLLIN;
   fileDesPollEvents.data.fd = fd;
 
+  wakePollEvents.events = EPOLLIN;
+  wakePollEvents.data.fd = m_wakeFd;
+
   epoll_fd = epoll_create1(0);
   if (epoll_fd < 0)
   {
@@ -115,9 +236,17 @@ void SPPHandler::ReadBuffer()
     return;
   }
 
+  if (m_wakeFd >= 0 && epoll_ctl(epoll_fd, EPOLL_CTL_ADD, m_wakeFd, &wakePollEvents) == -1)
+  {
+    Log("%s%s Error: Adding eventfd to epoll, Error - %s", TAG, __func__, strerror(errno));
+    close(epoll_fd);
+    return;
+  }
+
   while (m_readRunning)
   {
-    nfds = epoll_wait(epoll_fd, events, 1, -1); // Wait indefinitely for data
+    // Sleep until data arrives or the next request deadline is due
+    nfds = epoll_wait(epoll_fd, events, MAXEVENTS, m_transactions->NextTimeoutMs());
     if (nfds < 0)
     {
       Log("%s%s Error: epoll_wait, Error - %s", TAG, __func__, strerror(errno));
@@ -132,12 +261,27 @@ void SPPHandler::ReadBuffer()
           Log("%s%s Pipe event", TAG, __func__);
           m_readRunning = false;
         }
+        else if (events[n].data.fd == m_wakeFd)
+        {
+          uint64_t count = 0;
+          if (read(m_wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+          {
+            Log("%s%s Error: Reading eventfd, Error - %s", TAG, __func__, strerror(errno));
+          }
+        }
         else if (events[n].data.fd == fd)
         {
           if (events[n].events & EPOLLIN)
           {
-            char buffer[BUFFER_SIZE] = {0};
-            ssize_t bytes_read = read(events[n].data.fd, buffer, sizeof(buffer));
+            BufferHandle buffer = m_pool.Acquire();
+            if (!buffer)
+            {
+              // Pool exhausted: leave the data in the socket until chunks are released
+              Log("%s%s Error: Buffer pool exhausted", TAG, __func__);
+              std::this_thread::sleep_for(POOL_RETRY_DURATION);
+              continue;
+            }
+            ssize_t bytes_read = read(events[n].data.fd, buffer.Data(), buffer.Capacity());
             if (bytes_read < 0)
             {
               Log("%s%s Error: Reading from FD - %d, Error - %s", TAG, __func__, events[n].data.fd, strerror(errno));
@@ -148,7 +292,11 @@ void SPPHandler::ReadBuffer()
               Log("%s%s Error: No data read from FD - %d", TAG, __func__, events[n].data.fd);
               m_readRunning = false;
             }
-            Log("%s%s Data - %s", TAG, __func__, buffer);
+            else
+            {
+              buffer.SetSize(bytes_read);
+              ProcessData(std::move(buffer));
+            }
           }
         }
       }
@@ -157,6 +305,7 @@ void SPPHandler::ReadBuffer()
     {
       break;
     }
+    m_transactions->Tick();
   }
 
   close(epoll_fd);
@@ -165,8 +314,10 @@ void SPPHandler::ReadBuffer()
 void SPPHandler::WriteBuffer()
 {
   Log("%s%s", TAG, __func__);
+  Trace::SetThreadName("SPPWriter-" + std::to_string(m_connectionId));
   uint64_t count = 0;
   uint64_t max_value = std::numeric_limits<uint64_t>::max();
+  char data[32] = {};
   while (m_writeRunning)
   {
     int fd = m_fd.get();
@@ -179,24 +330,195 @@ void SPPHandler::WriteBuffer()
     {
       count = 0;
     }
-    std::string data = "Ping " + std::to_string(count++);
-    ssize_t bytes_written = write(fd, data.c_str(), data.size());
+    int len = snprintf(data, sizeof(data), "Ping %" PRIu64, count++);
+    Log("%s%s Data - %.*s", TAG, __func__, len, data);
+    m_transactions->SendRequest(data, len, REQUEST_TIMEOUT, [this](SPPResponse response) {
+      switch (response.status)
+      {
+      case SPPTransactionStatus::Ok:
+        Log("%sWriteBuffer Response - %.*s", TAG, static_cast<int>(response.body.Size()), response.body.Data());
+        break;
+      case SPPTransactionStatus::Timeout:
+        Log("%sWriteBuffer Error: Request timed out", TAG);
+        break;
+      case SPPTransactionStatus::Closed:
+        m_writeRunning = false;
+        break;
+      default:
+        Log("%sWriteBuffer Error: Request not sent, Status - %d", TAG, static_cast<int>(response.status));
+        break;
+      }
+    });
+    if(!m_writeRunning) {
+      break;
+    }
+    std::this_thread::sleep_for(SLEEP_DURATION);
+  }
+}
+
+void SPPHandler::ProcessData(BufferHandle data)
+{
+  m_rxBytes->Add(data.Size());
+  if (m_capture)
+  {
+    m_capture->Record(m_connectionId, SPPCaptureDirection::Inbound, data.Data(), data.Size());
+  }
+  m_framer.Feed(data, [this](SPPFrame frame) { ProcessFrame(std::move(frame)); });
+}
+
+void SPPHandler::ProcessFrame(SPPFrame frame)
+{
+  if (!SPPFramer::Verify(frame))
+  {
+    ++m_checksumErrors;
+    Log("%s%s Error: Checksum mismatch, dropping frame - %zu bytes", TAG, __func__, frame.payload.Size());
+    return;
+  }
+  m_rxFrames->Add();
+  if (frame.flags & SPP_FRAME_FLAG_COMPRESSED)
+  {
+    BufferHandle plain = m_pool.Acquire();
+    if (!plain)
+    {
+      Log("%s%s Error: Buffer pool exhausted, dropping frame", TAG, __func__);
+      return;
+    }
+    long len = m_compressor.Decompress(reinterpret_cast<const uint8_t *>(frame.payload.Data()), frame.payload.Size(),
+                                       reinterpret_cast<uint8_t *>(plain.Data()), plain.Capacity());
+    if (len < 0)
+    {
+      Log("%s%s Error: Malformed compressed frame - %zu bytes", TAG, __func__, frame.payload.Size());
+      return;
+    }
+    plain.SetSize(len);
+    frame.payload = std::move(plain);
+    frame.flags &= ~SPP_FRAME_FLAG_COMPRESSED;
+  }
+  if (frame.flags & SPP_FRAME_FLAG_CONTROL)
+  {
+    ProcessControl(frame.payload);
+    return;
+  }
+  m_transactions->OnFrame(std::move(frame));
+}
+
+void SPPHandler::ProcessControl(const BufferHandle &payload)
+{
+  const uint8_t *message = reinterpret_cast<const uint8_t *>(payload.Data());
+  if (payload.Size() >= 2 && message[0] == SPP_CONTROL_HELLO)
+  {
+    bool compression = m_config.compression && (message[1] & SPP_CAPABILITY_COMPRESSION);
+    m_peerCompression = compression;
+    Log("%s%s Peer capabilities - 0x%02x, Compression - %s", TAG, __func__, message[1], compression ? "on" : "off");
+    return;
+  }
+  Log("%s%s Error: Unknown control message - %zu bytes", TAG, __func__, payload.Size());
+}
+
+void SPPHandler::SendHello()
+{
+  BufferHandle chunk = m_pool.Acquire();
+  if (!chunk)
+  {
+    Log("%s%s Error: Buffer pool exhausted", TAG, __func__);
+    return;
+  }
+  uint8_t *message = reinterpret_cast<uint8_t *>(SPPFramer::Payload(chunk));
+  message[0] = SPP_CONTROL_HELLO;
+  message[1] = m_config.compression ? SPP_CAPABILITY_COMPRESSION : 0;
+  SPPFramer::Seal(chunk, 2, SPP_FRAME_FLAG_CONTROL | m_checksumFlag);
+  Transmit(chunk);
+}
+
+bool SPPHandler::SendFrame(BufferHandle chunk, size_t payloadLen)
+{
+  uint8_t flags = m_checksumFlag;
+  if (m_peerCompression)
+  {
+    BufferHandle packed = m_pool.Acquire();
+    if (packed)
+    {
+      size_t packedLen = m_compressor.Compress(reinterpret_cast<const uint8_t *>(SPPFramer::Payload(chunk)), payloadLen,
+                                               reinterpret_cast<uint8_t *>(SPPFramer::Payload(packed)),
+                                               packed.Capacity() - SPP_FRAME_HEADER_SIZE - SPP_FRAME_TRAILER_MAX);
+      if (packedLen)
+      {
+        chunk = std::move(packed);
+        payloadLen = packedLen;
+        flags |= SPP_FRAME_FLAG_COMPRESSED;
+      }
+    }
+  }
+  if (!SPPFramer::Seal(chunk, payloadLen, flags))
+  {
+    Log("%s%s Error: Frame too large - %zu bytes", TAG, __func__, payloadLen);
+    return false;
+  }
+  return Transmit(chunk);
+}
+
+bool SPPHandler::Transmit(const BufferHandle &frame)
+{
+  m_txFrames->Add();
+  m_txBytes->Add(frame.Size());
+  if (m_capture)
+  {
+    m_capture->Record(m_connectionId, SPPCaptureDirection::Outbound, frame.Data(), frame.Size());
+  }
+  if (m_uring && m_uring->QueueWrite(frame))
+  {
+    return true;
+  }
+  return WriteData(frame);
+}
+
+void SPPHandler::WakeReader()
+{
+  if (m_uring && m_uring->IsActive())
+  {
+    m_uring->Wake();
+    return;
+  }
+  uint64_t one = 1;
+  if (m_wakeFd >= 0 && write(m_wakeFd, &one, sizeof(one)) < 0)
+  {
+    Log("%s%s Error: Writing to eventfd, Error - %s", TAG, __func__, strerror(errno));
+  }
+}
+
+bool SPPHandler::WriteData(const BufferHandle &data)
+{
+  // Reader (responses) and writer (requests) share the socket; a frame
+  // must go out whole, so short writes are finished under the lock
+  std::lock_guard<std::mutex> lock(m_writeMutex);
+  int fd = m_fd.get();
+  size_t offset = 0;
+  while (offset < data.Size())
+  {
+    ssize_t bytes_written = write(fd, data.Data() + offset, data.Size() - offset);
+    if (bytes_written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      struct pollfd pfd = {fd, POLLOUT, 0};
+      if (poll(&pfd, 1, WRITE_POLL_TIMEOUT_MS) <= 0)
+      {
+        Log("%s%s Error: FD - %d not writable", TAG, __func__, fd);
+        return false;
+      }
+      continue;
+    }
     if (bytes_written < 0)
     {
       Log("%s%s Error: Writing to FD - %d, Error - %d", TAG, __func__, fd, errno);
-      m_writeRunning = false;
+      return false;
     }
     else if (bytes_written == 0)
     {
       Log("%s%s Error: No data written to FD - %d", TAG, __func__, fd);
-      m_writeRunning = false;
+      return false;
     }
-    Log("%s%s Data - %s", TAG, __func__, data.c_str());
-    if(!m_writeRunning) {
-      break;
-    }
-    std::this_thread::sleep_for(SLEEP_DURATION);
+    offset += bytes_written;
   }
+  return true;
 }
 
 void SPPHandler::MakeSocketNonBlocking(int fd)
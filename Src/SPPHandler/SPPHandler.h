@@ -17,9 +17,19 @@
 #include <string>
 #include <stdexcept>
 #include <mutex>
+#include <memory>
 
 #include <sdbus-c++/sdbus-c++.h>
 
+#include "BufferPool.h"
+#include "Metrics.h"
+#include "SPPCapture.h"
+#include "SPPCompressor.h"
+#include "SPPConfig.h"
+#include "SPPFramer.h"
+#include "SPPTransaction.h"
+#include "SPPUring.h"
+
 /**
  * @class SPPHandler
  * @brief Handles Serial Port Profile (SPP) connections over Bluetooth
@@ -28,6 +38,19 @@
  * It handles reading from and writing to the SPP socket using separate
  * threads for concurrent operation. The class provides thread-safe
  * operations and proper resource cleanup.
+ *
+ * When built with HAVE_IO_URING the data path runs on an io_uring
+ * (see SPPUring) and falls back to epoll if the kernel lacks support.
+ *
+ * The byte stream is split into frames (see SPPFramer) carrying
+ * request/response messages (see SPPTransaction). Request deadlines are
+ * driven from the reader loop, which sleeps until the next one is due.
+ *
+ * On start each end may send a HELLO control frame listing its
+ * capabilities. Payloads are compressed only when both ends offered
+ * compression, and only when that makes the frame smaller. Outgoing frames
+ * may carry a CRC trailer; trailers on received frames are always checked
+ * and frames that fail are dropped.
  */
 class SPPHandler
 {
@@ -35,8 +58,12 @@ public:
   /**
    * @brief Construct a new SPP Handler object
    * @param fd Unix file descriptor for the SPP connection
+   * @param pool Chunk pool shared by all SPP connections
+   * @param config Options for this connection
+   * @param capture Capture receiving this connection's traffic, or null
+   * @param connectionId Id of this connection in the capture
    */
-  SPPHandler(sdbus::UnixFd fd);
+  SPPHandler(sdbus::UnixFd fd, BufferPool &pool, const SPPConfig &config, SPPCapture *capture = nullptr, uint32_t connectionId = 0);
   
   /**
    * @brief Destroy the SPP Handler object and cleanup resources
@@ -54,6 +81,12 @@ public:
    * connected Bluetooth device.
    */
   void StartOperations();
+
+  /**
+   * @brief Get the request/response layer of this connection
+   * @return Transaction layer used to send requests and answer incoming ones
+   */
+  SPPTransaction &Transactions() { return *m_transactions; }
   
 private:
   /**
@@ -72,6 +105,62 @@ private:
    */
   void WriteBuffer();
 
+  /**
+   * @brief Run the epoll based read loop
+   * @param fd SPP socket file descriptor
+   */
+  void ReadBufferEpoll(int fd);
+
+  /**
+   * @brief Handle data received from the SPP connection
+   * @param data Pool chunk holding the received bytes
+   */
+  void ProcessData(BufferHandle data);
+
+  /**
+   * @brief Handle a frame decoded from the SPP connection
+   * @param frame Decoded frame
+   */
+  void ProcessFrame(SPPFrame frame);
+
+  /**
+   * @brief Handle a link control message from the peer
+   * @param payload Control message
+   */
+  void ProcessControl(const BufferHandle &payload);
+
+  /**
+   * @brief Send the HELLO control message advertising our capabilities
+   */
+  void SendHello();
+
+  /**
+   * @brief Write data directly to the SPP socket
+   * @param data Pool chunk holding the bytes to write
+   * @return False if the write failed and the writer should stop
+   */
+  bool WriteData(const BufferHandle &data);
+
+  /**
+   * @brief Frame a message and send it on the active data path
+   * @param chunk Chunk whose frame payload area holds the message
+   * @param payloadLen Message length
+   * @return False if the frame could not be sent
+   */
+  bool SendFrame(BufferHandle chunk, size_t payloadLen);
+
+  /**
+   * @brief Send a sealed frame on the active data path
+   * @param frame Chunk holding the complete frame
+   * @return False if the frame could not be sent
+   */
+  bool Transmit(const BufferHandle &frame);
+
+  /**
+   * @brief Wake the reader loop so it picks up a new request deadline
+   */
+  void WakeReader();
+
   /**
    * @brief Make a socket non-blocking
    * @param fd File descriptor to make non-blocking
@@ -98,10 +187,28 @@ private:
   
 private:
   sdbus::UnixFd m_fd;              ///< SPP connection file descriptor
+  BufferPool &m_pool;              ///< Shared pool for read/write chunks
   int m_pipeCtrl[2] = {-1,-1};     ///< Control pipe for thread synchronization
   std::thread m_read_thread;       ///< Thread for reading SPP data
   std::atomic<bool> m_readRunning; ///< Flag to control read thread execution
   std::thread m_write_thread;      ///< Thread for writing SPP data
   std::atomic<bool> m_writeRunning;///< Flag to control write thread execution
   std::mutex m_sppMutex;           ///< Mutex for thread-safe operations
+  std::unique_ptr<SPPUring> m_uring;///< io_uring data path, null when using epoll
+  int m_wakeFd = -1;               ///< eventfd waking the epoll loop for new deadlines
+  std::mutex m_writeMutex;         ///< Serialises direct socket writes so frames stay whole
+  SPPConfig m_config;              ///< Options for this connection
+  SPPFramer m_framer;              ///< Decoder for received frames
+  SPPCompressor m_compressor;      ///< Payload codec and compression statistics
+  std::atomic<bool> m_peerCompression; ///< Both ends offered compression
+  uint8_t m_checksumFlag;          ///< Trailer flag added to outgoing frames
+  std::atomic<uint64_t> m_checksumErrors; ///< Received frames dropped for a bad trailer
+  SPPCapture *m_capture;           ///< Traffic capture, null when not capturing
+  uint32_t m_connectionId;         ///< Id of this connection in the capture
+  std::unique_ptr<SPPTransaction> m_transactions; ///< Request/response correlation
+  std::string m_metricLabels;      ///< Label set of this connection's metric series
+  Counter *m_rxBytes = nullptr;    ///< Bytes read from the socket
+  Counter *m_txBytes = nullptr;    ///< Bytes handed to the socket
+  Counter *m_rxFrames = nullptr;   ///< Frames received with a valid trailer
+  Counter *m_txFrames = nullptr;   ///< Frames sent
 };
@@ -0,0 +1,253 @@
+/**
+ * @file SPPTransaction.cpp
+ * @brief Implementation of the request/response correlation layer
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "SPPTransaction.h"
+
+#include "Logger.h"
+
+#define TAG "SPPTransaction::" ///< Tag for logging messages
+#define WHEEL_TICK_MS 10       ///< Timer wheel resolution
+#define WHEEL_SLOTS 512        ///< Timer wheel slots (about 5 s per revolution)
+
+SPPTransaction::SPPTransaction(BufferPool &pool, SendFunction send, std::function<void()> wake, size_t maxInflight) : m_pool(pool),
+                                                                                                                     m_send(std::move(send)),
+                                                                                                                     m_wake(std::move(wake)),
+                                                                                                                     m_maxInflight(maxInflight),
+                                                                                                                     m_timeouts(WHEEL_TICK_MS, WHEEL_SLOTS, NowMs())
+{
+  Log("%s%s", TAG, __func__);
+}
+
+SPPTransaction::~SPPTransaction()
+{
+  Log("%s%s", TAG, __func__);
+  Close();
+}
+
+uint64_t SPPTransaction::NowMs()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SPPTransaction::SetRequestHandler(RequestHandler handler)
+{
+  std::lock_guard<std::mutex> lock(m_transactionMutex);
+  m_requestHandler = std::move(handler);
+}
+
+SPPTransactionStatus SPPTransaction::Send(SPPMessageType type, uint32_t seq, const char *data, size_t len)
+{
+  BufferHandle chunk = m_pool.Acquire();
+  if (!chunk)
+  {
+    return SPPTransactionStatus::NoBuffer;
+  }
+  if (SPP_FRAME_HEADER_SIZE + SPP_MESSAGE_HEADER_SIZE + len + SPP_FRAME_TRAILER_MAX > chunk.Capacity())
+  {
+    return SPPTransactionStatus::NoBuffer;
+  }
+  uint8_t *payload = reinterpret_cast<uint8_t *>(SPPFramer::Payload(chunk));
+  payload[0] = static_cast<uint8_t>(type);
+  payload[1] = seq & 0xFF;
+  payload[2] = (seq >> 8) & 0xFF;
+  payload[3] = (seq >> 16) & 0xFF;
+  payload[4] = (seq >> 24) & 0xFF;
+  memcpy(payload + SPP_MESSAGE_HEADER_SIZE, data, len);
+  if (!m_send(std::move(chunk), SPP_MESSAGE_HEADER_SIZE + len))
+  {
+    return SPPTransactionStatus::Closed;
+  }
+  return SPPTransactionStatus::Ok;
+}
+
+uint32_t SPPTransaction::SendRequest(const char *data, size_t len, std::chrono::milliseconds timeout, ResponseCallback callback)
+{
+  uint32_t seq = 0;
+  bool earliestDeadline = false;
+  bool busy = false;
+  {
+    std::lock_guard<std::mutex> lock(m_transactionMutex);
+    if (m_inflight.size() >= m_maxInflight)
+    {
+      Log("%s%s Error: %zu requests in flight", TAG, __func__, m_inflight.size());
+      busy = true;
+    }
+    else
+    {
+      seq = m_nextSeq++;
+      if (m_nextSeq == 0)
+      {
+        m_nextSeq = 1;
+      }
+      uint64_t nowMs = NowMs();
+      int untilEarliest = m_timeouts.NextTimeoutMs(nowMs);
+      earliestDeadline = untilEarliest < 0 || timeout.count() < untilEarliest;
+      m_inflight[seq] = std::move(callback);
+      m_timeouts.Schedule(seq, nowMs + timeout.count());
+    }
+  }
+  // Like every other completion, outside the lock so the callback may send again
+  if (busy)
+  {
+    callback({SPPTransactionStatus::Busy, BufferHandle()});
+    return 0;
+  }
+  // The reader loop sleeps until the earliest deadline, or without a timeout
+  if (earliestDeadline && m_wake)
+  {
+    m_wake();
+  }
+
+  SPPTransactionStatus status = Send(SPPMessageType::Request, seq, data, len);
+  if (status != SPPTransactionStatus::Ok)
+  {
+    ResponseCallback failed;
+    {
+      std::lock_guard<std::mutex> lock(m_transactionMutex);
+      auto it = m_inflight.find(seq);
+      if (it != m_inflight.end())
+      {
+        failed = std::move(it->second);
+        m_inflight.erase(it);
+        m_timeouts.Cancel(seq);
+      }
+    }
+    if (failed)
+    {
+      failed({status, BufferHandle()});
+    }
+    return 0;
+  }
+  return seq;
+}
+
+std::future<SPPResponse> SPPTransaction::SendRequest(const char *data, size_t len, std::chrono::milliseconds timeout)
+{
+  auto promise = std::make_shared<std::promise<SPPResponse>>();
+  auto future = promise->get_future();
+  SendRequest(data, len, timeout, [promise](SPPResponse response) { promise->set_value(std::move(response)); });
+  return future;
+}
+
+bool SPPTransaction::Respond(uint32_t seq, const char *data, size_t len)
+{
+  SPPTransactionStatus status = Send(SPPMessageType::Response, seq, data, len);
+  if (status != SPPTransactionStatus::Ok)
+  {
+    Log("%s%s Error: Couldn't send response Seq - %u", TAG, __func__, seq);
+    return false;
+  }
+  return true;
+}
+
+void SPPTransaction::OnFrame(SPPFrame frame)
+{
+  if (frame.payload.Size() < SPP_MESSAGE_HEADER_SIZE)
+  {
+    Log("%s%s Error: Short message - %zu bytes", TAG, __func__, frame.payload.Size());
+    return;
+  }
+  const uint8_t *header = reinterpret_cast<const uint8_t *>(frame.payload.Data());
+  uint32_t seq = header[1] | (header[2] << 8) | (header[3] << 16) | (static_cast<uint32_t>(header[4]) << 24);
+  BufferHandle body = frame.payload.Slice(SPP_MESSAGE_HEADER_SIZE, frame.payload.Size() - SPP_MESSAGE_HEADER_SIZE);
+
+  switch (static_cast<SPPMessageType>(header[0]))
+  {
+  case SPPMessageType::Request:
+  {
+    RequestHandler handler;
+    {
+      std::lock_guard<std::mutex> lock(m_transactionMutex);
+      handler = m_requestHandler;
+    }
+    if (handler)
+    {
+      handler(seq, std::move(body));
+    }
+    break;
+  }
+  case SPPMessageType::Response:
+  {
+    ResponseCallback callback;
+    {
+      std::lock_guard<std::mutex> lock(m_transactionMutex);
+      auto it = m_inflight.find(seq);
+      if (it != m_inflight.end())
+      {
+        callback = std::move(it->second);
+        m_inflight.erase(it);
+        m_timeouts.Cancel(seq);
+      }
+    }
+    if (callback)
+    {
+      callback({SPPTransactionStatus::Ok, std::move(body)});
+    }
+    else
+    {
+      Log("%s%s Late or unknown response Seq - %u", TAG, __func__, seq);
+    }
+    break;
+  }
+  default:
+    Log("%s%s Error: Unknown message type - %u", TAG, __func__, header[0]);
+    break;
+  }
+}
+
+void SPPTransaction::Tick()
+{
+  std::vector<ResponseCallback> expired;
+  {
+    std::lock_guard<std::mutex> lock(m_transactionMutex);
+    m_timeouts.Advance(NowMs(), [this, &expired](uint32_t seq) {
+      auto it = m_inflight.find(seq);
+      if (it != m_inflight.end())
+      {
+        Log("%sTick Timeout Seq - %u", TAG, seq);
+        expired.push_back(std::move(it->second));
+        m_inflight.erase(it);
+      }
+    });
+  }
+  for (auto &callback : expired)
+  {
+    callback({SPPTransactionStatus::Timeout, BufferHandle()});
+  }
+}
+
+int SPPTransaction::NextTimeoutMs()
+{
+  std::lock_guard<std::mutex> lock(m_transactionMutex);
+  return m_timeouts.NextTimeoutMs(NowMs());
+}
+
+void SPPTransaction::Close()
+{
+  std::unordered_map<uint32_t, ResponseCallback> pending;
+  {
+    std::lock_guard<std::mutex> lock(m_transactionMutex);
+    pending.swap(m_inflight);
+    for (const auto &request : pending)
+    {
+      m_timeouts.Cancel(request.first);
+    }
+  }
+  for (auto &request : pending)
+  {
+    request.second({SPPTransactionStatus::Closed, BufferHandle()});
+  }
+}
+
+size_t SPPTransaction::InFlight()
+{
+  std::lock_guard<std::mutex> lock(m_transactionMutex);
+  return m_inflight.size();
+}
@@ -0,0 +1,180 @@
+/**
+ * @file SPPTransaction.h
+ * @brief Request/response correlation layer on top of SPP framing
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
+#include "BufferPool.h"
+#include "SPPFramer.h"
+#include "TimerWheel.h"
+
+#define SPP_MESSAGE_HEADER_SIZE 5 ///< Message type and 32-bit little-endian sequence id
+
+/**
+ * @enum SPPMessageType
+ * @brief Message types carried in the first byte of a frame payload
+ */
+enum class SPPMessageType : uint8_t
+{
+  Request = 1,  ///< Request expecting a response with the same sequence id
+  Response = 2  ///< Response to an earlier request
+};
+
+/**
+ * @enum SPPTransactionStatus
+ * @brief Completion status of a request
+ */
+enum class SPPTransactionStatus
+{
+  Ok,        ///< Response received
+  Timeout,   ///< No response before the deadline
+  Closed,    ///< Connection closed or send failed
+  Busy,      ///< Too many requests in flight on this link
+  NoBuffer   ///< Buffer pool exhausted or request too large
+};
+
+/**
+ * @struct SPPResponse
+ * @brief Outcome of a request
+ */
+typedef struct
+{
+  SPPTransactionStatus status; ///< Completion status
+  BufferHandle body;           ///< Response body when status is Ok
+} SPPResponse;
+
+/**
+ * @class SPPTransaction
+ * @brief Correlates requests and responses over one SPP link
+ *
+ * Each request gets a sequence id and an entry in the in-flight table; its
+ * deadline lives in a hashed timer wheel driven by the link's reader loop.
+ * Any number of requests (up to the in-flight limit) may be outstanding at
+ * once, and responses may arrive in any order. Completion is reported via a
+ * callback or a std::future. Incoming requests are passed to the request
+ * handler, which answers with Respond(), possibly later from another thread.
+ */
+class SPPTransaction
+{
+public:
+  /// Sends a chunk whose frame payload area holds payloadLen bytes
+  using SendFunction = std::function<bool(BufferHandle chunk, size_t payloadLen)>;
+  /// Invoked once per request with its outcome
+  using ResponseCallback = std::function<void(SPPResponse response)>;
+  /// Invoked for each incoming request
+  using RequestHandler = std::function<void(uint32_t seq, BufferHandle body)>;
+
+  /**
+   * @brief Construct a new SPPTransaction object
+   * @param pool Pool used for outgoing messages
+   * @param send Function that frames and writes a message
+   * @param wake Function that wakes the reader loop so it picks up a new deadline
+   * @param maxInflight Maximum number of outstanding requests
+   */
+  SPPTransaction(BufferPool &pool, SendFunction send, std::function<void()> wake, size_t maxInflight);
+
+  /**
+   * @brief Destroy the SPPTransaction object, failing outstanding requests
+   */
+  ~SPPTransaction();
+
+  /**
+   * @brief Set the handler for incoming requests
+   * @param handler Request handler
+   */
+  void SetRequestHandler(RequestHandler handler);
+
+  /**
+   * @brief Send a request and report the outcome through a callback
+   * @param data Request body
+   * @param len Request body length
+   * @param timeout Time to wait for the response
+   * @param callback Invoked exactly once with the outcome
+   * @return Sequence id of the request, or 0 if it failed immediately
+   */
+  uint32_t SendRequest(const char *data, size_t len, std::chrono::milliseconds timeout, ResponseCallback callback);
+
+  /**
+   * @brief Send a request and return a future for the outcome
+   * @param data Request body
+   * @param len Request body length
+   * @param timeout Time to wait for the response
+   * @return Future completed with the outcome
+   */
+  std::future<SPPResponse> SendRequest(const char *data, size_t len, std::chrono::milliseconds timeout);
+
+  /**
+   * @brief Send the response to an incoming request
+   * @param seq Sequence id of the request
+   * @param data Response body
+   * @param len Response body length
+   * @return False if the response could not be sent
+   */
+  bool Respond(uint32_t seq, const char *data, size_t len);
+
+  /**
+   * @brief Handle a frame received on the link
+   * @param frame Decoded frame
+   */
+  void OnFrame(SPPFrame frame);
+
+  /**
+   * @brief Expire requests whose deadline has passed
+   */
+  void Tick();
+
+  /**
+   * @brief Get the time the reader loop may sleep before calling Tick()
+   * @return Milliseconds, or -1 if no request is outstanding
+   */
+  int NextTimeoutMs();
+
+  /**
+   * @brief Fail every outstanding request with SPPTransactionStatus::Closed
+   */
+  void Close();
+
+  /**
+   * @brief Get the number of outstanding requests
+   * @return In-flight request count
+   */
+  size_t InFlight();
+
+private:
+  /**
+   * @brief Build and send a message
+   * @param type Message type
+   * @param seq Sequence id
+   * @param data Message body
+   * @param len Message body length
+   * @return Status describing why the send failed, or Ok
+   */
+  SPPTransactionStatus Send(SPPMessageType type, uint32_t seq, const char *data, size_t len);
+
+  /**
+   * @brief Get the current time for the timer wheel
+   * @return Milliseconds on the steady clock
+   */
+  static uint64_t NowMs();
+
+private:
+  BufferPool &m_pool;                                        ///< Pool for outgoing messages
+  SendFunction m_send;                                       ///< Frames and writes a message
+  std::function<void()> m_wake;                              ///< Wakes the reader loop
+  size_t m_maxInflight;                                      ///< In-flight request limit
+  RequestHandler m_requestHandler;                           ///< Handler for incoming requests
+  std::mutex m_transactionMutex;                             ///< Protects the members below
+  uint32_t m_nextSeq = 1;                                    ///< Next sequence id (0 is never used)
+  std::unordered_map<uint32_t, ResponseCallback> m_inflight; ///< Outstanding requests by sequence id
+  TimerWheel m_timeouts;                                     ///< Request deadlines
+};
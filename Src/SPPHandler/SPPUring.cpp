@@ -0,0 +1,532 @@
+/**
+ * @file SPPUring.cpp
+ * @brief Implementation of the optional io_uring backend for the SPP data path
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <chrono>
+#include <cstring>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "SPPUring.h"
+
+#include "Logger.h"
+
+#define TAG "SPPUring::"            ///< Tag for logging messages
+#define RING_DEPTH 64               ///< Submission queue entries
+#define RECV_BUFFER_COUNT 64        ///< Provided buffers (must be a power of two)
+#define RECV_BUFFER_GROUP 0         ///< Buffer group id used by the multishot recv
+#define REFILL_INTERVAL_NS 10000000 ///< Retry interval when the pool is exhausted (10 ms)
+#define WRITE_CHAIN_MAX 32          ///< Sends linked into one chain
+#define RESERVED_SQES 4             ///< Entries kept free for re-arming receive, polls and timers
+
+/// user_data tags identifying the operation a completion belongs to
+enum : uint64_t
+{
+  TAG_RECV = 1,
+  TAG_STOP,
+  TAG_WAKE,
+  TAG_WRITE,
+  TAG_REFILL,
+  TAG_TICK
+};
+
+SPPUring::SPPUring(int fd, int stopFd, BufferPool &pool) : m_pool(pool),
+                                                           m_fd(fd),
+                                                           m_stopFd(stopFd),
+                                                           m_active(false)
+{
+  Log("%s%s", TAG, __func__);
+}
+
+SPPUring::~SPPUring()
+{
+  Log("%s%s", TAG, __func__);
+#ifdef HAVE_IO_URING
+  Cleanup();
+#endif
+  if (m_wakeFd >= 0)
+  {
+    close(m_wakeFd);
+  }
+}
+
+std::deque<BufferHandle> SPPUring::TakePendingWrites()
+{
+  std::lock_guard<std::mutex> lock(m_writeMutex);
+  std::deque<BufferHandle> pending;
+  pending.swap(m_pendingWrites);
+  return pending;
+}
+
+bool SPPUring::QueueWrite(BufferHandle data)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    if (!m_active)
+    {
+      return false;
+    }
+    m_pendingWrites.push_back(std::move(data));
+  }
+  Wake();
+  return true;
+}
+
+void SPPUring::Wake()
+{
+  uint64_t one = 1;
+  if (m_wakeFd >= 0 && write(m_wakeFd, &one, sizeof(one)) < 0)
+  {
+    Log("%s%s Error: Writing to eventfd, Error - %s", TAG, __func__, strerror(errno));
+  }
+}
+
+#ifndef HAVE_IO_URING
+
+bool SPPUring::Init()
+{
+  Log("%s%s io_uring support not compiled in", TAG, __func__);
+  return false;
+}
+
+SPPUring::RunResult SPPUring::Run(std::atomic<bool> &, const DataCallback &, const TimerCallback &)
+{
+  return RunResult::Unsupported;
+}
+
+#else
+
+bool SPPUring::Init()
+{
+  Log("%s%s", TAG, __func__);
+  int ret = io_uring_queue_init(RING_DEPTH, &m_ring, 0);
+  if (ret < 0)
+  {
+    Log("%s%s io_uring unavailable, Error - %s", TAG, __func__, strerror(-ret));
+    return false;
+  }
+  m_ringReady = true;
+
+  // Provided-buffer rings need Linux 5.19+
+  m_bufRing = io_uring_setup_buf_ring(&m_ring, RECV_BUFFER_COUNT, RECV_BUFFER_GROUP, 0, &ret);
+  if (!m_bufRing)
+  {
+    Log("%s%s Provided buffer ring unavailable, Error - %s", TAG, __func__, strerror(-ret));
+    Cleanup();
+    return false;
+  }
+  m_ringBuffers.resize(RECV_BUFFER_COUNT);
+
+  m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_wakeFd < 0)
+  {
+    Log("%s%s Error: Creating eventfd, Error - %s", TAG, __func__, strerror(errno));
+    Cleanup();
+    return false;
+  }
+
+  m_active = true;
+  return true;
+}
+
+void SPPUring::Cleanup()
+{
+  if (m_bufRing)
+  {
+    io_uring_free_buf_ring(&m_ring, m_bufRing, RECV_BUFFER_COUNT, RECV_BUFFER_GROUP);
+    m_bufRing = nullptr;
+  }
+  if (m_ringReady)
+  {
+    // Waits for outstanding requests, so the chunks below can be returned safely
+    io_uring_queue_exit(&m_ring);
+    m_ringReady = false;
+  }
+  m_ringBuffers.clear();
+  m_outgoing.clear();
+  m_chainLength = 0;
+  m_chainCursor = 0;
+  m_tickDueMs = 0;
+  m_active = false;
+}
+
+bool SPPUring::ArmReceive()
+{
+  struct io_uring_sqe *sqe = io_uring_get_sqe(&m_ring);
+  if (!sqe)
+  {
+    return false;
+  }
+  io_uring_prep_recv_multishot(sqe, m_fd, nullptr, 0, 0);
+  sqe->flags |= IOSQE_BUFFER_SELECT;
+  sqe->buf_group = RECV_BUFFER_GROUP;
+  io_uring_sqe_set_data64(sqe, TAG_RECV);
+  m_recvArmed = true;
+  return true;
+}
+
+bool SPPUring::ArmPoll(int fd, uint64_t tag, bool multishot)
+{
+  struct io_uring_sqe *sqe = io_uring_get_sqe(&m_ring);
+  if (!sqe)
+  {
+    return false;
+  }
+  if (multishot)
+  {
+    io_uring_prep_poll_multishot(sqe, fd, POLLIN);
+  }
+  else
+  {
+    io_uring_prep_poll_add(sqe, fd, POLLIN);
+  }
+  io_uring_sqe_set_data64(sqe, tag);
+  return true;
+}
+
+bool SPPUring::ArmRefillTimer()
+{
+  static struct __kernel_timespec interval = {0, REFILL_INTERVAL_NS};
+  struct io_uring_sqe *sqe = io_uring_get_sqe(&m_ring);
+  if (!sqe)
+  {
+    return false;
+  }
+  io_uring_prep_timeout(sqe, &interval, 0, 0);
+  io_uring_sqe_set_data64(sqe, TAG_REFILL);
+  m_refillArmed = true;
+  return true;
+}
+
+uint64_t SPPUring::NowMs()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool SPPUring::ArmTickTimer(int timeoutMs)
+{
+  struct io_uring_sqe *sqe = io_uring_get_sqe(&m_ring);
+  if (!sqe)
+  {
+    return false;
+  }
+  m_tickInterval.tv_sec = timeoutMs / 1000;
+  m_tickInterval.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000;
+  io_uring_prep_timeout(sqe, &m_tickInterval, 0, 0);
+  io_uring_sqe_set_data64(sqe, TAG_TICK);
+  m_tickDueMs = NowMs() + timeoutMs;
+  return true;
+}
+
+bool SPPUring::RefillBuffer(uint16_t bid)
+{
+  BufferHandle chunk = m_pool.Acquire();
+  if (!chunk)
+  {
+    return false;
+  }
+  io_uring_buf_ring_add(m_bufRing, chunk.Data(), chunk.Capacity(), bid,
+                        io_uring_buf_ring_mask(RECV_BUFFER_COUNT), 0);
+  io_uring_buf_ring_advance(m_bufRing, 1);
+  m_ringBuffers[bid] = std::move(chunk);
+  return true;
+}
+
+void SPPUring::RefillBuffers()
+{
+  bool starved = false;
+  bool lent = false;
+  for (uint16_t bid = 0; bid < RECV_BUFFER_COUNT; ++bid)
+  {
+    if (!m_ringBuffers[bid] && !starved && !RefillBuffer(bid))
+    {
+      starved = true;
+    }
+    lent = lent || static_cast<bool>(m_ringBuffers[bid]);
+  }
+  if (starved && !m_refillArmed)
+  {
+    ArmRefillTimer();
+  }
+  // Re-arming with an empty ring would only complete with ENOBUFS again
+  if (lent && !m_recvArmed)
+  {
+    ArmReceive();
+  }
+}
+
+void SPPUring::SubmitPendingWrites()
+{
+  uint64_t count = 0;
+  if (read(m_wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+  {
+    Log("%s%s Error: Reading eventfd, Error - %s", TAG, __func__, strerror(errno));
+  }
+
+  for (BufferHandle &data : TakePendingWrites())
+  {
+    m_outgoing.push_back({std::move(data), 0});
+  }
+  SubmitWrites();
+}
+
+void SPPUring::SubmitWrites()
+{
+  // One chain at a time: separate chains could reach the socket out of order
+  if (m_chainLength || m_outgoing.empty())
+  {
+    return;
+  }
+  if (io_uring_sq_space_left(&m_ring) <= RESERVED_SQES)
+  {
+    int ret = io_uring_submit(&m_ring);
+    if (ret < 0)
+    {
+      // Retried after the next completion
+      Log("%s%s Deferring writes, Error - %s", TAG, __func__, strerror(-ret));
+      return;
+    }
+  }
+  struct io_uring_sqe *previous = nullptr;
+  while (m_chainLength < m_outgoing.size() && m_chainLength < WRITE_CHAIN_MAX &&
+         io_uring_sq_space_left(&m_ring) > RESERVED_SQES)
+  {
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&m_ring);
+    if (!sqe)
+    {
+      break;
+    }
+    // Link to the previous send so the chain reaches the socket in order
+    if (previous)
+    {
+      previous->flags |= IOSQE_IO_LINK;
+    }
+    const OutgoingWrite &write = m_outgoing[m_chainLength];
+    io_uring_prep_send(sqe, m_fd, write.data.Data() + write.offset, write.data.Size() - write.offset, MSG_NOSIGNAL);
+    io_uring_sqe_set_data64(sqe, TAG_WRITE);
+    previous = sqe;
+    ++m_chainLength;
+  }
+}
+
+bool SPPUring::CompleteWrite(int res)
+{
+  if (!m_chainLength)
+  {
+    return true;
+  }
+  --m_chainLength;
+  OutgoingWrite &write = m_outgoing[m_chainCursor];
+  bool ok = res >= 0 || res == -ECANCELED;
+  if (!ok)
+  {
+    Log("%s%s Error: Writing to FD - %d, Error - %s", TAG, __func__, m_fd, strerror(-res));
+  }
+  else if (res > 0)
+  {
+    write.offset += static_cast<size_t>(res);
+  }
+  if (ok && m_chainCursor == 0 && write.offset == write.data.Size())
+  {
+    m_outgoing.pop_front();
+  }
+  else
+  {
+    // A short send breaks the chain and cancels the sends after it; they
+    // stay queued and go out again, from where they stopped, in order
+    ++m_chainCursor;
+  }
+  if (!m_chainLength)
+  {
+    m_chainCursor = 0;
+  }
+  return ok;
+}
+
+void SPPUring::FinishWrites()
+{
+  // Submits sends prepared in the last batch too, so none is left half queued
+  while (m_chainLength)
+  {
+    int ret = io_uring_submit_and_wait(&m_ring, 1);
+    if (ret < 0 && ret != -EINTR)
+    {
+      // Whether the sends in flight reached the socket is unknown; resending could duplicate them
+      Log("%s%s Error: io_uring_submit_and_wait, Dropping %zu writes, Error - %s", TAG, __func__, m_chainLength, strerror(-ret));
+      m_outgoing.erase(m_outgoing.begin(), m_outgoing.begin() + m_chainLength);
+      m_chainLength = 0;
+      m_chainCursor = 0;
+      return;
+    }
+    struct io_uring_cqe *cqe = nullptr;
+    unsigned head = 0;
+    unsigned seen = 0;
+    io_uring_for_each_cqe(&m_ring, head, cqe)
+    {
+      ++seen;
+      if (io_uring_cqe_get_data64(cqe) == TAG_WRITE)
+      {
+        CompleteWrite(cqe->res);
+      }
+    }
+    io_uring_cq_advance(&m_ring, seen);
+  }
+}
+
+SPPUring::RunResult SPPUring::Run(std::atomic<bool> &running, const DataCallback &onData, const TimerCallback &onTimer)
+{
+  Log("%s%s", TAG, __func__);
+  if (!m_active)
+  {
+    return RunResult::Unsupported;
+  }
+  RefillBuffers();
+  if (!m_recvArmed || !ArmPoll(m_stopFd, TAG_STOP, false) || !ArmPoll(m_wakeFd, TAG_WAKE, true))
+  {
+    Log("%s%s Error: Could not arm receive", TAG, __func__);
+    m_active = false;
+    return RunResult::Unsupported;
+  }
+
+  bool received = false;
+  RunResult result = RunResult::Stopped;
+  while (running && result != RunResult::Unsupported)
+  {
+    int ret = io_uring_submit_and_wait(&m_ring, 1);
+    if (ret < 0 && ret != -EINTR)
+    {
+      Log("%s%s Error: io_uring_submit_and_wait, Error - %s", TAG, __func__, strerror(-ret));
+      running = false;
+      break;
+    }
+
+    // Drain every available completion before the next syscall
+    struct io_uring_cqe *cqe = nullptr;
+    unsigned head = 0;
+    unsigned seen = 0;
+    bool refill = false;
+    io_uring_for_each_cqe(&m_ring, head, cqe)
+    {
+      ++seen;
+      switch (io_uring_cqe_get_data64(cqe))
+      {
+      case TAG_RECV:
+        if (!(cqe->flags & IORING_CQE_F_MORE))
+        {
+          m_recvArmed = false;
+          refill = true;
+        }
+        if (cqe->res == -EINVAL && !received)
+        {
+          // Multishot recv needs Linux 6.0+
+          Log("%s%s Multishot recv unsupported, falling back to epoll", TAG, __func__);
+          result = RunResult::Unsupported;
+        }
+        else if (cqe->res == -ENOBUFS)
+        {
+          // Every chunk is in flight; re-armed once the ring is replenished
+        }
+        else if (cqe->res < 0)
+        {
+          Log("%s%s Error: Reading from FD - %d, Error - %s", TAG, __func__, m_fd, strerror(-cqe->res));
+          running = false;
+        }
+        else if (cqe->res == 0)
+        {
+          Log("%s%s Error: No data read from FD - %d", TAG, __func__, m_fd);
+          running = false;
+        }
+        else if (cqe->flags & IORING_CQE_F_BUFFER)
+        {
+          received = true;
+          uint16_t bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+          BufferHandle chunk = std::move(m_ringBuffers[bid]);
+          chunk.SetSize(cqe->res);
+          onData(std::move(chunk));
+          refill = true;
+        }
+        break;
+      case TAG_STOP:
+        Log("%s%s Pipe event", TAG, __func__);
+        running = false;
+        break;
+      case TAG_WAKE:
+        SubmitPendingWrites();
+        if (!(cqe->flags & IORING_CQE_F_MORE))
+        {
+          ArmPoll(m_wakeFd, TAG_WAKE, true);
+        }
+        break;
+      case TAG_WRITE:
+        if (!CompleteWrite(cqe->res))
+        {
+          running = false;
+        }
+        break;
+      case TAG_REFILL:
+        m_refillArmed = false;
+        refill = true;
+        break;
+      case TAG_TICK:
+        // Which timer fired is unknown; the next pass re-arms for the earliest deadline
+        m_tickDueMs = 0;
+        break;
+      default:
+        break;
+      }
+    }
+    io_uring_cq_advance(&m_ring, seen);
+    if (refill && running)
+    {
+      RefillBuffers();
+    }
+    if (result == RunResult::Unsupported)
+    {
+      break;
+    }
+    // Resends the rest of a broken chain, the next chain, or writes deferred on a full ring
+    if (running)
+    {
+      SubmitWrites();
+    }
+    // Asked every pass: a request sent meanwhile may be due before the armed timer
+    if (onTimer && running)
+    {
+      int timeoutMs = onTimer();
+      if (timeoutMs >= 0 && (!m_tickDueMs || NowMs() + timeoutMs < m_tickDueMs))
+      {
+        ArmTickTimer(timeoutMs);
+      }
+    }
+  }
+
+  if (result == RunResult::Unsupported)
+  {
+    FinishWrites();
+  }
+
+  // Writes queued after this point go straight to the socket; anything left
+  // in m_pendingWrites is picked up by the caller through TakePendingWrites()
+  {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    m_active = false;
+    if (result == RunResult::Unsupported)
+    {
+      // Writes the ring took over but did not finish go first, from where they stopped
+      for (auto it = m_outgoing.rbegin(); it != m_outgoing.rend(); ++it)
+      {
+        m_pendingWrites.push_front(it->offset ? it->data.Slice(it->offset, it->data.Size() - it->offset) : std::move(it->data));
+      }
+      m_outgoing.clear();
+    }
+  }
+  Cleanup();
+  return result;
+}
+
+#endif
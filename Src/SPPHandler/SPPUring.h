@@ -0,0 +1,159 @@
+/**
+ * @file SPPUring.h
+ * @brief Optional io_uring backend for the SPP data path
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef HAVE_IO_URING
+#include <liburing.h>
+#endif
+
+#include "BufferPool.h"
+
+/**
+ * @class SPPUring
+ * @brief io_uring based receive/transmit loop for a single SPP socket
+ *
+ * Receives are issued as one multishot recv that picks buffers from a
+ * registered provided-buffer ring, so a stream of inbound data costs no
+ * per-read syscall. The provided buffers are BufferPool chunks: a completed
+ * receive is handed on as a BufferHandle and its ring slot is refilled with
+ * a fresh chunk, so received data is never copied. If the pool runs dry the
+ * ring drains and is refilled on a short timer, which throttles the link.
+ * Writes queued from other threads are handed to the ring owner through an
+ * eventfd and submitted as a chain of linked SQEs in a single
+ * io_uring_enter call.
+ *
+ * The class is always compiled; without HAVE_IO_URING (or when the running
+ * kernel lacks provided-buffer rings or multishot recv) Init() or Run()
+ * report failure and the caller falls back to the epoll loop.
+ */
+class SPPUring
+{
+public:
+  /// Callback invoked on the ring thread for every chunk received
+  using DataCallback = std::function<void(BufferHandle data)>;
+  /// Callback invoked on the ring thread after each batch of completions;
+  /// returns the milliseconds until it wants to run again, or -1 for never
+  using TimerCallback = std::function<int()>;
+
+  /**
+   * @brief Result of running the ring loop
+   */
+  enum class RunResult
+  {
+    Stopped,     ///< Loop exited because of shutdown, EOF or socket error
+    Unsupported  ///< Kernel rejected multishot recv; caller should use epoll
+  };
+
+  /**
+   * @brief Construct a new SPPUring object
+   * @param fd SPP socket file descriptor (not owned)
+   * @param stopFd Read end of the control pipe used to request shutdown (not owned)
+   * @param pool Pool supplying receive buffers
+   */
+  SPPUring(int fd, int stopFd, BufferPool &pool);
+
+  /**
+   * @brief Destroy the SPPUring object and release the ring and buffers
+   */
+  ~SPPUring();
+
+  /**
+   * @brief Set up the ring, the provided-buffer ring and the write eventfd
+   * @return True if io_uring can be used, false if the caller must fall back to epoll
+   */
+  bool Init();
+
+  /**
+   * @brief Run the receive/transmit loop until shutdown or connection loss
+   * @param running Flag cleared by the loop when the connection terminates
+   * @param onData Callback for received data
+   * @param onTimer Optional callback driving timers owned by the caller
+   * @return RunResult::Unsupported if the kernel rejected the multishot receive
+   */
+  RunResult Run(std::atomic<bool> &running, const DataCallback &onData, const TimerCallback &onTimer = nullptr);
+
+  /**
+   * @brief Queue data to be written by the ring thread
+   * @param data Chunk to write; the ring holds a reference until completion
+   * @return False if the ring is not (or no longer) active
+   */
+  bool QueueWrite(BufferHandle data);
+
+  /**
+   * @brief Wake the ring thread so it re-evaluates the timer callback
+   */
+  void Wake();
+
+  /**
+   * @brief Check whether the ring owns the data path
+   * @return True between a successful Init() and the end of Run()
+   */
+  bool IsActive() const { return m_active; }
+
+  /**
+   * @brief Take writes that were queued but never submitted
+   *
+   * Used after Run() returns Unsupported so the epoll path can send them;
+   * writes the ring had started come first, without the bytes already sent.
+   * @return Pending write buffers in submission order
+   */
+  std::deque<BufferHandle> TakePendingWrites();
+
+private:
+#ifdef HAVE_IO_URING
+  bool ArmReceive();
+  bool ArmPoll(int fd, uint64_t tag, bool multishot);
+  bool ArmRefillTimer();
+  bool ArmTickTimer(int timeoutMs);
+  static uint64_t NowMs();
+  bool RefillBuffer(uint16_t bid);
+  void RefillBuffers();
+  void SubmitPendingWrites();
+  void SubmitWrites();
+  bool CompleteWrite(int res);
+  void FinishWrites();
+  void Cleanup();
+
+  /**
+   * @struct OutgoingWrite
+   * @brief Write taken over by the ring, with the bytes already sent
+   */
+  typedef struct
+  {
+    BufferHandle data; ///< Frame to send
+    size_t offset;     ///< Bytes of data already on the socket
+  } OutgoingWrite;
+
+  struct io_uring m_ring = {};                  ///< Submission/completion ring
+  struct io_uring_buf_ring *m_bufRing = nullptr;///< Provided-buffer ring shared with the kernel
+  std::vector<BufferHandle> m_ringBuffers;      ///< Pool chunks lent to the kernel, indexed by buffer id
+  bool m_ringReady = false;                     ///< io_uring_queue_init succeeded
+  bool m_recvArmed = false;                     ///< Multishot recv is outstanding
+  bool m_refillArmed = false;                   ///< Refill timer is outstanding
+  uint64_t m_tickDueMs = 0;                     ///< Due time of the earliest caller timer outstanding, 0 if none
+  struct __kernel_timespec m_tickInterval = {}; ///< Caller timer interval, read by the kernel at submit
+  std::deque<OutgoingWrite> m_outgoing;         ///< Writes not yet fully sent, in order; the first m_chainLength are in flight
+  size_t m_chainLength = 0;                     ///< Linked sends in flight
+  size_t m_chainCursor = 0;                     ///< Index in m_outgoing of the next send to complete
+#endif
+  BufferPool &m_pool;                           ///< Pool supplying receive buffers
+  int m_fd;                                     ///< SPP socket file descriptor
+  int m_stopFd;                                 ///< Control pipe read end
+  int m_wakeFd = -1;                            ///< eventfd used to signal queued writes
+  std::atomic<bool> m_active;                   ///< Ring is the active data path
+  std::mutex m_writeMutex;                      ///< Protects m_pendingWrites
+  std::deque<BufferHandle> m_pendingWrites;     ///< Writes queued by other threads
+};
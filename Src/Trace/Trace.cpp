@@ -0,0 +1,257 @@
+/**
+ * @file Trace.cpp
+ * @brief Implementation of the per-thread span rings and Chrome trace export
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Trace.h"
+
+#define TRACE_RETIRED_RINGS 16 ///< Rings of exited threads kept for dumps
+
+std::atomic<bool> Trace::s_enabled{true};
+
+namespace
+{
+/**
+ * @struct TraceRing
+ * @brief Events of one thread
+ */
+struct TraceRing
+{
+  std::mutex mutex;                                                       ///< Held by the owner while writing and by dumps
+  std::unique_ptr<TraceEvent[]> events = std::make_unique<TraceEvent[]>(TRACE_RING_EVENTS); ///< Ring storage
+  uint64_t written = 0;                                                   ///< Events written since the thread started
+  uint32_t tid = 0;                                                       ///< Kernel thread id
+  std::string threadName;                                                 ///< Name shown in dumps
+  bool retired = false;                                                   ///< Owning thread has exited
+};
+
+std::mutex ringsMutex;                          ///< Protects rings
+std::vector<std::shared_ptr<TraceRing>> rings;  ///< Rings of live and recently exited threads
+std::atomic<uint64_t> nextFlowId{1};            ///< Next flow id
+
+/**
+ * @struct RingHolder
+ * @brief Thread-local owner that retires the ring when its thread exits
+ */
+struct RingHolder
+{
+  std::shared_ptr<TraceRing> ring; ///< This thread's ring, created on first use
+
+  ~RingHolder()
+  {
+    if (!ring)
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    ring->retired = true;
+    // Drop the oldest retired rings so short-lived threads do not pile up
+    size_t retired = std::count_if(rings.begin(), rings.end(), [](const auto &r) { return r->retired; });
+    for (auto it = rings.begin(); it != rings.end() && retired > TRACE_RETIRED_RINGS;)
+    {
+      if ((*it)->retired)
+      {
+        it = rings.erase(it);
+        --retired;
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+};
+
+thread_local RingHolder holder; ///< Calling thread's ring
+
+/**
+ * @brief Get the calling thread's ring, registering it on first use
+ * @return Ring
+ */
+TraceRing &LocalRing()
+{
+  if (!holder.ring)
+  {
+    holder.ring = std::make_shared<TraceRing>();
+    holder.ring->tid = static_cast<uint32_t>(syscall(SYS_gettid));
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    rings.push_back(holder.ring);
+  }
+  return *holder.ring;
+}
+
+/**
+ * @brief Write a string as a JSON string literal
+ * @param file Output file
+ * @param text Unescaped text
+ */
+void WriteJsonString(FILE *file, const char *text)
+{
+  fputc('"', file);
+  for (const char *c = text; *c; ++c)
+  {
+    if (*c == '"' || *c == '\\')
+    {
+      fprintf(file, "\\%c", *c);
+    }
+    else if (static_cast<unsigned char>(*c) < 0x20)
+    {
+      fprintf(file, "\\u%04x", *c);
+    }
+    else
+    {
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
+} // namespace
+
+void Trace::Enable(bool enabled)
+{
+  s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Trace::SetThreadName(const std::string &name)
+{
+  TraceRing &ring = LocalRing();
+  std::lock_guard<std::mutex> lock(ring.mutex);
+  ring.threadName = name;
+}
+
+uint64_t Trace::NewFlowId()
+{
+  return nextFlowId.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t Trace::NowUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::FlowStart(const char *category, const std::string &name, uint64_t flowId)
+{
+  if (!Enabled())
+  {
+    return;
+  }
+  TraceEvent event = {};
+  event.tsUs = NowUs();
+  event.flowId = flowId;
+  event.category = category;
+  event.phase = 's';
+  strncpy(event.name, name.c_str(), TRACE_NAME_LEN - 1);
+  Record(event);
+}
+
+void Trace::Record(TraceEvent event)
+{
+  TraceRing &ring = LocalRing();
+  event.tid = ring.tid;
+  std::lock_guard<std::mutex> lock(ring.mutex);
+  ring.events[ring.written % TRACE_RING_EVENTS] = event;
+  ++ring.written;
+}
+
+long Trace::DumpChromeJson(const std::string &path)
+{
+  FILE *file = fopen(path.c_str(), "w");
+  if (!file)
+  {
+    return -1;
+  }
+  std::vector<std::shared_ptr<TraceRing>> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    snapshot = rings;
+  }
+
+  long count = 0;
+  int pid = getpid();
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  for (const auto &ring : snapshot)
+  {
+    std::vector<TraceEvent> events;
+    std::string threadName;
+    {
+      std::lock_guard<std::mutex> lock(ring->mutex);
+      uint64_t first = ring->written > TRACE_RING_EVENTS ? ring->written - TRACE_RING_EVENTS : 0;
+      for (uint64_t i = first; i < ring->written; ++i)
+      {
+        events.push_back(ring->events[i % TRACE_RING_EVENTS]);
+      }
+      threadName = ring->threadName.empty() ? "thread-" + std::to_string(ring->tid) : ring->threadName;
+    }
+    fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":", count ? ",\n" : "", pid,
+            ring->tid);
+    WriteJsonString(file, threadName.c_str());
+    fprintf(file, "}}");
+    ++count;
+    for (const TraceEvent &event : events)
+    {
+      fprintf(file, ",\n{\"ph\":\"%c\",\"cat\":", event.phase);
+      WriteJsonString(file, event.category);
+      fprintf(file, ",\"name\":");
+      WriteJsonString(file, event.name);
+      fprintf(file, ",\"pid\":%d,\"tid\":%u,\"ts\":%" PRIu64, pid, event.tid, event.tsUs);
+      if (event.phase == 'X')
+      {
+        fprintf(file, ",\"dur\":%" PRIu64, event.durUs);
+      }
+      else
+      {
+        fprintf(file, ",\"id\":%" PRIu64 "%s", event.flowId, event.phase == 'f' ? ",\"bp\":\"e\"" : "");
+      }
+      fprintf(file, "}");
+      ++count;
+    }
+  }
+  fprintf(file, "\n]}\n");
+  bool ok = !ferror(file);
+  fclose(file);
+  return ok ? count : -1;
+}
+
+TraceScope::TraceScope(const char *category, const std::string &name, uint64_t flowId) : m_event{},
+                                                                                        m_active(Trace::Enabled())
+{
+  if (!m_active)
+  {
+    return;
+  }
+  m_event.tsUs = Trace::NowUs();
+  m_event.category = category;
+  m_event.phase = 'X';
+  strncpy(m_event.name, name.c_str(), TRACE_NAME_LEN - 1);
+  if (flowId)
+  {
+    // The flow end binds to this span, so it shares the start time
+    TraceEvent end = m_event;
+    end.phase = 'f';
+    end.flowId = flowId;
+    Trace::Record(end);
+  }
+}
+
+TraceScope::~TraceScope()
+{
+  if (!m_active)
+  {
+    return;
+  }
+  m_event.durUs = Trace::NowUs() - m_event.tsUs;
+  Trace::Record(m_event);
+}
@@ -0,0 +1,148 @@
+/**
+ * @file Trace.h
+ * @brief Control-plane spans buffered in per-thread rings, exported as Chrome trace JSON
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#define TRACE_RING_EVENTS 4096 ///< Events kept per thread; older ones are overwritten
+#define TRACE_NAME_LEN 40      ///< Span names are truncated to this length
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+/**
+ * @def TRACE_SCOPE(category, name)
+ * @brief Record a span covering the rest of the enclosing block
+ * @param category Static string grouping related spans, e.g. "device"
+ * @param name Span name; copied, so a temporary string is fine
+ */
+#define TRACE_SCOPE(category, name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(category, name)
+
+/**
+ * @def TRACE_SCOPE_FLOW(category, name, flowId)
+ * @brief Record a span that ends the flow started with Trace::FlowStart()
+ * @param category Static string grouping related spans
+ * @param name Span name
+ * @param flowId Id returned by Trace::NewFlowId(), 0 for none
+ */
+#define TRACE_SCOPE_FLOW(category, name, flowId) TraceScope TRACE_CONCAT(traceScope, __LINE__)(category, name, flowId)
+
+/**
+ * @struct TraceEvent
+ * @brief One span or flow endpoint, 72 bytes
+ */
+typedef struct
+{
+  uint64_t tsUs;              ///< Start on the steady clock in microseconds
+  uint64_t durUs;             ///< Span length; 0 for flow endpoints
+  uint64_t flowId;            ///< Flow the event starts or ends, 0 for none
+  const char *category;       ///< Static category string
+  uint32_t tid;               ///< Kernel thread id
+  char phase;                 ///< 'X' span, 's' flow start, 'f' flow end
+  char name[TRACE_NAME_LEN];  ///< Span name, NUL terminated
+} TraceEvent;
+
+/**
+ * @class Trace
+ * @brief Process-wide span recorder
+ *
+ * Each thread writes to its own ring of the last TRACE_RING_EVENTS events,
+ * so recording never contends with other threads; the ring lock is only
+ * taken by a concurrent dump. Spans are complete events recorded when they
+ * end. Flows tie a span on one thread to the span on another thread that
+ * carries on its work, such as a command posted from the menu and run by
+ * an executor worker. Rings of exited threads are kept for the next dump,
+ * bounded to the most recent few.
+ */
+class Trace
+{
+public:
+  /**
+   * @brief Turn recording on or off
+   * @param enabled True to record (the default)
+   */
+  static void Enable(bool enabled);
+
+  /**
+   * @brief Check whether recording is on
+   * @return True if spans are recorded
+   */
+  static bool Enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Name the calling thread in dumps
+   * @param name Thread name
+   */
+  static void SetThreadName(const std::string &name);
+
+  /**
+   * @brief Allocate an id linking a flow start to its end
+   * @return Non-zero flow id
+   */
+  static uint64_t NewFlowId();
+
+  /**
+   * @brief Mark where work handed to another thread starts
+   * @param category Static category string
+   * @param name Flow name
+   * @param flowId Id from NewFlowId()
+   */
+  static void FlowStart(const char *category, const std::string &name, uint64_t flowId);
+
+  /**
+   * @brief Append an event to the calling thread's ring
+   * @param event Event; tid is filled in
+   */
+  static void Record(TraceEvent event);
+
+  /**
+   * @brief Get the steady clock in microseconds
+   * @return Current time
+   */
+  static uint64_t NowUs();
+
+  /**
+   * @brief Write every buffered event as Chrome trace JSON
+   * @param path Output file; loads in chrome://tracing and ui.perfetto.dev
+   * @return Number of events written, -1 if the file could not be written
+   */
+  static long DumpChromeJson(const std::string &path);
+
+private:
+  static std::atomic<bool> s_enabled; ///< Recording switch
+};
+
+/**
+ * @class TraceScope
+ * @brief Records a span from construction to destruction
+ */
+class TraceScope
+{
+public:
+  /**
+   * @brief Start a span
+   * @param category Static category string
+   * @param name Span name
+   * @param flowId Flow this span ends, 0 for none
+   */
+  TraceScope(const char *category, const std::string &name, uint64_t flowId = 0);
+
+  /**
+   * @brief End the span and record it
+   */
+  ~TraceScope();
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  TraceEvent m_event;   ///< Span being timed
+  bool m_active;        ///< False when recording was off at construction
+};
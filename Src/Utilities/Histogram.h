@@ -0,0 +1,91 @@
+/**
+ * @file Histogram.h
+ * @brief Fixed-size log2 latency histogram
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+#define HISTOGRAM_BUCKETS 32 ///< Bucket i counts samples in [2^i, 2^(i+1)) microseconds
+
+/**
+ * @class Histogram
+ * @brief Latency histogram with power-of-two microsecond buckets
+ *
+ * Recording a sample is a bit scan and an increment, and the histogram has
+ * a fixed 32-bucket footprint however many samples it holds. Percentiles
+ * are reported as the upper bound of the bucket they fall in, so they are
+ * accurate to within a factor of two. Not thread-safe; callers serialize
+ * access.
+ */
+class Histogram
+{
+public:
+  /**
+   * @brief Record a sample
+   * @param us Duration in microseconds
+   */
+  void Record(uint64_t us)
+  {
+    int bucket = us ? std::bit_width(us) - 1 : 0;
+    ++m_buckets[std::min(bucket, HISTOGRAM_BUCKETS - 1)];
+    ++m_count;
+    m_sumUs += us;
+    m_maxUs = std::max(m_maxUs, us);
+  }
+
+  /**
+   * @brief Add the samples of another histogram
+   * @param other Histogram to merge
+   */
+  void Merge(const Histogram &other)
+  {
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    {
+      m_buckets[i] += other.m_buckets[i];
+    }
+    m_count += other.m_count;
+    m_sumUs += other.m_sumUs;
+    m_maxUs = std::max(m_maxUs, other.m_maxUs);
+  }
+
+  /**
+   * @brief Get an approximate percentile
+   * @param percent Percentile in the range [0, 100]
+   * @return Upper bound of the bucket holding the percentile in microseconds, 0 if empty
+   */
+  uint64_t PercentileUs(double percent) const
+  {
+    if (!m_count)
+    {
+      return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(m_count * percent / 100.0 + 0.5));
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    {
+      seen += m_buckets[i];
+      if (seen >= rank)
+      {
+        return std::min(m_maxUs, (uint64_t(2) << i) - 1);
+      }
+    }
+    return m_maxUs;
+  }
+
+  uint64_t Count() const { return m_count; }                       ///< Number of samples
+  uint64_t MeanUs() const { return m_count ? m_sumUs / m_count : 0; } ///< Mean sample in microseconds
+  uint64_t MaxUs() const { return m_maxUs; }                       ///< Largest sample in microseconds
+  uint64_t Bucket(int i) const { return m_buckets[i]; }            ///< Samples in bucket i
+
+private:
+  uint64_t m_buckets[HISTOGRAM_BUCKETS] = {}; ///< Sample count per power-of-two bucket
+  uint64_t m_count = 0;                       ///< Number of samples
+  uint64_t m_sumUs = 0;                       ///< Sum of all samples
+  uint64_t m_maxUs = 0;                       ///< Largest sample
+};
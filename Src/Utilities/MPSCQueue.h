@@ -0,0 +1,233 @@
+/**
+ * @file MPSCQueue.h
+ * @brief Bounded lock-free multi-producer single-consumer queue
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/**
+ * @class MPSCQueue
+ * @brief Bounded lock-free queue with eventfd wakeup for one consumer thread
+ *
+ * Producers claim a slot with a single compare-and-swap and never block; a
+ * push into a full queue fails instead of waiting. Each slot carries a
+ * sequence number that tells the consumer when its value is published
+ * (Vyukov's bounded queue). The consumer sleeps on an eventfd, and
+ * producers only write to the eventfd when the consumer has announced that
+ * it is about to sleep, so a busy queue costs no syscalls.
+ *
+ * @tparam T Element type; must be default-constructible and movable
+ */
+template <typename T>
+class MPSCQueue
+{
+public:
+  /**
+   * @brief Construct a new MPSCQueue object
+   * @param capacity Maximum number of queued elements, rounded up to a power of two
+   */
+  explicit MPSCQueue(size_t capacity)
+  {
+    size_t size = 2;
+    while (size < capacity)
+    {
+      size <<= 1;
+    }
+    m_mask = size - 1;
+    m_slots = std::make_unique<Slot[]>(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  }
+
+  /**
+   * @brief Destroy the MPSCQueue object
+   */
+  ~MPSCQueue()
+  {
+    if (m_eventFd >= 0)
+    {
+      close(m_eventFd);
+    }
+  }
+
+  MPSCQueue(const MPSCQueue &) = delete;
+  MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+  /**
+   * @brief Append an element; safe to call from any thread
+   * @param item Element to append
+   * @return False if the queue is full
+   */
+  bool TryPush(T item)
+  {
+    size_t pos = m_tail.load(std::memory_order_relaxed);
+    Slot *slot = nullptr;
+    for (;;)
+    {
+      slot = &m_slots[pos & m_mask];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0)
+      {
+        if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if (diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+    slot->value = std::move(item);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    Notify();
+    return true;
+  }
+
+  /**
+   * @brief Remove the oldest element; consumer thread only
+   * @param item Receives the element
+   * @return False if the queue is empty
+   */
+  bool TryPop(T &item)
+  {
+    Slot &slot = m_slots[m_head & m_mask];
+    if (slot.sequence.load(std::memory_order_acquire) != m_head + 1)
+    {
+      return false;
+    }
+    item = std::move(slot.value);
+    slot.value = T();
+    slot.sequence.store(m_head + m_mask + 1, std::memory_order_release);
+    ++m_head;
+    return true;
+  }
+
+  /**
+   * @brief Remove up to max elements and pass each to a callback; consumer thread only
+   * @param callback Invoked with each element in FIFO order
+   * @param max Maximum number of elements to remove
+   * @return Number of elements removed
+   */
+  template <typename Callback>
+  size_t Drain(Callback &&callback, size_t max = SIZE_MAX)
+  {
+    size_t count = 0;
+    T item;
+    while (count < max && TryPop(item))
+    {
+      callback(std::move(item));
+      ++count;
+    }
+    return count;
+  }
+
+  /**
+   * @brief Check whether the queue is empty; consumer thread only
+   * @return True if there is nothing to pop
+   */
+  bool Empty() const
+  {
+    return m_slots[m_head & m_mask].sequence.load(std::memory_order_acquire) != m_head + 1;
+  }
+
+  /**
+   * @brief Sleep until an element is available or the queue is closed; consumer thread only
+   * @param timeoutMs Maximum time to sleep, -1 to wait indefinitely
+   * @return True if an element is available or the queue was closed
+   */
+  bool Wait(int timeoutMs = -1)
+  {
+    if (!Empty() || m_closed.load())
+    {
+      return true;
+    }
+    // Announce the sleep, then re-check so a concurrent push is not missed
+    m_waiting.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (Empty() && !m_closed.load())
+    {
+      struct pollfd pfd = {m_eventFd, POLLIN, 0};
+      poll(&pfd, 1, timeoutMs);
+    }
+    m_waiting.store(false);
+    uint64_t count = 0;
+    if (read(m_eventFd, &count, sizeof(count)) < 0)
+    {
+      // Nothing signalled; EAGAIN is expected
+    }
+    return !Empty() || m_closed.load();
+  }
+
+  /**
+   * @brief Wake the consumer for good; later Wait() calls return immediately
+   */
+  void Close()
+  {
+    m_closed.store(true);
+    uint64_t one = 1;
+    if (write(m_eventFd, &one, sizeof(one)) < 0)
+    {
+      // Counter saturated; the consumer is already signalled
+    }
+  }
+
+  /**
+   * @brief Check whether Close() was called
+   * @return True once the queue is closed
+   */
+  bool IsClosed() const { return m_closed.load(); }
+
+private:
+  /**
+   * @brief Wake the consumer if it announced that it is sleeping
+   */
+  void Notify()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiting.load(std::memory_order_relaxed) && m_waiting.exchange(false))
+    {
+      uint64_t one = 1;
+      if (write(m_eventFd, &one, sizeof(one)) < 0)
+      {
+        // Counter saturated; the consumer is already signalled
+      }
+    }
+  }
+
+  /**
+   * @struct Slot
+   * @brief Ring entry with its publication sequence number
+   */
+  struct Slot
+  {
+    std::atomic<size_t> sequence{0}; ///< pos + 1 when published for pos, pos + size when free again
+    T value{};                       ///< Stored element
+  };
+
+  std::unique_ptr<Slot[]> m_slots;                 ///< Ring storage
+  size_t m_mask = 0;                               ///< Ring size minus one
+  alignas(64) std::atomic<size_t> m_tail{0};       ///< Next position claimed by producers
+  alignas(64) size_t m_head = 0;                   ///< Next position read by the consumer
+  alignas(64) std::atomic<bool> m_waiting{false};  ///< Consumer is about to sleep on the eventfd
+  std::atomic<bool> m_closed{false};               ///< Queue closed, consumer should exit
+  int m_eventFd = -1;                              ///< Wakes the consumer
+};
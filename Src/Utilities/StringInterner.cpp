@@ -0,0 +1,133 @@
+/**
+ * @file StringInterner.cpp
+ * @brief Implementation of the reference-counted string table
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <stdexcept>
+
+#include "StringInterner.h"
+
+InternedString::InternedString(const InternedString &other) : m_id(other.m_id)
+{
+  if (m_id)
+  {
+    StringInterner::Instance().AddRef(m_id);
+  }
+}
+
+InternedString::InternedString(InternedString &&other) noexcept : m_id(other.m_id)
+{
+  other.m_id = 0;
+}
+
+InternedString &InternedString::operator=(const InternedString &other)
+{
+  if (m_id != other.m_id)
+  {
+    InternedString copy(other);
+    std::swap(m_id, copy.m_id);
+  }
+  return *this;
+}
+
+InternedString &InternedString::operator=(InternedString &&other) noexcept
+{
+  std::swap(m_id, other.m_id);
+  return *this;
+}
+
+InternedString::~InternedString()
+{
+  if (m_id)
+  {
+    StringInterner::Instance().Release(m_id);
+  }
+}
+
+const std::string &InternedString::Str() const
+{
+  static const std::string empty;
+  return m_id ? StringInterner::Instance().At(m_id).text : empty;
+}
+
+StringInterner &StringInterner::Instance()
+{
+  // Leaked on purpose: handles in objects destroyed during exit still release into it
+  static StringInterner *interner = new StringInterner();
+  return *interner;
+}
+
+StringInterner::Entry &StringInterner::At(uint32_t id) const
+{
+  return m_chunks[id >> INTERN_CHUNK_BITS].load(std::memory_order_acquire)[id & (INTERN_CHUNK_SIZE - 1)];
+}
+
+InternedString StringInterner::Intern(std::string_view text)
+{
+  if (text.empty())
+  {
+    return InternedString();
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_index.find(text);
+  if (it != m_index.end())
+  {
+    At(it->second).refs.fetch_add(1, std::memory_order_relaxed);
+    return InternedString(it->second);
+  }
+
+  uint32_t id;
+  if (!m_free.empty())
+  {
+    id = m_free.back();
+    m_free.pop_back();
+  }
+  else
+  {
+    if ((m_next >> INTERN_CHUNK_BITS) >= INTERN_MAX_CHUNKS)
+    {
+      throw std::length_error("String interner is full");
+    }
+    id = m_next++;
+    auto &chunk = m_chunks[id >> INTERN_CHUNK_BITS];
+    if (!chunk.load(std::memory_order_relaxed))
+    {
+      chunk.store(new Entry[INTERN_CHUNK_SIZE], std::memory_order_release);
+    }
+  }
+  Entry &entry = At(id);
+  entry.text.assign(text);
+  entry.refs.store(1, std::memory_order_relaxed);
+  entry.live = true;
+  m_index.emplace(std::string_view(entry.text), id);
+  m_size.fetch_add(1, std::memory_order_relaxed);
+  return InternedString(id);
+}
+
+void StringInterner::AddRef(uint32_t id)
+{
+  At(id).refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StringInterner::Release(uint32_t id)
+{
+  Entry &entry = At(id);
+  if (entry.refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // Intern() may have revived the entry, or another release recycled it, before the lock
+  if (!entry.live || entry.refs.load(std::memory_order_acquire) != 0)
+  {
+    return;
+  }
+  m_index.erase(std::string_view(entry.text));
+  entry.live = false;
+  entry.text.clear();
+  entry.text.shrink_to_fit();
+  m_free.push_back(id);
+  m_size.fetch_sub(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,153 @@
+/**
+ * @file StringInterner.h
+ * @brief Process-wide table storing each distinct D-Bus object path once
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#define INTERN_CHUNK_BITS 10                         ///< log2 of the entries per chunk
+#define INTERN_CHUNK_SIZE (1u << INTERN_CHUNK_BITS)  ///< Entries allocated together
+#define INTERN_MAX_CHUNKS 1024                       ///< Chunks; caps live strings at about one million
+
+/**
+ * @class InternedString
+ * @brief Counted 32-bit handle to a string in the StringInterner
+ *
+ * Copying a handle bumps a reference count instead of copying the text,
+ * and two handles are equal exactly when their strings are equal. The
+ * default handle is the empty string.
+ */
+class InternedString
+{
+public:
+  InternedString() = default;
+  InternedString(const InternedString &other);
+  InternedString(InternedString &&other) noexcept;
+  InternedString &operator=(const InternedString &other);
+  InternedString &operator=(InternedString &&other) noexcept;
+  ~InternedString();
+
+  /**
+   * @brief Get the 32-bit id of the string
+   * @return Id, 0 for the empty string
+   */
+  uint32_t Id() const { return m_id; }
+
+  /**
+   * @brief Get the interned text
+   * @return Reference valid while this handle lives
+   */
+  const std::string &Str() const;
+
+  /**
+   * @brief Get the interned text as a C string, for LOG_STRING
+   * @return NUL-terminated text
+   */
+  const char *c_str() const { return Str().c_str(); }
+
+  /**
+   * @brief Check whether this is the empty string
+   * @return True for the default handle
+   */
+  bool Empty() const { return m_id == 0; }
+
+  bool operator==(const InternedString &other) const { return m_id == other.m_id; }
+  bool operator!=(const InternedString &other) const { return m_id != other.m_id; }
+
+private:
+  friend class StringInterner;
+
+  /**
+   * @brief Adopt a reference already counted by the interner
+   * @param id String id
+   */
+  explicit InternedString(uint32_t id) : m_id(id) {}
+
+  uint32_t m_id = 0; ///< String id, 0 for the empty string
+};
+
+/**
+ * @class StringInterner
+ * @brief Reference-counted table of distinct strings
+ *
+ * Interning takes a lock and one hash lookup; reading a handle's text is
+ * lock-free, since entries live in chunks that never move. An entry is
+ * recycled once its last handle is gone, so paths of devices that come
+ * and go do not accumulate.
+ */
+class StringInterner
+{
+public:
+  /**
+   * @brief Get the process-wide interner
+   * @return Interner, never destroyed
+   */
+  static StringInterner &Instance();
+
+  /**
+   * @brief Get the handle of a string, adding it if it is new
+   * @param text String
+   * @return Handle; the empty string always yields the default handle
+   * @throws std::length_error if every entry is in use
+   */
+  InternedString Intern(std::string_view text);
+
+  /**
+   * @brief Get the number of distinct strings held
+   * @return Live entries
+   */
+  size_t Size() const { return m_size.load(std::memory_order_relaxed); }
+
+private:
+  friend class InternedString;
+
+  /**
+   * @struct Entry
+   * @brief One distinct string and its handle count
+   */
+  struct Entry
+  {
+    std::string text;               ///< Interned text
+    std::atomic<uint32_t> refs{0};  ///< Live handles
+    bool live = false;              ///< Indexed; cleared under the lock when recycled
+  };
+
+  StringInterner() = default;
+
+  /**
+   * @brief Get the entry of an id
+   * @param id Non-zero string id
+   * @return Entry
+   */
+  Entry &At(uint32_t id) const;
+
+  /**
+   * @brief Count another handle to an entry
+   * @param id String id
+   */
+  void AddRef(uint32_t id);
+
+  /**
+   * @brief Drop a handle, recycling the entry with the last one
+   * @param id String id
+   */
+  void Release(uint32_t id);
+
+  mutable std::mutex m_mutex;                              ///< Protects m_index, m_free and m_next
+  std::unordered_map<std::string_view, uint32_t> m_index;  ///< Text to id; keys view the entry text
+  std::vector<uint32_t> m_free;                            ///< Recycled ids
+  uint32_t m_next = 1;                                     ///< Next never-used id; 0 is the empty string
+  std::atomic<Entry *> m_chunks[INTERN_MAX_CHUNKS] = {};   ///< Entry chunks, allocated on demand
+  std::atomic<size_t> m_size{0};                           ///< Live entries
+};
@@ -0,0 +1,107 @@
+/**
+ * @file TimerWheel.cpp
+ * @brief Implementation of the hashed timer wheel
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <climits>
+
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(uint64_t tickMs, size_t slots, uint64_t nowMs) : m_tickMs(tickMs ? tickMs : 1),
+                                                                        m_currentTick(nowMs / m_tickMs),
+                                                                        m_slots(slots ? slots : 1)
+{
+}
+
+void TimerWheel::Schedule(uint32_t id, uint64_t deadlineMs)
+{
+  Cancel(id);
+  // Round up so a timer never fires before its deadline
+  uint64_t deadlineTick = (deadlineMs + m_tickMs - 1) / m_tickMs;
+  if (deadlineTick <= m_currentTick)
+  {
+    deadlineTick = m_currentTick + 1;
+  }
+  size_t slot = deadlineTick % m_slots.size();
+  m_slots[slot].push_back({id, deadlineTick});
+  m_index[id] = {slot, std::prev(m_slots[slot].end())};
+}
+
+bool TimerWheel::Cancel(uint32_t id)
+{
+  auto it = m_index.find(id);
+  if (it == m_index.end())
+  {
+    return false;
+  }
+  m_slots[it->second.first].erase(it->second.second);
+  m_index.erase(it);
+  return true;
+}
+
+void TimerWheel::Advance(uint64_t nowMs, const ExpireCallback &onExpire)
+{
+  uint64_t nowTick = nowMs / m_tickMs;
+  std::vector<uint32_t> expired;
+  // A full revolution visits every slot; more ticks than that add nothing
+  uint64_t steps = nowTick - m_currentTick;
+  if (nowTick <= m_currentTick)
+  {
+    steps = 0;
+  }
+  else if (steps > m_slots.size())
+  {
+    steps = m_slots.size();
+  }
+  for (uint64_t step = 1; step <= steps; ++step)
+  {
+    auto &slot = m_slots[(m_currentTick + step) % m_slots.size()];
+    for (auto it = slot.begin(); it != slot.end();)
+    {
+      if (it->deadlineTick <= nowTick)
+      {
+        expired.push_back(it->id);
+        m_index.erase(it->id);
+        it = slot.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+  if (nowTick > m_currentTick)
+  {
+    m_currentTick = nowTick;
+  }
+  // Fire after the wheel is consistent so callbacks may schedule again
+  for (auto id : expired)
+  {
+    onExpire(id);
+  }
+}
+
+int TimerWheel::NextTimeoutMs(uint64_t nowMs) const
+{
+  if (m_index.empty())
+  {
+    return -1;
+  }
+  // Every pending deadline is past m_currentTick, so the first slot holding a
+  // timer due on that slot's own tick in this revolution holds the earliest one
+  uint64_t earliestTick = m_currentTick + m_slots.size();
+  for (uint64_t tick = m_currentTick + 1; tick <= m_currentTick + m_slots.size(); ++tick)
+  {
+    const auto &slot = m_slots[tick % m_slots.size()];
+    if (std::any_of(slot.begin(), slot.end(), [tick](const Entry &entry) { return entry.deadlineTick == tick; }))
+    {
+      earliestTick = tick;
+      break;
+    }
+  }
+  uint64_t earliestMs = earliestTick * m_tickMs;
+  return earliestMs > nowMs ? static_cast<int>(std::min<uint64_t>(earliestMs - nowMs, INT_MAX)) : 0;
+}
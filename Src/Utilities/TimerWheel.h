@@ -0,0 +1,100 @@
+/**
+ * @file TimerWheel.h
+ * @brief Hashed timer wheel for large numbers of short timeouts
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TimerWheel
+ * @brief Hashed timing wheel keyed by 32-bit timer ids
+ *
+ * Timers are hashed into a fixed number of slots by their deadline tick, so
+ * scheduling and cancelling touch a single slot and advancing only visits the slots
+ * that elapsed. Deadlines further away than one revolution simply stay in
+ * their slot until their tick comes round. NextTimeoutMs() finds the
+ * earliest deadline by walking the slots ahead of the current tick, so
+ * callers can sleep until it rather than waking every tick. The wheel is
+ * not thread-safe; callers serialize access.
+ */
+class TimerWheel
+{
+public:
+  /// Callback invoked with the id of each expired timer
+  using ExpireCallback = std::function<void(uint32_t id)>;
+
+  /**
+   * @brief Construct a new Timer Wheel object
+   * @param tickMs Resolution of the wheel in milliseconds
+   * @param slots Number of slots in the wheel
+   * @param nowMs Current time in milliseconds
+   */
+  TimerWheel(uint64_t tickMs, size_t slots, uint64_t nowMs);
+
+  /**
+   * @brief Schedule a timer, replacing any timer with the same id
+   * @param id Timer id
+   * @param deadlineMs Absolute expiry time in milliseconds
+   */
+  void Schedule(uint32_t id, uint64_t deadlineMs);
+
+  /**
+   * @brief Cancel a pending timer
+   * @param id Timer id
+   * @return True if the timer was pending
+   */
+  bool Cancel(uint32_t id);
+
+  /**
+   * @brief Advance the wheel and fire every timer whose deadline has passed
+   * @param nowMs Current time in milliseconds
+   * @param onExpire Callback invoked for each expired timer
+   */
+  void Advance(uint64_t nowMs, const ExpireCallback &onExpire);
+
+  /**
+   * @brief Get the time until the earliest pending deadline
+   *
+   * Visits at most one revolution of slots; if every pending timer is
+   * further away than that, the wait ends after the revolution.
+   * @param nowMs Current time in milliseconds
+   * @return Milliseconds to wait, 0 if a deadline has passed, or -1 if no timer is pending
+   */
+  int NextTimeoutMs(uint64_t nowMs) const;
+
+  /**
+   * @brief Get the number of pending timers
+   * @return Pending timer count
+   */
+  size_t Size() const { return m_index.size(); }
+
+  /**
+   * @brief Check whether any timer is pending
+   * @return True if no timer is pending
+   */
+  bool Empty() const { return m_index.empty(); }
+
+private:
+  /**
+   * @struct Entry
+   * @brief Timer stored in a wheel slot
+   */
+  struct Entry
+  {
+    uint32_t id;           ///< Timer id
+    uint64_t deadlineTick; ///< Tick at which the timer expires
+  };
+
+  uint64_t m_tickMs;                       ///< Wheel resolution in milliseconds
+  uint64_t m_currentTick;                  ///< Last tick processed by Advance()
+  std::vector<std::list<Entry>> m_slots;   ///< Wheel slots
+  std::unordered_map<uint32_t, std::pair<size_t, std::list<Entry>::iterator>> m_index; ///< Timer id to slot entry
+};
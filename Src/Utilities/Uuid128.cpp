@@ -0,0 +1,133 @@
+/**
+ * @file Uuid128.cpp
+ * @brief Implementation of the packed 128-bit UUID
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <cstdio>
+
+#include "Uuid128.h"
+
+#define UUID_STRING_LEN 36                     ///< Length of the canonical form
+#define UUID_BASE_HI 0x0000000000001000ULL     ///< Bluetooth base UUID 00000000-0000-1000-..., upper half
+#define UUID_BASE_LO 0x800000805f9b34fbULL     ///< Bluetooth base UUID ...-8000-00805f9b34fb, lower half
+
+namespace
+{
+/**
+ * @brief Get the value of a hex digit
+ * @param c Character
+ * @return 0-15, or -1 if c is not a hex digit
+ */
+int HexValue(char c)
+{
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f')
+  {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F')
+  {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+} // namespace
+
+bool Uuid128::Parse(std::string_view text, Uuid128 &uuid)
+{
+  if (text.size() == 4 || text.size() == 8)
+  {
+    uint32_t value = 0;
+    for (char c : text)
+    {
+      int digit = HexValue(c);
+      if (digit < 0)
+      {
+        return false;
+      }
+      value = (value << 4) | static_cast<uint32_t>(digit);
+    }
+    uuid = FromShort(value);
+    return true;
+  }
+  if (text.size() != UUID_STRING_LEN)
+  {
+    return false;
+  }
+  uint64_t halves[2] = {0, 0};
+  int nibbles = 0;
+  for (size_t i = 0; i < text.size(); ++i)
+  {
+    if (i == 8 || i == 13 || i == 18 || i == 23)
+    {
+      if (text[i] != '-')
+      {
+        return false;
+      }
+      continue;
+    }
+    int digit = HexValue(text[i]);
+    if (digit < 0)
+    {
+      return false;
+    }
+    uint64_t &half = halves[nibbles / 16];
+    half = (half << 4) | static_cast<uint64_t>(digit);
+    ++nibbles;
+  }
+  uuid.hi = halves[0];
+  uuid.lo = halves[1];
+  return true;
+}
+
+Uuid128 Uuid128::FromString(std::string_view text)
+{
+  Uuid128 uuid;
+  if (!Parse(text, uuid))
+  {
+    return Uuid128();
+  }
+  return uuid;
+}
+
+std::vector<Uuid128> Uuid128::FromStrings(const std::vector<std::string> &texts)
+{
+  std::vector<Uuid128> uuids;
+  uuids.reserve(texts.size());
+  for (const auto &text : texts)
+  {
+    Uuid128 uuid;
+    if (Parse(text, uuid))
+    {
+      uuids.push_back(uuid);
+    }
+  }
+  return uuids;
+}
+
+Uuid128 Uuid128::FromShort(uint32_t shortUuid)
+{
+  Uuid128 uuid;
+  uuid.hi = (static_cast<uint64_t>(shortUuid) << 32) | UUID_BASE_HI;
+  uuid.lo = UUID_BASE_LO;
+  return uuid;
+}
+
+std::string Uuid128::ToString() const
+{
+  char text[UUID_STRING_LEN + 1];
+  snprintf(text, sizeof(text), "%08x-%04x-%04x-%04x-%012llx", static_cast<unsigned>(hi >> 32),
+           static_cast<unsigned>((hi >> 16) & 0xFFFF), static_cast<unsigned>(hi & 0xFFFF),
+           static_cast<unsigned>(lo >> 48), static_cast<unsigned long long>(lo & 0xFFFFFFFFFFFFULL));
+  return std::string(text, UUID_STRING_LEN);
+}
+
+bool Uuid128::IsShort() const
+{
+  return (hi & 0xFFFFFFFFULL) == UUID_BASE_HI && lo == UUID_BASE_LO;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file Uuid128.h
+ * @brief Packed binary form of 128-bit Bluetooth UUIDs
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @struct Uuid128
+ * @brief 128-bit UUID held as two 64-bit halves
+ *
+ * The halves are in the order the UUID is written, so comparing hi then lo
+ * orders UUIDs like their canonical strings, and equality is one 16-byte
+ * compare instead of a 36-character string compare. Short 16- and 32-bit
+ * UUIDs are expanded on the Bluetooth base UUID.
+ */
+struct Uuid128
+{
+  uint64_t hi = 0; ///< First 8 bytes (time_low, time_mid, time_hi)
+  uint64_t lo = 0; ///< Last 8 bytes (clock_seq, node)
+
+  /**
+   * @brief Parse a UUID string
+   * @param text Canonical 36-character form, or a 4/8 hex digit short UUID
+   * @param uuid Parsed UUID
+   * @return False if the text is not a UUID
+   */
+  static bool Parse(std::string_view text, Uuid128 &uuid);
+
+  /**
+   * @brief Parse a UUID string, mapping malformed text to the nil UUID
+   * @param text UUID string
+   * @return Parsed UUID, all zero if malformed
+   */
+  static Uuid128 FromString(std::string_view text);
+
+  /**
+   * @brief Parse a list of UUID strings as BlueZ reports them
+   * @param texts UUID strings
+   * @return Parsed UUIDs in the same order; malformed entries are dropped
+   */
+  static std::vector<Uuid128> FromStrings(const std::vector<std::string> &texts);
+
+  /**
+   * @brief Expand a 16- or 32-bit short UUID on the Bluetooth base UUID
+   * @param shortUuid Short UUID
+   * @return Full UUID
+   */
+  static Uuid128 FromShort(uint32_t shortUuid);
+
+  /**
+   * @brief Format the UUID in the lowercase canonical form BlueZ uses
+   * @return 36-character string
+   */
+  std::string ToString() const;
+
+  /**
+   * @brief Check whether the UUID lies on the Bluetooth base UUID
+   * @return True if it is a short UUID expanded on the base
+   */
+  bool IsShort() const;
+
+  /**
+   * @brief Get the short form of a UUID on the Bluetooth base UUID
+   * @return 32-bit short UUID; only meaningful when IsShort()
+   */
+  uint32_t Short() const { return static_cast<uint32_t>(hi >> 32); }
+
+  bool operator==(const Uuid128 &other) const { return hi == other.hi && lo == other.lo; }
+  bool operator!=(const Uuid128 &other) const { return !(*this == other); }
+  bool operator<(const Uuid128 &other) const { return hi != other.hi ? hi < other.hi : lo < other.lo; }
+};
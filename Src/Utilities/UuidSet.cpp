@@ -0,0 +1,169 @@
+/**
+ * @file UuidSet.cpp
+ * @brief Implementation of the UUID set and the profile description table
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "UuidSet.h"
+
+#define UUIDSET_SCAN_LIMIT 16          ///< Sets up to this size are scanned, larger ones searched
+#define UUID_DESCRIPTION_BITS 5        ///< log2 of the description table size
+#define UUID_DESCRIPTION_HASH 0x9E3779B1u ///< Multiplier that maps the described short UUIDs without collisions
+
+namespace
+{
+/**
+ * @brief Compare two UUIDs as one 16-byte vector
+ * @param a First UUID
+ * @param b Second UUID
+ * @return True if all 16 bytes match
+ */
+inline bool Equal16(const Uuid128 &a, const Uuid128 &b)
+{
+#if defined(__SSE2__)
+  __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&a));
+  __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&b));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) == 0xFFFF;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  uint8x16_t eq = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t *>(&a)), vld1q_u8(reinterpret_cast<const uint8_t *>(&b)));
+  return vminvq_u8(eq) == 0xFF;
+#else
+  return a == b;
+#endif
+}
+
+/**
+ * @struct UuidDescription
+ * @brief One entry of the description table
+ */
+typedef struct
+{
+  uint16_t shortUuid;      ///< 16-bit short UUID, 0 for an empty slot
+  const char *description; ///< Profile name
+} UuidDescription;
+
+/// Described profiles, by 16-bit short UUID on the Bluetooth base UUID
+constexpr UuidDescription UUID_DESCRIPTIONS[] = {
+    {0x1101, "Serial Port Profile (SPP)"},
+    {0x1105, "Dial-Up Networking (DUN)"},
+    {0x1106, "IrMC Sync"},
+    {0x1107, "OBEX Object Push"},
+    {0x1108, "OBEX File Transfer"},
+    {0x1109, "IrMC Sync Command"},
+    {0x110a, "Headset Profile (HSP)"},
+    {0x110b, "Audio Gateway (AG)"},
+    {0x110c, "Audio/Video Remote Control Profile (AVRCP)"},
+    {0x110d, "Hands-Free Profile (HFP)"},
+    {0x110e, "Hands-Free Profile (HFP)"},
+    {0x110f, "Basic Imaging Profile (BIP)"},
+    {0x1110, "Basic Imaging Profile (BIP)"},
+    {0x1111, "Basic Imaging Profile (BIP)"},
+    {0x1112, "Basic Imaging Profile (BIP)"},
+    {0x1113, "Basic Imaging Profile (BIP)"},
+    {0x1114, "Basic Imaging Profile (BIP)"},
+    {0x1115, "Basic Imaging Profile (BIP)"},
+};
+
+/**
+ * @brief Get the table slot of a short UUID
+ * @param shortUuid 16-bit short UUID
+ * @return Slot index
+ */
+constexpr uint32_t DescriptionSlot(uint16_t shortUuid)
+{
+  return (static_cast<uint32_t>(shortUuid) * UUID_DESCRIPTION_HASH) >> (32 - UUID_DESCRIPTION_BITS);
+}
+
+/**
+ * @brief Build the perfect hash table of the described profiles
+ * @return Table; slots no profile hashes to are empty
+ */
+constexpr std::array<UuidDescription, 1u << UUID_DESCRIPTION_BITS> BuildDescriptionTable()
+{
+  std::array<UuidDescription, 1u << UUID_DESCRIPTION_BITS> table{};
+  for (const auto &entry : UUID_DESCRIPTIONS)
+  {
+    table[DescriptionSlot(entry.shortUuid)] = entry;
+  }
+  return table;
+}
+
+constexpr auto DESCRIPTION_TABLE = BuildDescriptionTable(); ///< Description of each short UUID, at its slot
+
+/**
+ * @brief Check at compile time that no two described profiles share a slot
+ * @return True if every profile landed in its own slot
+ */
+constexpr bool DescriptionTableIsPerfect()
+{
+  for (const auto &entry : UUID_DESCRIPTIONS)
+  {
+    if (DESCRIPTION_TABLE[DescriptionSlot(entry.shortUuid)].shortUuid != entry.shortUuid)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(DescriptionTableIsPerfect(), "UUID_DESCRIPTION_HASH collides; pick another multiplier or widen the table");
+} // namespace
+
+UuidSet::UuidSet(std::vector<Uuid128> uuids) : m_uuids(std::move(uuids))
+{
+  std::sort(m_uuids.begin(), m_uuids.end());
+  m_uuids.erase(std::unique(m_uuids.begin(), m_uuids.end()), m_uuids.end());
+}
+
+bool UuidSet::Contains(const Uuid128 &uuid) const
+{
+  if (m_uuids.size() > UUIDSET_SCAN_LIMIT)
+  {
+    return std::binary_search(m_uuids.begin(), m_uuids.end(), uuid);
+  }
+  for (const Uuid128 &candidate : m_uuids)
+  {
+    if (Equal16(candidate, uuid))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool UuidSet::Intersects(const UuidSet &other) const
+{
+  // The wanted set is usually one or two profiles; look each one up in the larger set
+  const UuidSet &small = size() <= other.size() ? *this : other;
+  const UuidSet &large = size() <= other.size() ? other : *this;
+  for (const Uuid128 &uuid : small.m_uuids)
+  {
+    if (large.Contains(uuid))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *UuidSet::Describe(const Uuid128 &uuid)
+{
+  if (!uuid.IsShort() || uuid.Short() > 0xFFFF)
+  {
+    return nullptr;
+  }
+  uint16_t shortUuid = static_cast<uint16_t>(uuid.Short());
+  const UuidDescription &entry = DESCRIPTION_TABLE[DescriptionSlot(shortUuid)];
+  return entry.shortUuid == shortUuid ? entry.description : nullptr;
+}
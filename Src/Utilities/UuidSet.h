@@ -0,0 +1,80 @@
+/**
+ * @file UuidSet.h
+ * @brief Sorted set of 128-bit UUIDs with SIMD membership tests
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+#include "Uuid128.h"
+
+static_assert(sizeof(Uuid128) == 16, "Uuid128 must be one 16-byte vector");
+
+/**
+ * @class UuidSet
+ * @brief Service UUIDs of one device, sorted and without duplicates
+ *
+ * A device advertises a handful of UUIDs, so membership is a scan that
+ * compares each entry as one 16-byte vector (SSE2 on x86-64, NEON on
+ * AArch64, two 64-bit compares elsewhere); past UUIDSET_SCAN_LIMIT entries it
+ * switches to binary search. Intersections look each UUID of the smaller
+ * set up in the larger one.
+ */
+class UuidSet
+{
+public:
+  UuidSet() = default;
+
+  /**
+   * @brief Build a set from UUIDs in any order
+   * @param uuids UUIDs; duplicates are dropped
+   */
+  explicit UuidSet(std::vector<Uuid128> uuids);
+
+  /**
+   * @brief Build a set from a fixed list, e.g. the profiles we connect to
+   * @param uuids UUIDs
+   */
+  UuidSet(std::initializer_list<Uuid128> uuids) : UuidSet(std::vector<Uuid128>(uuids)) {}
+
+  /**
+   * @brief Check whether a UUID is in the set
+   * @param uuid UUID to look for
+   * @return True if present
+   */
+  bool Contains(const Uuid128 &uuid) const;
+
+  /**
+   * @brief Check whether the sets share a UUID
+   * @param other Set to test against, e.g. the wanted profiles
+   * @return True if any UUID is in both
+   */
+  bool Intersects(const UuidSet &other) const;
+
+  /**
+   * @brief Get the description of a well-known profile UUID
+   *
+   * Looks the 16-bit short UUID up in a perfect hash table built at
+   * compile time, so no string is formatted or compared.
+   *
+   * @param uuid UUID
+   * @return Profile name, or nullptr for UUIDs without a description
+   */
+  static const char *Describe(const Uuid128 &uuid);
+
+  std::vector<Uuid128>::const_iterator begin() const { return m_uuids.begin(); }
+  std::vector<Uuid128>::const_iterator end() const { return m_uuids.end(); }
+  size_t size() const { return m_uuids.size(); }
+  bool empty() const { return m_uuids.empty(); }
+
+  bool operator==(const UuidSet &other) const { return m_uuids == other.m_uuids; }
+  bool operator!=(const UuidSet &other) const { return m_uuids != other.m_uuids; }
+
+private:
+  std::vector<Uuid128> m_uuids; ///< Sorted, unique UUIDs
+};
@@ -0,0 +1,81 @@
+/**
+ * @file VersionedSnapshot.h
+ * @brief Immutable value snapshots published with a monotonic version
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * @class VersionedSnapshot
+ * @brief Copy-on-write holder whose readers never wait for the writer
+ *
+ * Each update publishes a new immutable value behind an atomic pointer
+ * and then bumps the version. Readers take a reference to whichever value
+ * is current and keep a consistent view of it for as long as they hold
+ * it, however many updates follow; the old value is freed with its last
+ * reader. Reading the version first and the value second always yields
+ * a value at least as new as the version, so a reader that sees the
+ * version move can simply load again.
+ *
+ * Seqlocks are the usual alternative, but they rely on copying the value
+ * while it may be written, which is only sound for trivially copyable
+ * types; this one holds strings and maps.
+ *
+ * Writers must be serialised by the caller.
+ *
+ * @tparam T Value type
+ */
+template <typename T>
+class VersionedSnapshot
+{
+public:
+  /**
+   * @brief Construct a new Versioned Snapshot object at version 0
+   * @param initial Initial value
+   */
+  explicit VersionedSnapshot(T initial = T()) : m_current(std::make_shared<const T>(std::move(initial))), m_version(0)
+  {
+  }
+
+  VersionedSnapshot(const VersionedSnapshot &) = delete;
+  VersionedSnapshot &operator=(const VersionedSnapshot &) = delete;
+
+  /**
+   * @brief Get the current value; never blocks on a writer
+   * @return Immutable value, valid while held
+   */
+  std::shared_ptr<const T> Load() const
+  {
+    return m_current.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get the number of values published so far
+   * @return Version; unchanged means the value is unchanged
+   */
+  uint64_t Version() const
+  {
+    return m_version.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Publish a new value; writers only
+   * @param value New value
+   */
+  void Publish(T value)
+  {
+    m_current.store(std::make_shared<const T>(std::move(value)), std::memory_order_release);
+    m_version.fetch_add(1, std::memory_order_release);
+  }
+
+private:
+  std::atomic<std::shared_ptr<const T>> m_current; ///< Current value
+  std::atomic<uint64_t> m_version;                 ///< Values published so far
+};
@@ -0,0 +1,345 @@
+/**
+ * @file DispatchWatchdog.cpp
+ * @brief Implementation of the D-Bus dispatch thread stall detector
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <execinfo.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "DispatchWatchdog.h"
+
+#include "Logger.h"
+
+#define TAG "DispatchWatchdog::"        ///< Tag for logging messages
+#define WATCHDOG_STACK_SIGNAL (SIGRTMIN + 4) ///< Signal asking a stalled thread for its stack
+#define WATCHDOG_STACK_WAIT_MS 50       ///< Time a stalled thread has to answer the stack request
+#define WATCHDOG_MONITOR_NICE 19        ///< Nice value of the monitor thread
+#define WATCHDOG_READ_RETRIES 4         ///< Attempts at a consistent slot read before waiting for the next poll
+
+namespace
+{
+/**
+ * @struct HandlerSlot
+ * @brief Handler state of one thread, written by that thread and read by the monitor
+ */
+struct HandlerSlot
+{
+  std::atomic<bool> used{false};               ///< Claimed by a live thread
+  std::atomic<int> tid{0};                     ///< Kernel thread id of the owner
+  std::atomic<const char *> handler{nullptr};  ///< Handler running or last run
+  std::atomic<uint64_t> entryUs{0};            ///< Entry time of the running handler, 0 while idle
+  std::atomic<uint64_t> sequence{0};           ///< Twice the handlers entered so far; odd while handler and entryUs are being written
+  std::atomic<uint64_t> lastDurationUs{0};     ///< Duration of the last handler that returned
+};
+
+HandlerSlot slots[WATCHDOG_MAX_THREADS]; ///< Slots of threads that ran a handler
+
+void *stackFrames[WATCHDOG_STACK_DEPTH]; ///< Stack sample written by the signal handler
+std::atomic<int> stackDepth{-1};         ///< Frames in stackFrames, -1 until the sample is taken
+
+/**
+ * @struct SlotHolder
+ * @brief Thread-local claim on a slot, released when the thread exits
+ */
+struct SlotHolder
+{
+  HandlerSlot *slot = nullptr; ///< Claimed slot, nullptr if none was free
+  bool claimed = false;        ///< A claim was attempted
+  int depth = 0;               ///< Nesting depth of handlers
+
+  ~SlotHolder()
+  {
+    if (slot)
+    {
+      slot->entryUs.store(0, std::memory_order_release);
+      slot->tid.store(0, std::memory_order_relaxed);
+      slot->used.store(false, std::memory_order_release);
+    }
+  }
+};
+
+thread_local SlotHolder holder; ///< Calling thread's slot
+
+/**
+ * @brief Get the steady clock in microseconds
+ * @return Current time
+ */
+uint64_t NowUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Get the calling thread's slot, claiming a free one on first use
+ * @return Slot, nullptr if every slot is taken
+ */
+HandlerSlot *LocalSlot()
+{
+  if (!holder.claimed)
+  {
+    holder.claimed = true;
+    for (HandlerSlot &slot : slots)
+    {
+      bool expected = false;
+      if (slot.used.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+      {
+        slot.tid.store(static_cast<int>(syscall(SYS_gettid)), std::memory_order_relaxed);
+        holder.slot = &slot;
+        break;
+      }
+    }
+  }
+  return holder.slot;
+}
+
+/**
+ * @brief Record the interrupted thread's stack for the monitor
+ * @param signal Signal number
+ */
+void StackSampleHandler(int signal)
+{
+  (void)signal;
+  int savedErrno = errno;
+  stackDepth.store(backtrace(stackFrames, WATCHDOG_STACK_DEPTH), std::memory_order_release);
+  errno = savedErrno;
+}
+} // namespace
+
+WatchdogScope::WatchdogScope(const char *name, LatencyHistogram &latency) : m_latency(latency),
+                                                                           m_entryUs(NowUs()),
+                                                                           m_outermost(holder.depth++ == 0)
+{
+  if (!m_outermost)
+  {
+    return;
+  }
+  HandlerSlot *slot = LocalSlot();
+  if (slot)
+  {
+    // Odd while the name and entry time change, so the monitor never pairs them with the wrong handler
+    slot->sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->handler.store(name, std::memory_order_relaxed);
+    slot->entryUs.store(m_entryUs, std::memory_order_relaxed);
+    slot->sequence.fetch_add(1, std::memory_order_release);
+  }
+}
+
+WatchdogScope::~WatchdogScope()
+{
+  uint64_t durationUs = NowUs() - m_entryUs;
+  --holder.depth;
+  if (m_outermost && holder.slot)
+  {
+    holder.slot->lastDurationUs.store(durationUs, std::memory_order_relaxed);
+    holder.slot->entryUs.store(0, std::memory_order_release);
+  }
+  m_latency.Record(durationUs);
+}
+
+LatencyHistogram &WatchdogScope::Histogram(const char *name)
+{
+  return MetricsRegistry::Instance().GetHistogram("bluezeg_dispatch_handler_duration_seconds",
+                                                  "Time D-Bus handlers hold the dispatch thread",
+                                                  MetricsRegistry::Label("handler", name));
+}
+
+DispatchWatchdog::DispatchWatchdog(uint32_t thresholdMs) : m_thresholdMs(std::max<uint32_t>(thresholdMs, 1)),
+                                                           m_reported{},
+                                                           m_running(false)
+{
+  Log("%s%s Threshold - %u ms", TAG, __func__, m_thresholdMs);
+}
+
+DispatchWatchdog::~DispatchWatchdog()
+{
+  Log("%s%s", TAG, __func__);
+  m_running = false;
+  if (m_wakeFd >= 0)
+  {
+    uint64_t one = 1;
+    if (write(m_wakeFd, &one, sizeof(one)) < 0)
+    {
+      Log("%s%s Error: Writing eventfd, Error - %s", TAG, __func__, strerror(errno));
+    }
+  }
+  if (m_eventLoopThread.joinable())
+  {
+    m_eventLoopThread.join();
+  }
+  if (m_wakeFd >= 0)
+  {
+    close(m_wakeFd);
+  }
+}
+
+bool DispatchWatchdog::Start()
+{
+  // The first backtrace() loads the unwinder, which must not happen inside the signal handler
+  void *frame;
+  backtrace(&frame, 1);
+
+  struct sigaction action = {};
+  action.sa_handler = StackSampleHandler;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(WATCHDOG_STACK_SIGNAL, &action, nullptr) < 0)
+  {
+    Log("%s%s Error: Installing signal handler, Error - %s", TAG, __func__, strerror(errno));
+    return false;
+  }
+  m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_wakeFd < 0)
+  {
+    Log("%s%s Error: Creating eventfd, Error - %s", TAG, __func__, strerror(errno));
+    return false;
+  }
+  m_running = true;
+  try
+  {
+    m_eventLoopThread = std::thread(&DispatchWatchdog::RunEventLoop, this);
+  }
+  catch (const std::system_error &e)
+  {
+    Log("%s%s Error - %s", TAG, __func__, e.what());
+    m_running = false;
+    return false;
+  }
+  return true;
+}
+
+void DispatchWatchdog::RunEventLoop()
+{
+  Log("%s%s", TAG, __func__);
+  // Linux applies the nice value per thread; the monitor must never compete with the bus thread
+  if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), WATCHDOG_MONITOR_NICE) < 0)
+  {
+    Log("%s%s Error: setpriority, Error - %s", TAG, __func__, strerror(errno));
+  }
+  struct pollfd wake = {m_wakeFd, POLLIN, 0};
+  int intervalMs = std::max<int>(m_thresholdMs / 4, 1);
+  while (m_running)
+  {
+    if (poll(&wake, 1, intervalMs) < 0 && errno != EINTR)
+    {
+      Log("%s%s Error: poll, Error - %s", TAG, __func__, strerror(errno));
+    }
+    if (!m_running || (wake.revents & POLLIN))
+    {
+      break;
+    }
+    uint64_t nowUs = NowUs();
+    for (int i = 0; i < WATCHDOG_MAX_THREADS; ++i)
+    {
+      CheckSlot(i, nowUs);
+    }
+  }
+  Log("%s%s Exiting RunEventLoop", TAG, __func__);
+}
+
+void DispatchWatchdog::CheckSlot(int index, uint64_t nowUs)
+{
+  HandlerSlot &slot = slots[index];
+  if (!slot.used.load(std::memory_order_acquire))
+  {
+    m_reported[index] = 0;
+    return;
+  }
+  // Sequence lock read: retried while a handler entry is half written or one happened in between
+  uint64_t sequence = 0;
+  const char *handler = nullptr;
+  uint64_t entryUs = 0;
+  bool consistent = false;
+  for (int attempt = 0; attempt < WATCHDOG_READ_RETRIES && !consistent; ++attempt)
+  {
+    sequence = slot.sequence.load(std::memory_order_acquire);
+    handler = slot.handler.load(std::memory_order_relaxed);
+    entryUs = slot.entryUs.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    consistent = !(sequence & 1) && slot.sequence.load(std::memory_order_relaxed) == sequence;
+  }
+  if (!consistent || !handler)
+  {
+    return;
+  }
+
+  if (m_reported[index] && (entryUs == 0 || sequence != m_reported[index]))
+  {
+    if (sequence == m_reported[index])
+    {
+      Log("%s%s %s returned after %llu ms", TAG, __func__, handler,
+          static_cast<unsigned long long>(slot.lastDurationUs.load(std::memory_order_relaxed) / 1000));
+    }
+    else
+    {
+      Log("%s%s Stalled handler on thread %d returned", TAG, __func__, slot.tid.load(std::memory_order_relaxed));
+    }
+    m_reported[index] = 0;
+  }
+
+  if (entryUs == 0 || m_reported[index] || nowUs < entryUs || nowUs - entryUs < m_thresholdMs * 1000ULL)
+  {
+    return;
+  }
+  m_reported[index] = sequence;
+  int tid = slot.tid.load(std::memory_order_relaxed);
+  Log("%s%s Stall: %s on thread %d running for %llu ms (threshold %u ms)", TAG, __func__, handler, tid,
+      static_cast<unsigned long long>((nowUs - entryUs) / 1000), m_thresholdMs);
+  MetricsRegistry::Instance()
+      .GetCounter("bluezeg_dispatch_stalls_total", "D-Bus handlers that ran past the stall threshold",
+                  MetricsRegistry::Label("handler", handler))
+      .Add();
+  LogStack(tid);
+}
+
+void DispatchWatchdog::LogStack(int tid)
+{
+  if (tid == 0)
+  {
+    return;
+  }
+  stackDepth.store(-1, std::memory_order_relaxed);
+  if (syscall(SYS_tgkill, getpid(), tid, WATCHDOG_STACK_SIGNAL) < 0)
+  {
+    Log("%s%s Error: tgkill, Error - %s", TAG, __func__, strerror(errno));
+    return;
+  }
+  int depth = -1;
+  for (int waitedMs = 0; waitedMs < WATCHDOG_STACK_WAIT_MS; ++waitedMs)
+  {
+    depth = stackDepth.load(std::memory_order_acquire);
+    if (depth >= 0)
+    {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (depth < 0)
+  {
+    Log("%s%s No stack sample from thread %d", TAG, __func__, tid);
+    return;
+  }
+  char **symbols = backtrace_symbols(stackFrames, depth);
+  if (!symbols)
+  {
+    return;
+  }
+  // Frame 0 is the sampling handler itself
+  for (int i = 1; i < depth; ++i)
+  {
+    Log("%s%s   #%d %s", TAG, __func__, i - 1, symbols[i]);
+  }
+  free(symbols);
+}
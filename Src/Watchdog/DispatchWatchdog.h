@@ -0,0 +1,132 @@
+/**
+ * @file DispatchWatchdog.h
+ * @brief Stall detector for handlers running on the D-Bus dispatch thread
+ * @author Gokul
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "Metrics.h"
+
+#define WATCHDOG_MAX_THREADS 8          ///< Threads whose handlers can be watched at once
+#define WATCHDOG_STACK_DEPTH 32         ///< Frames captured in a stack sample
+#define WATCHDOG_DEFAULT_THRESHOLD_MS 100 ///< Handler time reported as a stall by default
+
+#define WATCHDOG_CONCAT_INNER(a, b) a##b
+#define WATCHDOG_CONCAT(a, b) WATCHDOG_CONCAT_INNER(a, b)
+
+/**
+ * @def WATCHDOG_HANDLER(name)
+ * @brief Mark the rest of the enclosing block as a bus handler watched for stalls
+ *
+ * Place it first in every signal handler, match callback and adaptor
+ * method. Entry and exit are a few atomic stores plus a clock read; the
+ * duration histogram is looked up once per call site.
+ *
+ * @param name String literal naming the handler, e.g. "Agent::RequestConfirmation"
+ */
+#define WATCHDOG_HANDLER(name)                                                                        \
+  static LatencyHistogram &WATCHDOG_CONCAT(watchdogLatency, __LINE__) = WatchdogScope::Histogram(name); \
+  WatchdogScope WATCHDOG_CONCAT(watchdogScope, __LINE__)(name, WATCHDOG_CONCAT(watchdogLatency, __LINE__))
+
+/**
+ * @class WatchdogScope
+ * @brief Timestamps entry to and exit from one handler
+ *
+ * Each thread running handlers owns a slot the watchdog polls. Nested
+ * handlers count as part of the outermost one.
+ */
+class WatchdogScope
+{
+public:
+  /**
+   * @brief Enter a handler
+   * @param name Static handler name
+   * @param latency Histogram receiving the handler duration
+   */
+  WatchdogScope(const char *name, LatencyHistogram &latency);
+
+  /**
+   * @brief Leave the handler and record its duration
+   */
+  ~WatchdogScope();
+
+  WatchdogScope(const WatchdogScope &) = delete;
+  WatchdogScope &operator=(const WatchdogScope &) = delete;
+
+  /**
+   * @brief Get the duration histogram of a handler
+   * @param name Handler name
+   * @return Histogram, registered on first use
+   */
+  static LatencyHistogram &Histogram(const char *name);
+
+private:
+  LatencyHistogram &m_latency; ///< Duration of this handler
+  uint64_t m_entryUs;          ///< Entry time on the steady clock
+  bool m_outermost;            ///< True if this scope owns the thread's slot
+};
+
+/**
+ * @class DispatchWatchdog
+ * @brief Low-priority monitor reporting handlers that hold the bus thread too long
+ *
+ * Every signal and method call is dispatched on the sdbus-c++ event loop
+ * thread, so one slow handler delays all the others. The monitor polls
+ * the handler slots at a quarter of the threshold; a handler still running
+ * past the threshold is reported once with its name, its elapsed time and
+ * a stack sample taken from the stalled thread, and again with its total
+ * time when it returns. Reporting happens on the monitor thread, so a
+ * stalled stdout never adds to the stall.
+ */
+class DispatchWatchdog
+{
+public:
+  /**
+   * @brief Construct a new Dispatch Watchdog object
+   * @param thresholdMs Handler time reported as a stall
+   */
+  explicit DispatchWatchdog(uint32_t thresholdMs);
+
+  /**
+   * @brief Stop the monitor thread
+   */
+  ~DispatchWatchdog();
+
+  /**
+   * @brief Install the stack sampling signal and start the monitor thread
+   * @return False if the monitor could not be started
+   */
+  bool Start();
+
+private:
+  /**
+   * @brief Poll the handler slots until stopped
+   */
+  void RunEventLoop();
+
+  /**
+   * @brief Check one slot and report a stall or its end
+   * @param index Slot index
+   * @param nowUs Current time on the steady clock
+   */
+  void CheckSlot(int index, uint64_t nowUs);
+
+  /**
+   * @brief Log the current stack of a thread
+   * @param tid Kernel thread id of the stalled thread
+   */
+  void LogStack(int tid);
+
+  uint32_t m_thresholdMs;                     ///< Handler time reported as a stall
+  uint64_t m_reported[WATCHDOG_MAX_THREADS];  ///< Handler sequence last reported per slot, 0 for none
+  int m_wakeFd = -1;                          ///< eventfd waking the loop on shutdown
+  std::atomic<bool> m_running;                ///< Flag to control event loop execution
+  std::thread m_eventLoopThread;              ///< Monitor thread
+};
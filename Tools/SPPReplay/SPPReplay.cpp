@@ -0,0 +1,257 @@
+/**
+ * @file SPPReplay.cpp
+ * @brief Replays a captured SPP connection through SPPHandler
+ * @author Gokul
+ * @date 2025
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <poll.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "BufferPool.h"
+#include "SPPCapture.h"
+#include "SPPConfig.h"
+#include "SPPHandler.h"
+
+#include "Logger.h"
+
+#define TAG "SPPReplay::"                        ///< Tag for logging messages
+#define REPLAY_CHUNK_SIZE 1024                   ///< Same chunk size as the application pool
+#define REPLAY_CHUNK_COUNT 4096                  ///< Same chunk count as the application pool
+#define SETTLE_DURATION std::chrono::milliseconds(200) ///< Time given to the handler to drain the socket
+#define DRAIN_POLL_TIMEOUT_MS 100                ///< Poll interval of the peer-side reader
+
+/**
+ * @brief Write all bytes to a socket
+ * @param fd Socket
+ * @param data Bytes to write
+ * @param len Number of bytes
+ * @return False if the socket failed
+ */
+static bool WriteAll(int fd, const char *data, size_t len)
+{
+  while (len)
+  {
+    ssize_t written = write(fd, data, len);
+    if (written < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (written <= 0)
+    {
+      Log("%s%s Error: Writing to FD - %d, Error - %s", TAG, __func__, fd, strerror(errno));
+      return false;
+    }
+    data += written;
+    len -= written;
+  }
+  return true;
+}
+
+/**
+ * @brief Parse a connection id given on the command line
+ * @param text Argument text
+ * @param value Parsed id, set only on success
+ * @return False if the text is not a decimal number that fits in 32 bits
+ */
+static bool ParseConnection(const std::string &text, uint32_t &value)
+{
+  // strtoul accepts leading blanks and a sign, and wraps "-1"
+  if (text.empty() || !isdigit(static_cast<unsigned char>(text[0])))
+  {
+    return false;
+  }
+  char *end = nullptr;
+  errno = 0;
+  unsigned long parsed = strtoul(text.c_str(), &end, 10);
+  if (errno == ERANGE || *end != '\0' || parsed > UINT32_MAX)
+  {
+    return false;
+  }
+  value = static_cast<uint32_t>(parsed);
+  return true;
+}
+
+/**
+ * @brief Parse a replay speed factor given on the command line
+ * @param text Argument text
+ * @param value Parsed factor, set only on success
+ * @return False if the text is not a finite, non-negative number
+ */
+static bool ParseSpeed(const std::string &text, double &value)
+{
+  if (text.empty())
+  {
+    return false;
+  }
+  char *end = nullptr;
+  errno = 0;
+  double parsed = strtod(text.c_str(), &end);
+  if (errno == ERANGE || *end != '\0' || !std::isfinite(parsed) || parsed < 0)
+  {
+    return false;
+  }
+  value = parsed;
+  return true;
+}
+
+/**
+ * @brief Entry point of the replay tool
+ *
+ * Usage: SPPReplay --capture <file> [--connection <id>] [--speed <factor>] [--spp-compress]
+ *
+ * The inbound bytes of one captured connection are written into one end of
+ * a socketpair whose other end is owned by an SPPHandler, exactly as BlueZ
+ * hands over an RFCOMM socket. --speed 1 keeps the original timing, larger
+ * values replay faster, and 0 replays as fast as the handler can read.
+ * Whatever the handler writes back is read and counted.
+ *
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @return 0 on success, 1 on error
+ */
+int main(int argc, char **argv)
+{
+  std::string capturePath;
+  uint32_t connection = 0;
+  double speed = 1.0;
+  SPPConfig config;
+  std::vector<std::string> args(argv, argv + argc);
+  bool validArgs = true;
+
+  for (size_t i = 0; i < args.size(); i++)
+  {
+    if (args[i] == "--capture" && i + 1 < args.size())
+    {
+      capturePath = args[++i];
+    }
+    else if (args[i] == "--connection" && i + 1 < args.size())
+    {
+      validArgs = ParseConnection(args[++i], connection) && validArgs;
+    }
+    else if (args[i] == "--speed" && i + 1 < args.size())
+    {
+      validArgs = ParseSpeed(args[++i], speed) && validArgs;
+    }
+    else if (args[i] == "--spp-compress")
+    {
+      config.compression = true;
+    }
+  }
+
+  if (!validArgs || capturePath.empty())
+  {
+    Log("Usage: %s --capture <file> [--connection <id>] [--speed <factor>] [--spp-compress]", LOG_STRING(args[0]));
+    return 1;
+  }
+
+  SPPCaptureReader reader(capturePath);
+  if (!reader.IsOpen())
+  {
+    return 1;
+  }
+
+  // Default to the first connection with inbound traffic
+  SPPCaptureRecord record = {};
+  uint64_t outboundBytes = 0;
+  while (reader.Next(record))
+  {
+    if (!connection && record.direction == SPPCaptureDirection::Inbound)
+    {
+      connection = record.connection;
+    }
+    if (record.connection == connection && record.direction == SPPCaptureDirection::Outbound)
+    {
+      outboundBytes += record.len;
+    }
+  }
+  if (!connection)
+  {
+    Log("%s%s Error: No inbound traffic in capture", TAG, __func__);
+    return 1;
+  }
+  reader.Rewind();
+
+  int sockets[2] = {-1, -1};
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) < 0)
+  {
+    Log("%s%s Error: Creating socketpair, Error - %s", TAG, __func__, strerror(errno));
+    return 1;
+  }
+
+  BufferPool pool(REPLAY_CHUNK_SIZE, REPLAY_CHUNK_COUNT);
+  auto handler = std::make_unique<SPPHandler>(sdbus::UnixFd(sockets[0], sdbus::adopt_fd), pool, config);
+  handler->StartOperations();
+
+  // Peer side: consume whatever the handler sends so it never blocks
+  std::atomic<bool> draining(true);
+  std::atomic<uint64_t> returnedBytes(0);
+  std::thread drain([&]() {
+    char buffer[REPLAY_CHUNK_SIZE];
+    struct pollfd pfd = {sockets[1], POLLIN, 0};
+    while (draining)
+    {
+      if (poll(&pfd, 1, DRAIN_POLL_TIMEOUT_MS) <= 0)
+      {
+        continue;
+      }
+      ssize_t bytes = read(sockets[1], buffer, sizeof(buffer));
+      if (bytes <= 0)
+      {
+        break;
+      }
+      returnedBytes += bytes;
+    }
+  });
+
+  uint64_t records = 0;
+  uint64_t inboundBytes = 0;
+  uint64_t firstTimestamp = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (reader.Next(record))
+  {
+    if (record.connection != connection || record.direction != SPPCaptureDirection::Inbound)
+    {
+      continue;
+    }
+    if (!records)
+    {
+      firstTimestamp = record.timestampNs;
+    }
+    if (speed > 0)
+    {
+      auto offset = std::chrono::nanoseconds(static_cast<uint64_t>((record.timestampNs - firstTimestamp) / speed));
+      std::this_thread::sleep_until(start + offset);
+    }
+    if (!WriteAll(sockets[1], record.data, record.len))
+    {
+      break;
+    }
+    ++records;
+    inboundBytes += record.len;
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::this_thread::sleep_for(SETTLE_DURATION);
+  handler.reset();
+  draining = false;
+  drain.join();
+  close(sockets[1]);
+
+  Log("%s%s Connection - %u, Records - %" PRIu64 ", Bytes - %" PRIu64 ", Time - %.3f s, Throughput - %.2f MB/s",
+      TAG, __func__, connection, records, inboundBytes, elapsed, elapsed > 0 ? inboundBytes / elapsed / 1e6 : 0.0);
+  Log("%s%s Bytes sent by handler - %" PRIu64 " (captured - %" PRIu64 ")", TAG, __func__, returnedBytes.load(), outboundBytes);
+  return 0;
+}
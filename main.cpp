@@ -15,9 +15,13 @@
 #include <execinfo.h> // For backtrace
 #include <functional>
 
+#include <cerrno>
+#include <cctype>
 #include <cstdlib>
+#include <limits>
 
 #include "Menu.h"
+#include "Trace.h"
 
 #define BACKTRACE_SIZE 32  ///< Maximum number of stack frames to capture in backtrace
 
@@ -100,6 +104,37 @@ void DeleteDevices() {
     }
 }
 
+/**
+ * @brief Print the command line usage
+ * @param program Name the program was started with
+ */
+void PrintUsage(const std::string &program) {
+    std::cerr << "Usage: " << program << " --hci <hci_device> --name <device_name> --class <SMARTPHONE/HELMET> [--spp-compress] [--spp-crc <none/crc16/crc32c>] [--spp-capture <file>] [--max-devices <n>] [--device-idle-timeout <seconds>] [--max-sightings <n>] [--notify-debounce <ms>] [--metrics <socket>] [--no-trace] [--stall-threshold <ms>]" << std::endl;
+}
+
+/**
+ * @brief Parse an unsigned decimal command line value
+ * @tparam T Unsigned type the value is stored in
+ * @param text Argument text
+ * @param value Parsed value, set only on success
+ * @return False if the text is not a decimal number that fits in T
+ */
+template <typename T>
+bool ParseUnsigned(const std::string &text, T &value) {
+    // strtoul accepts leading blanks and a sign, and wraps "-1" to ULONG_MAX
+    if(text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+    char *end = nullptr;
+    errno = 0;
+    unsigned long parsed = std::strtoul(text.c_str(), &end, 10);
+    if(errno == ERANGE || *end != '\0' || parsed > std::numeric_limits<T>::max()) {
+        return false;
+    }
+    value = static_cast<T>(parsed);
+    return true;
+}
+
 /**
  * @brief Main entry point for the BlueZ D-Bus sample application
  * @param argc Number of command line arguments
@@ -115,6 +150,16 @@ void DeleteDevices() {
  * 
  * Optional arguments:
  * - --class: Device class ("SMARTPHONE" or "HELMET", defaults to "HELMET")
+ * - --spp-compress: Offer payload compression on SPP connections
+ * - --spp-crc: Checksum trailer on SPP frames ("none", "crc16" or "crc32c")
+ * - --spp-capture: Record SPP traffic to a capture file for SPPReplay
+ * - --max-devices: Devices kept in the registry before idle ones are evicted
+ * - --device-idle-timeout: Evict idle devices not seen for this many seconds
+ * - --max-sightings: Nearby devices remembered without being admitted
+ * - --notify-debounce: Milliseconds over which device events for subscribers are merged, 0 to deliver at once
+ * - --metrics: Unix socket path serving metrics in the Prometheus text format
+ * - --no-trace: Do not record control-plane trace spans
+ * - --stall-threshold: Report D-Bus handlers running longer than this many milliseconds, 0 to disable
  */
 int main(int argc, char **argv)
 {
@@ -126,7 +171,12 @@ int main(int argc, char **argv)
     std::string hciDevice;
     std::string deviceName;
     std::string deviceClass = "HELMET";
+    SPPConfig sppConfig;
+    DeviceManagerConfig deviceConfig;
+    std::string metricsPath;
+    uint32_t stallThresholdMs = WATCHDOG_DEFAULT_THRESHOLD_MS;
     std::vector<std::string> args(argv, argv + argc);
+    bool validArgs = true;
 
     for(size_t i = 0; i < args.size(); i++) {
         if(args[i] == "--hci" && i + 1 < args.size()) {
@@ -136,14 +186,44 @@ int main(int argc, char **argv)
         } else if(args[i] == "--class" && i + 1 < args.size()) {
             deviceClass = args[++i];
             std::transform(deviceClass.begin(), deviceClass.end(), deviceClass.begin(), ::toupper);
+        } else if(args[i] == "--spp-compress") {
+            sppConfig.compression = true;
+        } else if(args[i] == "--spp-crc" && i + 1 < args.size()) {
+            std::string crc = args[++i];
+            if(crc == "none") {
+                sppConfig.checksum = SPPChecksum::None;
+            } else if(crc == "crc16") {
+                sppConfig.checksum = SPPChecksum::Crc16;
+            } else if(crc == "crc32c") {
+                sppConfig.checksum = SPPChecksum::Crc32c;
+            } else {
+                validArgs = false;
+            }
+        } else if(args[i] == "--spp-capture" && i + 1 < args.size()) {
+            sppConfig.capturePath = args[++i];
+        } else if(args[i] == "--max-devices" && i + 1 < args.size()) {
+            validArgs = ParseUnsigned(args[++i], deviceConfig.maxDevices) && validArgs;
+        } else if(args[i] == "--device-idle-timeout" && i + 1 < args.size()) {
+            validArgs = ParseUnsigned(args[++i], deviceConfig.idleTimeoutSec) && validArgs;
+        } else if(args[i] == "--max-sightings" && i + 1 < args.size()) {
+            validArgs = ParseUnsigned(args[++i], deviceConfig.maxSightings) && validArgs;
+        } else if(args[i] == "--notify-debounce" && i + 1 < args.size()) {
+            validArgs = ParseUnsigned(args[++i], deviceConfig.notifyDebounceMs) && validArgs;
+        } else if(args[i] == "--metrics" && i + 1 < args.size()) {
+            metricsPath = args[++i];
+        } else if(args[i] == "--no-trace") {
+            Trace::Enable(false);
+        } else if(args[i] == "--stall-threshold" && i + 1 < args.size()) {
+            validArgs = ParseUnsigned(args[++i], stallThresholdMs) && validArgs;
         }
     }
 
-    if (hciDevice.empty() || deviceName.empty()) {
-        std::cerr << "Usage: " << args[0] << " --hci <hci_device> --name <device_name> --class <SMARTPHONE/HELMET>" << std::endl;
+    if (!validArgs || hciDevice.empty() || deviceName.empty()) {
+        PrintUsage(args[0]);
         return 1;
     }
 
+    Trace::SetThreadName("Main");
     Log("HCI Device: %s", hciDevice.c_str());
     Log("Device Name: %s", deviceName.c_str());
     try
@@ -157,7 +237,7 @@ int main(int argc, char **argv)
             return 1;
         }
         // Create and start the application
-        app = std::make_shared<Application>(*connection, hciDevice, deviceName, deviceClass);
+        app = std::make_shared<Application>(*connection, hciDevice, deviceName, deviceClass, sppConfig, deviceConfig, metricsPath, stallThresholdMs);
         if(app) {
             app->StartApplication();
         }